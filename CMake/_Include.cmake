@@ -134,6 +134,20 @@ if(ENABLE_SASL)
     endif()
 endif()
 
+## compression
+if(ENABLE_LZ4)
+    check_dependency(LIBLZ4 lz4)
+    if(HAVE_LIBLZ4)
+        pkgconfig_export(REQUIRES_PRIVATE liblz4)
+    endif()
+endif()
+if(ENABLE_ZSTD)
+    check_dependency(LIBZSTD zstd)
+    if(HAVE_LIBZSTD)
+        pkgconfig_export(REQUIRES_PRIVATE libzstd)
+    endif()
+endif()
+
 ## hashes
 configure_set(HAVE_FNV64_HASH ${ENABLE_HASH_FNV64})
 configure_set(HAVE_MURMUR_HASH ${ENABLE_HASH_MURMUR})
@@ -144,11 +158,13 @@ check_include(arpa/inet.h)
 check_include(dlfcn.h)
 check_include(getopt.h)
 check_include(libgen.h)
+check_include(linux/io_uring.h)
 check_include(netdb.h)
 check_include(netinet/in.h)
 check_include(netinet/tcp.h)
 check_include(poll.h)
 check_include(strings.h)
+check_include(sys/epoll.h)
 check_include(sys/poll.h)
 check_include(sys/socket.h)
 check_include(sys/time.h)
@@ -164,16 +180,20 @@ check_type("struct timespec" time.h)
 check_cxx_symbol(abi::__cxa_demangle cxxabi.h)
 check_symbol(CLOCK_MONOTONIC time.h)
 check_symbol(clock_gettime time.h)
+check_symbol(epoll_create1 sys/epoll.h)
 check_symbol(ERESTART errno.h)
 check_symbol(fcntl fcntl.h)
 check_symbol(gettimeofday sys/time.h)
 check_symbol(htonll arpa/inet.h)
 check_symbol(index strings.h)
+check_symbol(__NR_io_uring_setup sys/syscall.h)
 check_symbol(MSG_DONTWAIT sys/socket.h)
 check_symbol(MSG_MORE sys/socket.h)
 check_symbol(MSG_NOSIGNAL sys/socket.h)
+check_symbol(MSG_ZEROCOPY sys/socket.h)
 check_symbol(SO_RCVTIMEO sys/socket.h)
 check_symbol(SO_SNDTIMEO sys/socket.h)
+check_symbol(SO_ZEROCOPY sys/socket.h)
 check_symbol(rand stdlib.h)
 check_symbol(random stdlib.h)
 check_symbol(realpath stdlib.h)
@@ -188,6 +208,15 @@ check_c_source("
         }"
         HAVE_STRERROR_R_CHAR_P
 )
+# linux/errqueue.h is not self-contained
+check_c_source("
+        #include <sys/socket.h>
+        #include <linux/errqueue.h>
+        int main() {
+            return SO_EE_ORIGIN_ZEROCOPY;
+        }"
+        HAVE_LINUX_ERRQUEUE_H
+)
 
 if(WIN32)
     check_include(io.h)
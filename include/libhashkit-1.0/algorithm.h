@@ -52,9 +52,20 @@ uint32_t libhashkit_jenkins(const char *key, size_t key_length);
 HASHKIT_API
 uint32_t libhashkit_md5(const char *key, size_t key_length);
 
+HASHKIT_API
+uint32_t libhashkit_xxh3(const char *key, size_t key_length);
+
+HASHKIT_API
+uint32_t libhashkit_wyhash(const char *key, size_t key_length);
+
 HASHKIT_API
 void libhashkit_md5_signature(const unsigned char *key, size_t length, unsigned char *result);
 
+HASHKIT_API
+void libhashkit_md5_signature_batch(const unsigned char *prefix, size_t prefix_length,
+                                    const unsigned char *const *keys, const size_t *key_length,
+                                    size_t number_of_keys, unsigned char *results);
+
 #ifdef __cplusplus
 }
 #endif
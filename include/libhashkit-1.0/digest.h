@@ -22,6 +22,15 @@ extern "C" {
 HASHKIT_API
 uint32_t hashkit_digest(const hashkit_st *self, const char *key, size_t key_length);
 
+/**
+  Hashes number_of_keys keys, each prefixed with prefix, into hashes, with the prefix
+  hashed only once where the hash function allows it.
+*/
+HASHKIT_API
+bool hashkit_digest_batch(const hashkit_st *self, const char *prefix, size_t prefix_length,
+                          const char *const *keys, const size_t *key_length,
+                          size_t number_of_keys, uint32_t *hashes);
+
 /**
   This is a utilitly function provided so that you can directly access hashes with a hashkit_st.
 */
@@ -77,6 +77,18 @@ hashkit_string_st *hashkit_decrypt(hashkit_st *, const char *source, size_t sour
 HASHKIT_API
 bool hashkit_key(hashkit_st *kit, const char *key, const size_t key_length);
 
+HASHKIT_API
+size_t hashkit_encrypt_length(const hashkit_st *, hashkit_cipher_mode_t mode,
+                              size_t source_length);
+
+HASHKIT_API
+bool hashkit_encrypt_buffer(hashkit_st *, hashkit_cipher_mode_t mode, const char *source,
+                            size_t source_length, char *destination, size_t *destination_length);
+
+HASHKIT_API
+bool hashkit_decrypt_buffer(hashkit_st *, hashkit_cipher_mode_t mode, const char *source,
+                            size_t source_length, char *destination, size_t *destination_length);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -44,6 +44,8 @@ typedef enum {
   HASHKIT_HASH_MURMUR,
   HASHKIT_HASH_JENKINS,
   HASHKIT_HASH_MURMUR3,
+  HASHKIT_HASH_XXH3,
+  HASHKIT_HASH_WYHASH,
   HASHKIT_HASH_CUSTOM,
   HASHKIT_HASH_MAX
 } hashkit_hash_algorithm_t;
@@ -58,6 +60,15 @@ typedef enum {
   HASHKIT_DISTRIBUTION_MAX /* Always add new values before this. */
 } hashkit_distribution_t;
 
+/**
+ * Cipher modes of hashkit_encrypt_buffer() and hashkit_decrypt_buffer().
+ */
+typedef enum {
+  HASHKIT_CIPHER_MODE_DEFAULT, // the mode of hashkit_encrypt()
+  HASHKIT_CIPHER_MODE_CTR,     // counter mode, prefixed with its IV
+  HASHKIT_CIPHER_MODE_MAX
+} hashkit_cipher_mode_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
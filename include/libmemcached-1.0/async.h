@@ -0,0 +1,70 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A socket the application should watch for the poll(2) events given */
+struct memcached_async_fd_st {
+  memcached_socket_t fd;
+  short events;
+};
+
+#ifndef __cplusplus
+typedef struct memcached_async_fd_st memcached_async_fd_st;
+#endif
+
+/* item is only given for a successful get and only valid during the callback */
+typedef void (*memcached_async_fn)(const memcached_st *ptr, memcached_return_t rc,
+                                   const memcached_item_view_st *item, void *context);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_async_get(memcached_st *ptr, const char *key, size_t key_length,
+                                       memcached_async_fn callback, void *context,
+                                       uint64_t *request);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_async_set(memcached_st *ptr, const char *key, size_t key_length,
+                                       const char *value, size_t value_length, time_t expiration,
+                                       uint32_t flags, memcached_async_fn callback, void *context,
+                                       uint64_t *request);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_async_delete(memcached_st *ptr, const char *key, size_t key_length,
+                                          memcached_async_fn callback, void *context,
+                                          uint64_t *request);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_async_cancel(memcached_st *ptr, uint64_t request);
+
+LIBMEMCACHED_API
+uint32_t memcached_async_pending(const memcached_st *ptr);
+
+LIBMEMCACHED_API
+uint32_t memcached_async_fds(memcached_st *ptr, memcached_async_fd_st *fds, uint32_t number_of_fds);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_async_process(memcached_st *ptr, memcached_socket_t fd,
+                                           short revents);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_async_poll(memcached_st *ptr, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
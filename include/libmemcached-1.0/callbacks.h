@@ -21,6 +21,9 @@ extern "C" {
 
 typedef memcached_return_t (*memcached_execute_fn)(const memcached_st *ptr,
                                                    memcached_result_st *result, void *context);
+typedef memcached_return_t (*memcached_fetch_view_fn)(const memcached_st *ptr,
+                                                      const memcached_item_view_st *item,
+                                                      void *context);
 typedef memcached_return_t (*memcached_server_fn)(const memcached_st *ptr,
                                                   const memcached_instance_st *server,
                                                   void *context);
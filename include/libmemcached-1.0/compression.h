@@ -0,0 +1,37 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LIBMEMCACHED_API
+memcached_return_t memcached_compression_stat(const memcached_st *ptr,
+                                              memcached_compression_stat_st *stat);
+
+LIBMEMCACHED_API
+void memcached_compression_stat_reset(memcached_st *ptr);
+
+LIBMEMCACHED_API
+bool libmemcached_has_compression(memcached_compression_t algorithm);
+
+LIBMEMCACHED_API
+const char *libmemcached_string_compression(memcached_compression_t algorithm);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,267 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+#include "libmemcached-1.0/memcached.hpp"
+
+#if !defined __cpp_impl_coroutine || !__has_include(<coroutine>)
+#  error "libmemcached-1.0/coroutine.hpp needs C++20 coroutines"
+#endif
+
+#include <algorithm>
+#include <coroutine>
+#include <functional>
+#include <string_view>
+
+namespace memcache {
+
+/**
+ * Awaitable front-end on top of the asynchronous API, see memcached_async(3).
+ *
+ * Any number of requests may be in flight. A suspended coroutine is resumed
+ * once its response arrived, while poll() or process() drive the connections.
+ */
+class AsyncMemcache : public Memcache {
+public:
+  using Memcache::Memcache;
+
+  /**
+   * Resumes coroutines whose requests completed; without an executor they
+   * are resumed right away from within poll() or process().
+   */
+  using Executor = std::function<void(std::coroutine_handle<>)>;
+
+  struct Item {
+    memcached_return_t rc = MEMCACHED_NOTFOUND;
+    std::vector<char> value;
+    uint32_t flags = 0;
+    uint64_t cas = 0;
+  };
+
+private:
+  enum Operation { GET, SET, REMOVE };
+
+  class Awaiter {
+  public:
+    Awaiter(AsyncMemcache &client, Operation operation, std::vector<std::string_view> keys)
+    : client_(client)
+    , operation_(operation)
+    , keys_(std::move(keys))
+    , items_(keys_.size())
+    , slots_(keys_.size())
+    , requests_(keys_.size()) {}
+
+    Awaiter(const Awaiter &) = delete;
+    Awaiter &operator=(const Awaiter &) = delete;
+
+    /* Requests of a coroutine destroyed while waiting are not reported anymore */
+    ~Awaiter() {
+      for (auto request : requests_) {
+        if (request) {
+          memcached_async_cancel(client_.memc_, request);
+        }
+      }
+    }
+
+    bool await_ready() const noexcept { return keys_.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      handle_ = handle;
+
+      for (size_t x = 0; x < keys_.size(); ++x) {
+        slots_[x] = {this, x};
+        items_[x].rc = submit(keys_[x], &slots_[x], &requests_[x]);
+        if (memcached_success(items_[x].rc)) {
+          ++remaining_;
+        } else {
+          requests_[x] = 0;
+        }
+      }
+
+      return remaining_ > 0;
+    }
+
+  private:
+    struct Slot {
+      Awaiter *awaiter;
+      size_t index;
+    };
+
+    AsyncMemcache &client_;
+    Operation operation_;
+    std::vector<std::string_view> keys_;
+
+  protected:
+    std::vector<Item> items_;
+    std::string_view value_;
+    time_t expiration_ = 0;
+    uint32_t flags_ = 0;
+
+  private:
+    std::vector<Slot> slots_;
+    std::vector<uint64_t> requests_;
+    std::coroutine_handle<> handle_;
+    size_t remaining_ = 0;
+
+    memcached_return_t submit(std::string_view key, Slot *slot, uint64_t *request) {
+      switch (operation_) {
+      case GET:
+        return memcached_async_get(client_.memc_, key.data(), key.size(), complete, slot, request);
+      case SET:
+        return memcached_async_set(client_.memc_, key.data(), key.size(), value_.data(),
+                                   value_.size(), expiration_, flags_, complete, slot, request);
+      case REMOVE:
+        return memcached_async_delete(client_.memc_, key.data(), key.size(), complete, slot,
+                                      request);
+      }
+      return MEMCACHED_INVALID_ARGUMENTS;
+    }
+
+    static void complete(const memcached_st *, memcached_return_t rc,
+                         const memcached_item_view_st *item, void *context) {
+      auto slot = static_cast<Slot *>(context);
+      auto awaiter = slot->awaiter;
+      auto &result = awaiter->items_[slot->index];
+
+      result.rc = rc;
+      if (item) {
+        result.value.assign(item->value, item->value + item->value_length);
+        result.flags = item->flags;
+        result.cas = item->cas;
+      }
+      awaiter->requests_[slot->index] = 0;
+
+      // the awaiter is gone as soon as the coroutine continues
+      if (--awaiter->remaining_ == 0) {
+        awaiter->client_.resume(awaiter->handle_);
+      }
+    }
+  };
+
+public:
+  class GetAwaiter : public Awaiter {
+  public:
+    GetAwaiter(AsyncMemcache &client, std::string_view key)
+    : Awaiter(client, GET, {key}) {}
+
+    Item await_resume() { return std::move(items_.front()); }
+  };
+
+  class MgetAwaiter : public Awaiter {
+  public:
+    MgetAwaiter(AsyncMemcache &client, const std::vector<std::string> &keys)
+    : Awaiter(client, GET, std::vector<std::string_view>(keys.begin(), keys.end())) {}
+
+    std::vector<Item> await_resume() { return std::move(items_); }
+  };
+
+  class ReturnAwaiter : public Awaiter {
+  public:
+    ReturnAwaiter(AsyncMemcache &client, std::string_view key)
+    : Awaiter(client, REMOVE, {key}) {}
+
+    ReturnAwaiter(AsyncMemcache &client, std::string_view key, std::string_view value,
+                  time_t expiration, uint32_t flags)
+    : Awaiter(client, SET, {key}) {
+      value_ = value;
+      expiration_ = expiration;
+      flags_ = flags;
+    }
+
+    memcached_return_t await_resume() { return items_.front().rc; }
+  };
+
+  void setExecutor(Executor executor) { executor_ = std::move(executor); }
+
+  /**
+   * Fetches an individual value from the server.
+   *
+   * @param[in] key key of object whose value to get
+   * @return awaitable Item, its rc is MEMCACHED_SUCCESS if found
+   */
+  GetAwaiter get(std::string_view key) { return GetAwaiter{*this, key}; }
+
+  /**
+   * Fetches multiple values from the servers at once.
+   *
+   * @param[in] keys keys of objects whose values to get
+   * @return awaitable vector of Items in the order of the keys
+   */
+  MgetAwaiter mget(const std::vector<std::string> &keys) { return MgetAwaiter{*this, keys}; }
+
+  /**
+   * Writes an object to the server.
+   *
+   * @param[in] key key of object to write
+   * @param[in] value value of object to write
+   * @param[in] expiration time to keep the object stored in the server
+   * @param[in] flags flags to store with the object
+   * @return awaitable memcached_return_t
+   */
+  ReturnAwaiter set(std::string_view key, std::string_view value, time_t expiration = 0,
+                    uint32_t flags = 0) {
+    return ReturnAwaiter{*this, key, value, expiration, flags};
+  }
+
+  ReturnAwaiter set(std::string_view key, const std::vector<char> &value, time_t expiration = 0,
+                    uint32_t flags = 0) {
+    return ReturnAwaiter{*this, key, {value.data(), value.size()}, expiration, flags};
+  }
+
+  /**
+   * Deletes an object from the server.
+   *
+   * @param[in] key key of object to delete
+   * @return awaitable memcached_return_t
+   */
+  ReturnAwaiter remove(std::string_view key) { return ReturnAwaiter{*this, key}; }
+
+  /**
+   * Waits at most timeout milliseconds for the servers and processes them.
+   */
+  memcached_return_t poll(int timeout) { return memcached_async_poll(memc_, timeout); }
+
+  /**
+   * Sockets and events to watch in an external event loop.
+   */
+  std::vector<memcached_async_fd_st> fds() {
+    std::vector<memcached_async_fd_st> fds(memcached_async_fds(memc_, NULL, 0));
+    fds.resize(std::min<size_t>(fds.size(), memcached_async_fds(memc_, fds.data(), fds.size())));
+    return fds;
+  }
+
+  /**
+   * Processes a socket reported ready by an external event loop.
+   */
+  memcached_return_t process(memcached_socket_t fd, short revents) {
+    return memcached_async_process(memc_, fd, revents);
+  }
+
+  uint32_t pending() const { return memcached_async_pending(memc_); }
+
+private:
+  Executor executor_;
+
+  void resume(std::coroutine_handle<> handle) {
+    if (executor_) {
+      executor_(handle);
+    } else {
+      handle.resume();
+    }
+  }
+};
+
+} // namespace memcache
@@ -32,3 +32,9 @@
 #define MEMCACHED_SERVER_FAILURE_RETRY_TIMEOUT 2
 #define MEMCACHED_SERVER_FAILURE_DEAD_TIMEOUT  0
 #define MEMCACHED_SERVER_TIMEOUT_LIMIT         0
+#define MEMCACHED_DEFAULT_IO_SENDMSG_THRESHOLD MEMCACHED_MAX_BUFFER
+#define MEMCACHED_DEFAULT_IO_BUFFER_MIN        4096
+#define MEMCACHED_DEFAULT_IO_BUFFER_MAX        (256 * 1024)
+
+#define MEMCACHED_DEFAULT_COMPRESSION_THRESHOLD 1024
+#define MEMCACHED_DEFAULT_COMPRESSION_RATIO     90
@@ -28,6 +28,21 @@ memcached_return_t memcached_delete_by_key(memcached_st *ptr, const char *group_
                                            size_t group_key_length, const char *key,
                                            size_t key_length, time_t expiration);
 
+/*
+  Deletes number_of_keys keys pipelined per server, storing the result of each key in results
+  unless it is NULL. Returns MEMCACHED_SOME_ERRORS if any key failed.
+*/
+LIBMEMCACHED_API
+memcached_return_t memcached_mdelete(memcached_st *ptr, const char *const *keys,
+                                     const size_t *key_length, size_t number_of_keys,
+                                     memcached_return_t *results);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_mdelete_by_key(memcached_st *ptr, const char *group_key,
+                                            size_t group_key_length, const char *const *keys,
+                                            const size_t *key_length, size_t number_of_keys,
+                                            memcached_return_t *results);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,10 @@ LIBMEMCACHED_API
 memcached_return_t memcached_fetch_execute(memcached_st *ptr, memcached_execute_fn *callback,
                                            void *context, uint32_t number_of_callbacks);
 
+LIBMEMCACHED_API
+memcached_return_t memcached_fetch_view(memcached_st *ptr, memcached_fetch_view_fn callback,
+                                        void *context);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,6 +33,16 @@ memcached_return_t memcached_set_hashkit(memcached_st *ptr, hashkit_st *hashk);
 LIBMEMCACHED_API
 uint32_t memcached_generate_hash(const memcached_st *ptr, const char *key, size_t key_length);
 
+LIBMEMCACHED_API
+uint32_t memcached_generate_hash_replicas(const memcached_st *ptr, const char *key,
+                                          size_t key_length, uint32_t *server_keys,
+                                          uint32_t count);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_generate_hash_batch(memcached_st *ptr, const char *const *keys,
+                                                 const size_t *key_length,
+                                                 size_t number_of_keys, uint32_t *server_keys);
+
 LIBMEMCACHED_API
 void memcached_autoeject(memcached_st *ptr);
 
@@ -24,6 +24,7 @@
 
 #include "libmemcached-1.0/types/behavior.h"
 #include "libmemcached-1.0/types/callback.h"
+#include "libmemcached-1.0/types/compression.h"
 #include "libmemcached-1.0/types/connection.h"
 #include "libmemcached-1.0/types/hash.h"
 #include "libmemcached-1.0/types/return.h"
@@ -39,8 +40,10 @@
 #include "libhashkit-1.0/hashkit.h"
 
 #include "libmemcached-1.0/struct/callback.h"
+#include "libmemcached-1.0/struct/compression.h"
 #include "libmemcached-1.0/struct/string.h"
 #include "libmemcached-1.0/struct/result.h"
+#include "libmemcached-1.0/struct/view.h"
 #include "libmemcached-1.0/struct/allocator.h"
 #include "libmemcached-1.0/struct/sasl.h"
 #include "libmemcached-1.0/struct/memcached.h"
@@ -54,9 +57,11 @@
 // Everything above this line must be in the order specified.
 #include "libmemcached-1.0/allocators.h"
 #include "libmemcached-1.0/analyze.h"
+#include "libmemcached-1.0/async.h"
 #include "libmemcached-1.0/auto.h"
 #include "libmemcached-1.0/behavior.h"
 #include "libmemcached-1.0/callback.h"
+#include "libmemcached-1.0/compression.h"
 #include "libmemcached-1.0/delete.h"
 #include "libmemcached-1.0/dump.h"
 #include "libmemcached-1.0/encoding_key.h"
@@ -115,6 +120,12 @@ void *memcached_set_user_data(memcached_st *ptr, void *data);
 LIBMEMCACHED_API
 memcached_return_t memcached_push(memcached_st *destination, const memcached_st *source);
 
+LIBMEMCACHED_API
+memcached_return_t memcached_servers_update(memcached_st *ptr, const memcached_st *source);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_connect_all(memcached_st *ptr);
+
 LIBMEMCACHED_API
 const memcached_instance_st *memcached_server_instance_by_position(const memcached_st *ptr,
                                                                    uint32_t server_key);
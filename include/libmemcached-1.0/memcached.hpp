@@ -670,7 +670,7 @@ public:
     return true;
   }
 
-private:
+protected:
   memcached_st *memc_;
 };
 
@@ -81,6 +81,71 @@ memcached_return_t memcached_cas_by_key(memcached_st *ptr, const char *group_key
                                         const char *value, size_t value_length, time_t expiration,
                                         uint32_t flags, uint64_t cas);
 
+/*
+  Store number_of_keys items at once, pipelined per server. expiration and flags may be NULL for
+  0, results, if not NULL, receives the outcome per key. Returns MEMCACHED_SOME_ERRORS if any key
+  failed.
+*/
+LIBMEMCACHED_API
+memcached_return_t memcached_mset(memcached_st *ptr, const char *const *keys,
+                                  const size_t *key_length, const char *const *values,
+                                  const size_t *value_length, const time_t *expiration,
+                                  const uint32_t *flags, size_t number_of_keys,
+                                  memcached_return_t *results);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_madd(memcached_st *ptr, const char *const *keys,
+                                  const size_t *key_length, const char *const *values,
+                                  const size_t *value_length, const time_t *expiration,
+                                  const uint32_t *flags, size_t number_of_keys,
+                                  memcached_return_t *results);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_mreplace(memcached_st *ptr, const char *const *keys,
+                                      const size_t *key_length, const char *const *values,
+                                      const size_t *value_length, const time_t *expiration,
+                                      const uint32_t *flags, size_t number_of_keys,
+                                      memcached_return_t *results);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_mcas(memcached_st *ptr, const char *const *keys,
+                                  const size_t *key_length, const char *const *values,
+                                  const size_t *value_length, const time_t *expiration,
+                                  const uint32_t *flags, const uint64_t *cas,
+                                  size_t number_of_keys, memcached_return_t *results);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_mset_by_key(memcached_st *ptr, const char *group_key,
+                                         size_t group_key_length, const char *const *keys,
+                                         const size_t *key_length, const char *const *values,
+                                         const size_t *value_length, const time_t *expiration,
+                                         const uint32_t *flags, size_t number_of_keys,
+                                         memcached_return_t *results);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_madd_by_key(memcached_st *ptr, const char *group_key,
+                                         size_t group_key_length, const char *const *keys,
+                                         const size_t *key_length, const char *const *values,
+                                         const size_t *value_length, const time_t *expiration,
+                                         const uint32_t *flags, size_t number_of_keys,
+                                         memcached_return_t *results);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_mreplace_by_key(memcached_st *ptr, const char *group_key,
+                                             size_t group_key_length, const char *const *keys,
+                                             const size_t *key_length, const char *const *values,
+                                             const size_t *value_length, const time_t *expiration,
+                                             const uint32_t *flags, size_t number_of_keys,
+                                             memcached_return_t *results);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_mcas_by_key(memcached_st *ptr, const char *group_key,
+                                         size_t group_key_length, const char *const *keys,
+                                         const size_t *key_length, const char *const *values,
+                                         const size_t *value_length, const time_t *expiration,
+                                         const uint32_t *flags, const uint64_t *cas,
+                                         size_t number_of_keys, memcached_return_t *results);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,27 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/* counters of the values compressed and decompressed by a memcached_st */
+struct memcached_compression_stat_st {
+  uint64_t compressed;         // values stored compressed
+  uint64_t compressed_bytes;   // their size before compression
+  uint64_t compressed_size;    // their size after compression
+  uint64_t not_compressed;     // values not reaching MEMCACHED_BEHAVIOR_COMPRESSION_RATIO
+  uint64_t decompressed;       // values decompressed
+  uint64_t decompressed_bytes; // their size after decompression
+  uint64_t failed;             // values failing to decompress
+};
@@ -61,11 +61,26 @@ struct memcached_st {
   uint32_t io_msg_watermark;
   uint32_t io_bytes_watermark;
   uint32_t io_key_prefetch;
+  uint32_t io_sendmsg_threshold;
+  uint32_t io_zerocopy_threshold;
+  uint32_t io_buffer_min;
+  uint32_t io_buffer_max;
+  uint32_t encryption_ctr_flag;
+  struct {
+    uint32_t flag;
+    uint32_t threshold;
+    uint32_t ratio;
+    int32_t level;
+    memcached_compression_t algorithm;
+    struct memcached_compression_stat_st stat;
+    struct memcached_compression_context_st *context;
+  } compression;
   uint32_t tcp_keepidle;
   int32_t poll_timeout;
   int32_t connect_timeout; // How long we will wait on connect() before we will timeout
   int32_t retry_timeout;
   int32_t dead_timeout;
+  int32_t dns_ttl;
   int send_size;
   int recv_size;
   void *user_data;
@@ -79,9 +94,14 @@ struct memcached_st {
     uint32_t continuum_points_counter;             // Ketama
     time_t next_distribution_rebuild;              // Ketama
     struct memcached_continuum_item_st *continuum; // Ketama
+    struct memcached_continuum_search_st *continuum_search; // Ketama
   } ketama;
 
   struct memcached_virtual_bucket_t *virtual_bucket;
+  struct memcached_rendezvous_st *rendezvous;
+  struct memcached_maglev_st *maglev;
+  struct memcached_io_ring_st *io_ring;
+  int io_epoll;
 
   struct memcached_allocator_t allocators;
 
@@ -96,6 +116,7 @@ struct memcached_st {
   struct {
     uint32_t initial_pool_size;
     uint32_t max_pool_size;
+    bool pool_thread_cache;
     int32_t
         version; // This is used by pool and others to determine if the memcached_st is out of date.
     struct memcached_array_st *filename;
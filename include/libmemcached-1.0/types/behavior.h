@@ -54,6 +54,18 @@ enum memcached_behavior_t {
   MEMCACHED_BEHAVIOR_REMOVE_FAILED_SERVERS,
   MEMCACHED_BEHAVIOR_DEAD_TIMEOUT,
   MEMCACHED_BEHAVIOR_SERVER_TIMEOUT_LIMIT,
+  MEMCACHED_BEHAVIOR_IO_URING,
+  MEMCACHED_BEHAVIOR_IO_SENDMSG_THRESHOLD,
+  MEMCACHED_BEHAVIOR_IO_ZEROCOPY_THRESHOLD,
+  MEMCACHED_BEHAVIOR_IO_BUFFER_MIN,
+  MEMCACHED_BEHAVIOR_IO_BUFFER_MAX,
+  MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG,
+  MEMCACHED_BEHAVIOR_COMPRESSION_FLAG,
+  MEMCACHED_BEHAVIOR_COMPRESSION,
+  MEMCACHED_BEHAVIOR_COMPRESSION_LEVEL,
+  MEMCACHED_BEHAVIOR_COMPRESSION_THRESHOLD,
+  MEMCACHED_BEHAVIOR_COMPRESSION_RATIO,
+  MEMCACHED_BEHAVIOR_DNS_TTL,
   MEMCACHED_BEHAVIOR_MAX
 };
 
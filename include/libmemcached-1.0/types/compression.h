@@ -0,0 +1,26 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+enum memcached_compression_t {
+  MEMCACHED_COMPRESSION_LZ4 = 1,
+  MEMCACHED_COMPRESSION_ZSTD,
+  MEMCACHED_COMPRESSION_MAX
+};
+
+#ifndef __cplusplus
+typedef enum memcached_compression_t memcached_compression_t;
+#endif
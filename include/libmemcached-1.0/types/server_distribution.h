@@ -23,6 +23,10 @@ enum memcached_server_distribution_t {
   MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA_SPY,
   MEMCACHED_DISTRIBUTION_CONSISTENT_WEIGHTED,
   MEMCACHED_DISTRIBUTION_VIRTUAL_BUCKET,
+  MEMCACHED_DISTRIBUTION_JUMP,
+  MEMCACHED_DISTRIBUTION_RENDEZVOUS,
+  MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON,
+  MEMCACHED_DISTRIBUTION_MAGLEV,
   MEMCACHED_DISTRIBUTION_CONSISTENT_MAX
 };
 
@@ -0,0 +1,51 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+#include "libmemcached-1.0/memcached.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct memcached_mux_st;
+typedef struct memcached_mux_st memcached_mux_st;
+
+LIBMEMCACHED_API
+memcached_mux_st *memcached_mux_create(const memcached_st *master);
+
+LIBMEMCACHED_API
+memcached_mux_st *memcached_mux(const char *option_string, size_t option_string_length);
+
+LIBMEMCACHED_API
+void memcached_mux_destroy(memcached_mux_st *mux);
+
+LIBMEMCACHED_API
+char *memcached_mux_get(memcached_mux_st *mux, const char *key, size_t key_length,
+                        size_t *value_length, uint32_t *flags, memcached_return_t *error);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_mux_set(memcached_mux_st *mux, const char *key, size_t key_length,
+                                     const char *value, size_t value_length, time_t expiration,
+                                     uint32_t flags);
+
+LIBMEMCACHED_API
+memcached_return_t memcached_mux_delete(memcached_mux_st *mux, const char *key,
+                                        size_t key_length);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -51,6 +51,10 @@ LIBMEMCACHED_API
 memcached_return_t memcached_pool_behavior_get(memcached_pool_st *ptr, memcached_behavior_t flag,
                                                uint64_t *value);
 
+LIBMEMCACHED_API
+memcached_return_t memcached_pool_servers_set(memcached_pool_st *ptr,
+                                              const memcached_server_list_st servers);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
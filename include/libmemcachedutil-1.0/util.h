@@ -19,6 +19,7 @@
 
 #include "libmemcachedutil-1.0/pid.h"
 #include "libmemcachedutil-1.0/flush.h"
+#include "libmemcachedutil-1.0/mux.h"
 #include "libmemcachedutil-1.0/ping.h"
 #include "libmemcachedutil-1.0/pool.h"
 #include "libmemcachedutil-1.0/version.h"
@@ -259,6 +259,16 @@ int main(int argc, char *argv[]) {
     }
     return true;
   };
+  opt.add("io-uring", 'I', no_argument, "Use the io_uring I/O backend (compare with a run without).")
+      .apply = [](const client_options &opt_, const client_options::extended_option &ext, memcached_st *memc) {
+    if (MEMCACHED_SUCCESS != memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_URING, ext.set)) {
+      if (!opt_.isset("quiet")) {
+        std::cerr << memcached_last_error_message(memc) << "\n";
+      }
+      return false;
+    }
+    return true;
+  };
   opt.add("flush", 'F', no_argument, "Flush all servers prior test.");
   opt.add("test", 't', required_argument, "Test to perform (options: get,mget,set; default: get).");
   opt.add("concurrency", 'c', required_argument, "Concurrency (number of threads to start; default: 1).")
@@ -16,22 +16,65 @@
 #include "libhashkit/common.h"
 
 #include <cstring>
+#include <random>
+
+#define AES_BLOCK_SIZE 16
+
+size_t aes_encrypt_length(hashkit_cipher_mode_t mode, size_t source_length) {
+  if (mode == HASHKIT_CIPHER_MODE_CTR) {
+    return AES_BLOCK_SIZE + source_length;
+  }
+  /* padded to whole blocks, with at least one byte of padding */
+  return (source_length / AES_BLOCK_SIZE + 1) * AES_BLOCK_SIZE;
+}
+
+/*
+  CTR initialization vectors are a random prefix drawn per key, the number of the item and
+  a 32 bit block counter starting at 0, so that no two items share a counter block.
+*/
+struct aes_nonce_t {
+  uint64_t prefix;
+  uint32_t count;
+};
+
+static void aes_nonce_init(aes_nonce_t &nonce) {
+  std::random_device random;
+
+  nonce.prefix = (uint64_t(random()) << 32) ^ uint64_t(random());
+  nonce.count = 0;
+}
+
+static void aes_nonce_next(aes_nonce_t &nonce, unsigned char iv[AES_BLOCK_SIZE]) {
+  if (++nonce.count == 0) {
+    aes_nonce_init(nonce);
+    nonce.count = 1;
+  }
+
+  memcpy(iv, &nonce.prefix, 8);
+  iv[8] = (unsigned char) (nonce.count >> 24);
+  iv[9] = (unsigned char) (nonce.count >> 16);
+  iv[10] = (unsigned char) (nonce.count >> 8);
+  iv[11] = (unsigned char) nonce.count;
+  memset(iv + 12, 0, 4);
+}
+
 
 #ifdef HAVE_OPENSSL_CRYPTO
 
-#include <openssl/evp.h>
+#  include <openssl/evp.h>
 
-#define DIGEST_ROUNDS 5
+#  define DIGEST_ROUNDS 5
 
-#define AES_KEY_NBYTES 32
-#define AES_IV_NBYTES  32
+#  define AES_KEY_NBYTES 32
+#  define AES_IV_NBYTES  32
 
 struct aes_key_t {
   EVP_CIPHER_CTX *encryption_context;
   EVP_CIPHER_CTX *decryption_context;
+  EVP_CIPHER_CTX *ctr_context;
+  aes_nonce_t nonce;
 };
 
-
 aes_key_t *aes_create_key(const char *key, const size_t key_length) {
   unsigned char aes_key[AES_KEY_NBYTES];
   unsigned char aes_iv[AES_IV_NBYTES];
@@ -47,80 +90,125 @@ aes_key_t *aes_create_key(const char *key, const size_t key_length) {
     return NULL;
   }
 
-  aes_key_t *aes_ctx = (aes_key_t *) malloc(sizeof(aes_key_t));
-
-  if (!(aes_ctx->encryption_context = EVP_CIPHER_CTX_new())) {
+  aes_key_t *aes_ctx = (aes_key_t *) calloc(1, sizeof(aes_key_t));
+  if (!aes_ctx) {
     return NULL;
   }
-  if (!(aes_ctx->decryption_context = EVP_CIPHER_CTX_new())) {
-    EVP_CIPHER_CTX_free(aes_ctx->encryption_context);
+
+  if (!(aes_ctx->encryption_context = EVP_CIPHER_CTX_new())
+      || !(aes_ctx->decryption_context = EVP_CIPHER_CTX_new())
+      || !(aes_ctx->ctr_context = EVP_CIPHER_CTX_new()))
+  {
+    aes_free_key(aes_ctx);
     return NULL;
   }
 
   EVP_CIPHER_CTX_init(aes_ctx->encryption_context);
   EVP_CIPHER_CTX_init(aes_ctx->decryption_context);
   if (EVP_EncryptInit_ex(aes_ctx->encryption_context, EVP_aes_256_cbc(), NULL, ukey, aes_iv) != 1
-      || EVP_DecryptInit_ex(aes_ctx->decryption_context, EVP_aes_256_cbc(), NULL, ukey, aes_iv) != 1)
+      || EVP_DecryptInit_ex(aes_ctx->decryption_context, EVP_aes_256_cbc(), NULL, ukey, aes_iv) != 1
+      || EVP_EncryptInit_ex(aes_ctx->ctr_context, EVP_aes_256_ctr(), NULL, aes_key, NULL) != 1)
   {
     aes_free_key(aes_ctx);
     return NULL;
   }
+  aes_nonce_init(aes_ctx->nonce);
 
   return aes_ctx;
 }
 
-hashkit_string_st *aes_encrypt(aes_key_t *ctx, const char *source, size_t source_length) {
+/* CTR en- and decryption are the same, destination may equal source */
+static bool aes_ctr(aes_key_t *ctx, const unsigned char iv[AES_BLOCK_SIZE], const char *source,
+                    size_t source_length, char *destination) {
+  int length = 0;
+
+  return EVP_EncryptInit_ex(ctx->ctr_context, NULL, NULL, NULL, iv) == 1
+      && EVP_EncryptUpdate(ctx->ctr_context, (unsigned char *) destination, &length,
+                           (const unsigned char *) source, (int) source_length)
+      == 1;
+}
+
+bool aes_encrypt_buffer(aes_key_t *ctx, hashkit_cipher_mode_t mode, const char *source,
+                        size_t source_length, char *destination, size_t *destination_length) {
+  if (!ctx || *destination_length < aes_encrypt_length(mode, source_length)) {
+    return false;
+  }
+
+  if (mode == HASHKIT_CIPHER_MODE_CTR) {
+    unsigned char iv[AES_BLOCK_SIZE];
+
+    aes_nonce_next(ctx->nonce, iv);
+    memcpy(destination, iv, AES_BLOCK_SIZE);
+    *destination_length = AES_BLOCK_SIZE + source_length;
+    return aes_ctr(ctx, iv, source, source_length, destination + AES_BLOCK_SIZE);
+  }
+
   EVP_CIPHER_CTX *encryption_context = ctx->encryption_context;
-  int cipher_length = source_length + EVP_CIPHER_CTX_block_size(encryption_context);
+  unsigned char *cipher_text = (unsigned char *) destination;
+  int cipher_length = 0;
   int final_length = 0;
-  const unsigned char *usource = (const unsigned char *) source;
-  unsigned char *cipher_text = (unsigned char *) malloc(cipher_length);
-  if (!cipher_text) {
-    return NULL;
-  }
+
   if (EVP_EncryptInit_ex(encryption_context, NULL, NULL, NULL, NULL) != 1
-      || EVP_EncryptUpdate(encryption_context, cipher_text, &cipher_length, usource, source_length) != 1
+      || EVP_EncryptUpdate(encryption_context, cipher_text, &cipher_length,
+                           (const unsigned char *) source, source_length) != 1
       || EVP_EncryptFinal_ex(encryption_context, cipher_text + cipher_length, &final_length) != 1)
   {
-    free(cipher_text);
-    return NULL;
+    return false;
   }
 
-  hashkit_string_st *destination = hashkit_string_create(cipher_length + final_length);
-  if (!destination) {
-    return NULL;
-  }
-  char *dest = hashkit_string_c_str_mutable(destination);
-  memcpy(dest, cipher_text, cipher_length + final_length);
-  hashkit_string_set_length(destination, cipher_length + final_length);
-  return destination;
+  *destination_length = cipher_length + final_length;
+  return true;
 }
 
-hashkit_string_st *aes_decrypt(aes_key_t *ctx, const char *source, size_t source_length) {
+bool aes_decrypt_buffer(aes_key_t *ctx, hashkit_cipher_mode_t mode, const char *source,
+                        size_t source_length, char *destination, size_t *destination_length) {
+  if (!ctx) {
+    return false;
+  }
+
+  if (mode == HASHKIT_CIPHER_MODE_CTR) {
+    if (source_length < AES_BLOCK_SIZE
+        || *destination_length < source_length - AES_BLOCK_SIZE) {
+      return false;
+    }
+
+    unsigned char iv[AES_BLOCK_SIZE];
+    size_t length = source_length - AES_BLOCK_SIZE;
+
+    memcpy(iv, source, AES_BLOCK_SIZE);
+    /* EVP refuses partially overlapping buffers, decrypt in place and move down */
+    if (destination == source) {
+      char *text = destination + AES_BLOCK_SIZE;
+      if (!aes_ctr(ctx, iv, text, length, text)) {
+        return false;
+      }
+      memmove(destination, text, length);
+    } else if (!aes_ctr(ctx, iv, source + AES_BLOCK_SIZE, length, destination)) {
+      return false;
+    }
+    *destination_length = length;
+    return true;
+  }
+
+  if (*destination_length < source_length) {
+    return false;
+  }
+
   EVP_CIPHER_CTX *decryption_context = ctx->decryption_context;
-  int plain_text_length = source_length;
+  unsigned char *plain_text = (unsigned char *) destination;
+  int plain_text_length = 0;
   int final_length = 0;
-  const unsigned char *usource = (const unsigned char *) source;
-  unsigned char *plain_text = (unsigned char *) malloc(plain_text_length);
-  if (!plain_text) {
-    return NULL;
-  }
+
   if (EVP_DecryptInit_ex(decryption_context, NULL, NULL, NULL, NULL) != 1
-      || EVP_DecryptUpdate(decryption_context, plain_text, &plain_text_length, usource, source_length) != 1
+      || EVP_DecryptUpdate(decryption_context, plain_text, &plain_text_length,
+                           (const unsigned char *) source, source_length) != 1
       || EVP_DecryptFinal_ex(decryption_context, plain_text + plain_text_length, &final_length) != 1)
   {
-    free(plain_text);
-    return NULL;
+    return false;
   }
 
-  hashkit_string_st *destination = hashkit_string_create(plain_text_length + final_length);
-  if (!destination) {
-    return NULL;
-  }
-  char *dest = hashkit_string_c_str_mutable(destination);
-  memcpy(dest, plain_text, plain_text_length + final_length);
-  hashkit_string_set_length(destination, plain_text_length + final_length);
-  return destination;
+  *destination_length = plain_text_length + final_length;
+  return true;
 }
 
 aes_key_t *aes_clone_key(aes_key_t *old_context) {
@@ -128,16 +216,21 @@ aes_key_t *aes_clone_key(aes_key_t *old_context) {
     return NULL;
   }
 
-  aes_key_t *new_context = (aes_key_t *) malloc(sizeof(aes_key_t));
+  aes_key_t *new_context = (aes_key_t *) calloc(1, sizeof(aes_key_t));
   if (new_context) {
     new_context->encryption_context = EVP_CIPHER_CTX_new();
     new_context->decryption_context = EVP_CIPHER_CTX_new();
-    if (!new_context->encryption_context || !new_context->decryption_context) {
+    new_context->ctr_context = EVP_CIPHER_CTX_new();
+    if (!new_context->encryption_context || !new_context->decryption_context
+        || !new_context->ctr_context) {
       aes_free_key(new_context);
       return NULL;
     }
     EVP_CIPHER_CTX_copy(new_context->encryption_context, old_context->encryption_context);
     EVP_CIPHER_CTX_copy(new_context->decryption_context, old_context->decryption_context);
+    EVP_CIPHER_CTX_copy(new_context->ctr_context, old_context->ctr_context);
+    /* a clone must never continue the counter blocks of the original */
+    aes_nonce_init(new_context->nonce);
   }
 
   return new_context;
@@ -153,6 +246,10 @@ void aes_free_key(aes_key_t *context) {
       EVP_CIPHER_CTX_free(context->decryption_context);
       context->decryption_context = NULL;
     }
+    if (context->ctr_context) {
+      EVP_CIPHER_CTX_free(context->ctr_context);
+      context->ctr_context = NULL;
+    }
     free(context);
   }
 }
@@ -161,10 +258,14 @@ void aes_free_key(aes_key_t *context) {
 
 #  include "libhashkit/rijndael.hpp"
 
-#  define AES_KEY_LENGTH 256 /* 128, 192, 256 */
-#  define AES_BLOCK_SIZE 16
+#  if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#    define HASHKIT_AES_NI 1
+#    include <wmmintrin.h>
+#  else
+#    define HASHKIT_AES_NI 0
+#  endif
 
-enum encrypt_t { AES_ENCRYPT, AES_DECRYPT };
+#  define AES_KEY_LENGTH 256 /* 128, 192, 256 */
 
 struct _key_t {
   int nr;
@@ -174,8 +275,138 @@ struct _key_t {
 struct aes_key_t {
   _key_t encode_key;
   _key_t decode_key;
+  aes_nonce_t nonce;
+#  if HASHKIT_AES_NI
+  /* the round keys as bytes, the decryption ones for the equivalent inverse cipher */
+  bool aes_ni;
+  unsigned char encode_rk[AES_MAXNR + 1][AES_BLOCK_SIZE];
+  unsigned char decode_rk[AES_MAXNR + 1][AES_BLOCK_SIZE];
+#  endif
 };
 
+#  if HASHKIT_AES_NI
+static bool aes_has_aes_ni() {
+  static const bool has_aes_ni = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("aes") != 0;
+  }();
+
+  return has_aes_ni;
+}
+
+__attribute__((target("aes,sse2"))) static void aes_ni_setup(aes_key_t *key) {
+  int nr = key->encode_key.nr;
+
+  for (int r = 0; r <= nr; ++r) {
+    for (int w = 0; w < 4; ++w) {
+      uint32_t word = key->encode_key.rk[4 * r + w];
+
+      key->encode_rk[r][4 * w] = (unsigned char) (word >> 24);
+      key->encode_rk[r][4 * w + 1] = (unsigned char) (word >> 16);
+      key->encode_rk[r][4 * w + 2] = (unsigned char) (word >> 8);
+      key->encode_rk[r][4 * w + 3] = (unsigned char) word;
+    }
+  }
+
+  memcpy(key->decode_rk[0], key->encode_rk[nr], AES_BLOCK_SIZE);
+  for (int r = 1; r < nr; ++r) {
+    __m128i rk = _mm_loadu_si128((const __m128i *) key->encode_rk[nr - r]);
+    _mm_storeu_si128((__m128i *) key->decode_rk[r], _mm_aesimc_si128(rk));
+  }
+  memcpy(key->decode_rk[nr], key->encode_rk[0], AES_BLOCK_SIZE);
+}
+
+/* ECB over whole blocks, four at a time to fill the pipeline of the AES unit */
+__attribute__((target("aes,sse2"))) static void
+aes_ni_crypt(const unsigned char rks[][AES_BLOCK_SIZE], int nr, bool decrypt,
+             const unsigned char *in, unsigned char *out, size_t blocks) {
+  __m128i rk[AES_MAXNR + 1];
+
+  for (int r = 0; r <= nr; ++r) {
+    rk[r] = _mm_loadu_si128((const __m128i *) rks[r]);
+  }
+
+  for (; blocks >= 4; blocks -= 4, in += 4 * AES_BLOCK_SIZE, out += 4 * AES_BLOCK_SIZE) {
+    __m128i b0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in), rk[0]);
+    __m128i b1 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (in + 16)), rk[0]);
+    __m128i b2 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (in + 32)), rk[0]);
+    __m128i b3 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (in + 48)), rk[0]);
+
+    if (decrypt) {
+      for (int r = 1; r < nr; ++r) {
+        b0 = _mm_aesdec_si128(b0, rk[r]);
+        b1 = _mm_aesdec_si128(b1, rk[r]);
+        b2 = _mm_aesdec_si128(b2, rk[r]);
+        b3 = _mm_aesdec_si128(b3, rk[r]);
+      }
+      b0 = _mm_aesdeclast_si128(b0, rk[nr]);
+      b1 = _mm_aesdeclast_si128(b1, rk[nr]);
+      b2 = _mm_aesdeclast_si128(b2, rk[nr]);
+      b3 = _mm_aesdeclast_si128(b3, rk[nr]);
+    } else {
+      for (int r = 1; r < nr; ++r) {
+        b0 = _mm_aesenc_si128(b0, rk[r]);
+        b1 = _mm_aesenc_si128(b1, rk[r]);
+        b2 = _mm_aesenc_si128(b2, rk[r]);
+        b3 = _mm_aesenc_si128(b3, rk[r]);
+      }
+      b0 = _mm_aesenclast_si128(b0, rk[nr]);
+      b1 = _mm_aesenclast_si128(b1, rk[nr]);
+      b2 = _mm_aesenclast_si128(b2, rk[nr]);
+      b3 = _mm_aesenclast_si128(b3, rk[nr]);
+    }
+
+    _mm_storeu_si128((__m128i *) out, b0);
+    _mm_storeu_si128((__m128i *) (out + 16), b1);
+    _mm_storeu_si128((__m128i *) (out + 32), b2);
+    _mm_storeu_si128((__m128i *) (out + 48), b3);
+  }
+
+  for (; blocks; --blocks, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE) {
+    __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i *) in), rk[0]);
+
+    if (decrypt) {
+      for (int r = 1; r < nr; ++r) {
+        b = _mm_aesdec_si128(b, rk[r]);
+      }
+      b = _mm_aesdeclast_si128(b, rk[nr]);
+    } else {
+      for (int r = 1; r < nr; ++r) {
+        b = _mm_aesenc_si128(b, rk[r]);
+      }
+      b = _mm_aesenclast_si128(b, rk[nr]);
+    }
+    _mm_storeu_si128((__m128i *) out, b);
+  }
+}
+#  endif
+
+static void aes_encrypt_blocks(const aes_key_t *_aes_key, const unsigned char *in,
+                               unsigned char *out, size_t blocks) {
+#  if HASHKIT_AES_NI
+  if (_aes_key->aes_ni) {
+    aes_ni_crypt(_aes_key->encode_rk, _aes_key->encode_key.nr, false, in, out, blocks);
+    return;
+  }
+#  endif
+  for (; blocks; --blocks, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE) {
+    rijndaelEncrypt(_aes_key->encode_key.rk, _aes_key->encode_key.nr, in, out);
+  }
+}
+
+static void aes_decrypt_blocks(const aes_key_t *_aes_key, const unsigned char *in,
+                               unsigned char *out, size_t blocks) {
+#  if HASHKIT_AES_NI
+  if (_aes_key->aes_ni) {
+    aes_ni_crypt(_aes_key->decode_rk, _aes_key->decode_key.nr, true, in, out, blocks);
+    return;
+  }
+#  endif
+  for (; blocks; --blocks, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE) {
+    rijndaelDecrypt(_aes_key->decode_key.rk, _aes_key->decode_key.nr, in, out);
+  }
+}
+
 aes_key_t *aes_create_key(const char *key, const size_t key_length) {
   aes_key_t *_aes_key = (aes_key_t *) (calloc(1, sizeof(aes_key_t)));
   if (_aes_key) {
@@ -196,6 +427,12 @@ aes_key_t *aes_create_key(const char *key, const size_t key_length) {
 
     _aes_key->decode_key.nr = rijndaelKeySetupDec(_aes_key->decode_key.rk, rkey, AES_KEY_LENGTH);
     _aes_key->encode_key.nr = rijndaelKeySetupEnc(_aes_key->encode_key.rk, rkey, AES_KEY_LENGTH);
+#  if HASHKIT_AES_NI
+    if ((_aes_key->aes_ni = aes_has_aes_ni())) {
+      aes_ni_setup(_aes_key);
+    }
+#  endif
+    aes_nonce_init(_aes_key->nonce);
   }
 
   return _aes_key;
@@ -209,78 +446,120 @@ aes_key_t *aes_clone_key(aes_key_t *_aes_key) {
   aes_key_t *_aes_clone_key = (aes_key_t *) (calloc(1, sizeof(aes_key_t)));
   if (_aes_clone_key) {
     memcpy(_aes_clone_key, _aes_key, sizeof(aes_key_t));
+    /* a clone must never continue the counter blocks of the original */
+    aes_nonce_init(_aes_clone_key->nonce);
   }
 
   return _aes_clone_key;
 }
 
-hashkit_string_st *aes_encrypt(aes_key_t *_aes_key, const char *source, size_t source_length) {
-  if (!_aes_key) {
-    return NULL;
-  }
+/* CTR en- and decryption are the same, destination may equal or precede source */
+static void aes_ctr(const aes_key_t *_aes_key, const unsigned char iv[AES_BLOCK_SIZE],
+                    const char *source, size_t source_length, char *destination) {
+  unsigned char counter[64 * AES_BLOCK_SIZE], stream[64 * AES_BLOCK_SIZE];
+  uint32_t block = 0;
 
-  size_t num_blocks = source_length / AES_BLOCK_SIZE;
+  while (source_length) {
+    size_t length = source_length < sizeof(stream) ? source_length : sizeof(stream);
+    size_t blocks = (length + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
 
-  hashkit_string_st *destination = hashkit_string_create(source_length);
-  if (destination) {
-    char *dest = hashkit_string_c_str_mutable(destination);
+    for (size_t x = 0; x < blocks; ++x, ++block) {
+      unsigned char *c = counter + x * AES_BLOCK_SIZE;
 
-    for (size_t x = num_blocks; x > 0; x--) /* Encode complete blocks */ {
-      rijndaelEncrypt(_aes_key->encode_key.rk, _aes_key->encode_key.nr, (const uint8_t *) (source),
-                      (uint8_t *) (dest));
-      source += AES_BLOCK_SIZE;
-      dest += AES_BLOCK_SIZE;
+      memcpy(c, iv, 12);
+      c[12] = (unsigned char) (block >> 24);
+      c[13] = (unsigned char) (block >> 16);
+      c[14] = (unsigned char) (block >> 8);
+      c[15] = (unsigned char) block;
     }
+    aes_encrypt_blocks(_aes_key, counter, stream, blocks);
 
-    uint8_t block[AES_BLOCK_SIZE];
-    char pad_len = AES_BLOCK_SIZE - (source_length - AES_BLOCK_SIZE * num_blocks);
-    memcpy(block, source, 16 - pad_len);
-    memset(block + AES_BLOCK_SIZE - pad_len, pad_len, pad_len);
-    rijndaelEncrypt(_aes_key->encode_key.rk, _aes_key->encode_key.nr, block, (uint8_t *) (dest));
-    hashkit_string_set_length(destination, AES_BLOCK_SIZE * (num_blocks + 1));
+    for (size_t x = 0; x < length; ++x) {
+      destination[x] = char(source[x] ^ stream[x]);
+    }
+    source += length;
+    destination += length;
+    source_length -= length;
   }
-
-  return destination;
 }
 
-hashkit_string_st *aes_decrypt(aes_key_t *_aes_key, const char *source, size_t source_length) {
-  if (!_aes_key) {
-    return NULL;
+bool aes_encrypt_buffer(aes_key_t *_aes_key, hashkit_cipher_mode_t mode, const char *source,
+                        size_t source_length, char *destination, size_t *destination_length) {
+  if (!_aes_key or *destination_length < aes_encrypt_length(mode, source_length)) {
+    return false;
   }
 
-  size_t num_blocks = source_length / AES_BLOCK_SIZE;
-  if ((source_length != num_blocks * AES_BLOCK_SIZE) or num_blocks == 0) {
-    return NULL;
+  if (mode == HASHKIT_CIPHER_MODE_CTR) {
+    unsigned char iv[AES_BLOCK_SIZE];
+
+    aes_nonce_next(_aes_key->nonce, iv);
+    memcpy(destination, iv, AES_BLOCK_SIZE);
+    aes_ctr(_aes_key, iv, source, source_length, destination + AES_BLOCK_SIZE);
+    *destination_length = AES_BLOCK_SIZE + source_length;
+    return true;
   }
 
-  hashkit_string_st *destination = hashkit_string_create(source_length);
-  if (destination) {
-    char *dest = hashkit_string_c_str_mutable(destination);
+  size_t num_blocks = source_length / AES_BLOCK_SIZE;
 
-    for (size_t x = num_blocks - 1; x > 0; x--) {
-      rijndaelDecrypt(_aes_key->decode_key.rk, _aes_key->decode_key.nr, (const uint8_t *) (source),
-                      (uint8_t *) (dest));
-      source += AES_BLOCK_SIZE;
-      dest += AES_BLOCK_SIZE;
-    }
+  /* Encode complete blocks */
+  aes_encrypt_blocks(_aes_key, (const uint8_t *) source, (uint8_t *) destination, num_blocks);
+  source += AES_BLOCK_SIZE * num_blocks;
+  destination += AES_BLOCK_SIZE * num_blocks;
 
-    uint8_t block[AES_BLOCK_SIZE];
-    rijndaelDecrypt(_aes_key->decode_key.rk, _aes_key->decode_key.nr, (const uint8_t *) (source),
-                    block);
-    /* Use last char in the block as size */
-    unsigned int pad_len = (unsigned int) (unsigned char) (block[AES_BLOCK_SIZE - 1]);
-    if (pad_len > AES_BLOCK_SIZE) {
-      hashkit_string_free(destination);
-      return NULL;
+  uint8_t block[AES_BLOCK_SIZE];
+  char pad_len = AES_BLOCK_SIZE - (source_length - AES_BLOCK_SIZE * num_blocks);
+  memcpy(block, source, 16 - pad_len);
+  memset(block + AES_BLOCK_SIZE - pad_len, pad_len, pad_len);
+  aes_encrypt_blocks(_aes_key, block, (uint8_t *) destination, 1);
+  *destination_length = AES_BLOCK_SIZE * (num_blocks + 1);
+
+  return true;
+}
+
+bool aes_decrypt_buffer(aes_key_t *_aes_key, hashkit_cipher_mode_t mode, const char *source,
+                        size_t source_length, char *destination, size_t *destination_length) {
+  if (!_aes_key) {
+    return false;
+  }
+
+  if (mode == HASHKIT_CIPHER_MODE_CTR) {
+    if (source_length < AES_BLOCK_SIZE or *destination_length < source_length - AES_BLOCK_SIZE) {
+      return false;
     }
+    /* the IV is overwritten when decrypting in place */
+    unsigned char iv[AES_BLOCK_SIZE];
 
-    /* We could also check whole padding but we do not really need this */
+    memcpy(iv, source, AES_BLOCK_SIZE);
+    aes_ctr(_aes_key, iv, source + AES_BLOCK_SIZE, source_length - AES_BLOCK_SIZE, destination);
+    *destination_length = source_length - AES_BLOCK_SIZE;
+    return true;
+  }
 
-    memcpy(dest, block, AES_BLOCK_SIZE - pad_len);
-    hashkit_string_set_length(destination, AES_BLOCK_SIZE * num_blocks - pad_len);
+  size_t num_blocks = source_length / AES_BLOCK_SIZE;
+  if ((source_length != num_blocks * AES_BLOCK_SIZE) or num_blocks == 0
+      or *destination_length < source_length)
+  {
+    return false;
   }
 
-  return destination;
+  aes_decrypt_blocks(_aes_key, (const uint8_t *) source, (uint8_t *) destination, num_blocks - 1);
+  source += AES_BLOCK_SIZE * (num_blocks - 1);
+  destination += AES_BLOCK_SIZE * (num_blocks - 1);
+
+  uint8_t block[AES_BLOCK_SIZE];
+  aes_decrypt_blocks(_aes_key, (const uint8_t *) source, block, 1);
+  /* Use last char in the block as size */
+  unsigned int pad_len = (unsigned int) (unsigned char) (block[AES_BLOCK_SIZE - 1]);
+  if (pad_len > AES_BLOCK_SIZE) {
+    return false;
+  }
+
+  /* We could also check whole padding but we do not really need this */
+
+  memcpy(destination, block, AES_BLOCK_SIZE - pad_len);
+  *destination_length = AES_BLOCK_SIZE * num_blocks - pad_len;
+
+  return true;
 }
 
 void aes_free_key(aes_key_t *key) {
@@ -290,3 +569,43 @@ void aes_free_key(aes_key_t *key) {
 }
 
 #endif
+
+hashkit_string_st *aes_encrypt(aes_key_t *_aes_key, const char *source, size_t source_length) {
+  if (!_aes_key) {
+    return NULL;
+  }
+
+  size_t length = aes_encrypt_length(HASHKIT_CIPHER_MODE_DEFAULT, source_length);
+  hashkit_string_st *destination = hashkit_string_create(length);
+  if (destination) {
+    if (!aes_encrypt_buffer(_aes_key, HASHKIT_CIPHER_MODE_DEFAULT, source, source_length,
+                            hashkit_string_c_str_mutable(destination), &length))
+    {
+      hashkit_string_free(destination);
+      return NULL;
+    }
+    hashkit_string_set_length(destination, length);
+  }
+
+  return destination;
+}
+
+hashkit_string_st *aes_decrypt(aes_key_t *_aes_key, const char *source, size_t source_length) {
+  if (!_aes_key) {
+    return NULL;
+  }
+
+  size_t length = source_length;
+  hashkit_string_st *destination = hashkit_string_create(length);
+  if (destination) {
+    if (!aes_decrypt_buffer(_aes_key, HASHKIT_CIPHER_MODE_DEFAULT, source, source_length,
+                            hashkit_string_c_str_mutable(destination), &length))
+    {
+      hashkit_string_free(destination);
+      return NULL;
+    }
+    hashkit_string_set_length(destination, length);
+  }
+
+  return destination;
+}
@@ -21,6 +21,14 @@ hashkit_string_st *aes_encrypt(aes_key_t *_aes_key, const char *source, size_t s
 
 hashkit_string_st *aes_decrypt(aes_key_t *_aes_key, const char *source, size_t source_length);
 
+size_t aes_encrypt_length(hashkit_cipher_mode_t mode, size_t source_length);
+
+bool aes_encrypt_buffer(aes_key_t *_aes_key, hashkit_cipher_mode_t mode, const char *source,
+                        size_t source_length, char *destination, size_t *destination_length);
+
+bool aes_decrypt_buffer(aes_key_t *_aes_key, hashkit_cipher_mode_t mode, const char *source,
+                        size_t source_length, char *destination, size_t *destination_length);
+
 aes_key_t *aes_create_key(const char *key, size_t key_length);
 
 aes_key_t *aes_clone_key(aes_key_t *_aes_key);
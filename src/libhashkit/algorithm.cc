@@ -59,6 +59,20 @@ uint32_t libhashkit_md5(const char *key, size_t key_length) {
   return hashkit_md5(key, key_length, NULL);
 }
 
+uint32_t libhashkit_xxh3(const char *key, size_t key_length) {
+  return hashkit_xxh3(key, key_length, NULL);
+}
+
+uint32_t libhashkit_wyhash(const char *key, size_t key_length) {
+  return hashkit_wyhash(key, key_length, NULL);
+}
+
 void libhashkit_md5_signature(const unsigned char *key, size_t length, unsigned char *result) {
   md5_signature(key, (uint32_t) length, result);
 }
+
+void libhashkit_md5_signature_batch(const unsigned char *prefix, size_t prefix_length,
+                                    const unsigned char *const *keys, const size_t *key_length,
+                                    size_t number_of_keys, unsigned char *results) {
+  md5_signature_batch(prefix, prefix_length, keys, key_length, number_of_keys, results);
+}
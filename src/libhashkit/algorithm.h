@@ -39,4 +39,34 @@ uint32_t hashkit_jenkins(const char *key, size_t key_length, void *context);
 
 uint32_t hashkit_md5(const char *key, size_t key_length, void *context);
 
+uint32_t hashkit_xxh3(const char *key, size_t key_length, void *context);
+
+uint32_t hashkit_wyhash(const char *key, size_t key_length, void *context);
+
 }
+
+/*
+  Batched versions of the algorithms able to continue from the state after a prefix,
+  see hashkit_digest_batch().
+*/
+void hashkit_one_at_a_time_batch(const char *prefix, size_t prefix_length,
+                                 const char *const *keys, const size_t *key_length,
+                                 size_t count, uint32_t *hashes);
+
+void hashkit_fnv1_64_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                           const size_t *key_length, size_t count, uint32_t *hashes);
+
+void hashkit_fnv1a_64_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                            const size_t *key_length, size_t count, uint32_t *hashes);
+
+void hashkit_fnv1_32_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                           const size_t *key_length, size_t count, uint32_t *hashes);
+
+void hashkit_fnv1a_32_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                            const size_t *key_length, size_t count, uint32_t *hashes);
+
+void hashkit_crc32_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                         const size_t *key_length, size_t count, uint32_t *hashes);
+
+void hashkit_md5_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                       const size_t *key_length, size_t count, uint32_t *hashes);
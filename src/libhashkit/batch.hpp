@@ -0,0 +1,66 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+#include <algorithm>
+
+#define HASHKIT_BATCH_LANES 4
+
+/*
+  Hash keys sharing a prefix with an algorithm consuming a byte at a time. The prefix is
+  hashed once, and HASHKIT_BATCH_LANES keys at a time continue from its state, interleaved
+  over their common length, so that their independent dependency chains overlap.
+*/
+template<typename State, typename Step, typename Final>
+static inline void hashkit_batch_stream(State init, Step step, Final final, const char *prefix,
+                                        size_t prefix_length, const char *const *keys,
+                                        const size_t *key_length, size_t count,
+                                        uint32_t *hashes) {
+  State seed = init;
+  for (size_t i = 0; i < prefix_length; ++i) {
+    seed = step(seed, prefix[i]);
+  }
+
+  size_t x = 0;
+  for (; x + HASHKIT_BATCH_LANES <= count; x += HASHKIT_BATCH_LANES) {
+    State state[HASHKIT_BATCH_LANES];
+    size_t common = key_length[x];
+
+    for (size_t lane = 0; lane < HASHKIT_BATCH_LANES; ++lane) {
+      state[lane] = seed;
+      common = std::min(common, key_length[x + lane]);
+    }
+    for (size_t i = 0; i < common; ++i) {
+      for (size_t lane = 0; lane < HASHKIT_BATCH_LANES; ++lane) {
+        state[lane] = step(state[lane], keys[x + lane][i]);
+      }
+    }
+    for (size_t lane = 0; lane < HASHKIT_BATCH_LANES; ++lane) {
+      for (size_t i = common; i < key_length[x + lane]; ++i) {
+        state[lane] = step(state[lane], keys[x + lane][i]);
+      }
+      hashes[x + lane] = final(state[lane]);
+    }
+  }
+
+  for (; x < count; ++x) {
+    State state = seed;
+    for (size_t i = 0; i < key_length[x]; ++i) {
+      state = step(state, keys[x][i]);
+    }
+    hashes[x] = final(state);
+  }
+}
@@ -42,6 +42,10 @@ extern "C" {
 
 void md5_signature(const unsigned char *key, unsigned int length, unsigned char *result);
 
+void md5_signature_batch(const unsigned char *prefix, size_t prefix_length,
+                         const unsigned char *const *keys, const size_t *key_length, size_t count,
+                         unsigned char *results);
+
 int update_continuum(hashkit_st *hashkit);
 
 #ifdef __cplusplus
@@ -14,6 +14,13 @@
 */
 
 #include "libhashkit/common.h"
+#include "libhashkit/mul128.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  define HASHKIT_CRC32_CLMUL 1
+#else
+#  define HASHKIT_CRC32_CLMUL 0
+#endif
 
 static const uint32_t crc32tab[256] = {
     0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f, 0xe963a535, 0x9e6495a3,
@@ -50,12 +57,170 @@ static const uint32_t crc32tab[256] = {
     0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d,
 };
 
+/* crc32tab extended for slice-by-8, crc32_slices()[k][i] is the CRC of byte i followed by k zeros */
+static const uint32_t (*crc32_slices())[256] {
+  static struct crc32_slices_st {
+    uint32_t table[8][256];
+
+    crc32_slices_st() {
+      for (size_t i = 0; i < 256; ++i) {
+        table[0][i] = crc32tab[i];
+      }
+      for (size_t k = 1; k < 8; ++k) {
+        for (size_t i = 0; i < 256; ++i) {
+          table[k][i] = (table[k - 1][i] >> 8) ^ crc32tab[table[k - 1][i] & 0xff];
+        }
+      }
+    }
+  } slices;
+
+  return slices.table;
+}
+
+static uint32_t crc32_slice8(uint32_t crc, const uint8_t *p, size_t len) {
+  const uint32_t(*table)[256] = crc32_slices();
+
+  for (; len >= 8; len -= 8, p += 8) {
+    uint32_t one = hashkit_read32le(p) ^ crc;
+    uint32_t two = hashkit_read32le(p + 4);
+
+    crc = table[7][one & 0xff] ^ table[6][(one >> 8) & 0xff] ^ table[5][(one >> 16) & 0xff]
+        ^ table[4][one >> 24] ^ table[3][two & 0xff] ^ table[2][(two >> 8) & 0xff]
+        ^ table[1][(two >> 16) & 0xff] ^ table[0][two >> 24];
+  }
+  for (; len; --len, ++p) {
+    crc = (crc >> 8) ^ crc32tab[(crc ^ *p) & 0xff];
+  }
+
+  return crc;
+}
+
+#if HASHKIT_CRC32_CLMUL
+#  include <cpuid.h>
+#  include <immintrin.h>
+
+/*
+  Folding with carry-less multiplication, "Fast CRC Computation for Generic Polynomials
+  Using PCLMULQDQ Instruction", Intel 2009, with the constants of the bit-reflected
+  IEEE polynomial. Needs len >= 64 and a multiple of 16.
+*/
+__attribute__((target("pclmul,sse4.1"))) static uint32_t crc32_clmul(uint32_t crc,
+                                                                     const uint8_t *p,
+                                                                     size_t len) {
+  alignas(16) static const uint64_t k1k2[] = {0x0154442bd4ULL, 0x01c6e41596ULL};
+  alignas(16) static const uint64_t k3k4[] = {0x01751997d0ULL, 0x00ccaa009eULL};
+  alignas(16) static const uint64_t k5k0[] = {0x0163cd6124ULL, 0x0000000000ULL};
+  alignas(16) static const uint64_t poly[] = {0x01db710641ULL, 0x01f7011641ULL};
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+  x1 = _mm_loadu_si128((const __m128i *) (p + 0x00));
+  x2 = _mm_loadu_si128((const __m128i *) (p + 0x10));
+  x3 = _mm_loadu_si128((const __m128i *) (p + 0x20));
+  x4 = _mm_loadu_si128((const __m128i *) (p + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int) crc));
+  x0 = _mm_load_si128((const __m128i *) k1k2);
+  p += 64;
+  len -= 64;
+
+  /* fold 4 x 128 bits at a time */
+  while (len >= 64) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *) (p + 0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *) (p + 0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *) (p + 0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *) (p + 0x30)));
+    p += 64;
+    len -= 64;
+  }
+
+  /* fold into 128 bits */
+  x0 = _mm_load_si128((const __m128i *) k3k4);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  /* fold the remaining 128 bit blocks */
+  while (len >= 16) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i *) p)), x5);
+    p += 16;
+    len -= 16;
+  }
+
+  /* fold 128 to 64 bits */
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x0 = _mm_loadl_epi64((const __m128i *) k5k0);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, x3);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  /* Barrett reduction to 32 bits */
+  x0 = _mm_load_si128((const __m128i *) poly);
+  x2 = _mm_and_si128(x1, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return (uint32_t) _mm_extract_epi32(x1, 1);
+}
+
+static bool crc32_has_clmul() {
+  static const bool has_clmul = [] {
+    unsigned int eax, ebx, ecx, edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) and (ecx & bit_PCLMUL) and (ecx & bit_SSE4_1);
+  }();
+
+  return has_clmul;
+}
+#endif
+
+/* continue the CRC register crc over len bytes of p */
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, size_t len) {
+#if HASHKIT_CRC32_CLMUL
+  if (len >= 64 and crc32_has_clmul()) {
+    size_t folded = len & ~size_t(15);
+
+    crc = crc32_clmul(crc, p, folded);
+    p += folded;
+    len -= folded;
+  }
+#endif
+
+  return crc32_slice8(crc, p, len);
+}
+
 uint32_t hashkit_crc32(const char *key, size_t key_length, void *context) {
-  uint64_t x;
-  uint32_t crc = UINT32_MAX;
+  uint32_t crc = crc32_update(UINT32_MAX, (const uint8_t *) key, key_length);
   (void) context;
 
-  for (x = 0; x < key_length; x++) crc = (crc >> 8) ^ crc32tab[(crc ^ (uint64_t) key[x]) & 0xff];
-
   return ((~crc) >> 16) & 0x7fff;
 }
+
+void hashkit_crc32_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                         const size_t *key_length, size_t count, uint32_t *hashes) {
+  uint32_t seed = crc32_update(UINT32_MAX, (const uint8_t *) prefix, prefix_length);
+
+  for (size_t x = 0; x < count; ++x) {
+    uint32_t crc = crc32_update(seed, (const uint8_t *) keys[x], key_length[x]);
+
+    hashes[x] = ((~crc) >> 16) & 0x7fff;
+  }
+}
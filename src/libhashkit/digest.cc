@@ -15,10 +15,97 @@
 
 #include "libhashkit/common.h"
 
+#include <cstring>
+
 uint32_t hashkit_digest(const hashkit_st *self, const char *key, size_t key_length) {
   return self->base_hash.function(key, key_length, self->base_hash.context);
 }
 
+/*
+  The algorithms hashing a byte at a time continue from the state after the prefix, MD5
+  hashes several keys in parallel, the others get each key appended to a copy of the prefix.
+*/
+bool hashkit_digest_batch(const hashkit_st *self, const char *prefix, size_t prefix_length,
+                          const char *const *keys, const size_t *key_length,
+                          size_t number_of_keys, uint32_t *hashes) {
+  if (self == NULL or keys == NULL or key_length == NULL or hashes == NULL
+      or (prefix == NULL and prefix_length))
+  {
+    return false;
+  }
+
+  switch (hashkit_get_function(self)) {
+  case HASHKIT_HASH_DEFAULT:
+    hashkit_one_at_a_time_batch(prefix, prefix_length, keys, key_length, number_of_keys, hashes);
+    return true;
+  case HASHKIT_HASH_MD5:
+    hashkit_md5_batch(prefix, prefix_length, keys, key_length, number_of_keys, hashes);
+    return true;
+  case HASHKIT_HASH_CRC:
+    hashkit_crc32_batch(prefix, prefix_length, keys, key_length, number_of_keys, hashes);
+    return true;
+  case HASHKIT_HASH_FNV1_64:
+    hashkit_fnv1_64_batch(prefix, prefix_length, keys, key_length, number_of_keys, hashes);
+    return true;
+  case HASHKIT_HASH_FNV1A_64:
+    hashkit_fnv1a_64_batch(prefix, prefix_length, keys, key_length, number_of_keys, hashes);
+    return true;
+  case HASHKIT_HASH_FNV1_32:
+    hashkit_fnv1_32_batch(prefix, prefix_length, keys, key_length, number_of_keys, hashes);
+    return true;
+  case HASHKIT_HASH_FNV1A_32:
+    hashkit_fnv1a_32_batch(prefix, prefix_length, keys, key_length, number_of_keys, hashes);
+    return true;
+  default:
+    break;
+  }
+
+  if (prefix_length == 0) {
+    for (size_t x = 0; x < number_of_keys; ++x) {
+      hashes[x] = hashkit_digest(self, keys[x], key_length[x]);
+    }
+    return true;
+  }
+
+  char stack_buffer[512];
+  char *buffer = stack_buffer;
+  size_t buffer_size = sizeof(stack_buffer);
+  bool success = true;
+
+  if (prefix_length > buffer_size) {
+    buffer_size = 0;
+  } else {
+    memcpy(buffer, prefix, prefix_length);
+  }
+
+  for (size_t x = 0; x < number_of_keys; ++x) {
+    size_t length = prefix_length + key_length[x];
+
+    if (length > buffer_size) {
+      char *new_buffer = (char *) malloc(length);
+      if (new_buffer == NULL) {
+        success = false;
+        break;
+      }
+      memcpy(new_buffer, prefix, prefix_length);
+      if (buffer != stack_buffer) {
+        free(buffer);
+      }
+      buffer = new_buffer;
+      buffer_size = length;
+    }
+
+    memcpy(buffer + prefix_length, keys[x], key_length[x]);
+    hashes[x] = hashkit_digest(self, buffer, length);
+  }
+
+  if (buffer != stack_buffer) {
+    free(buffer);
+  }
+
+  return success;
+}
+
 uint32_t libhashkit_digest(const char *key, size_t key_length,
                            hashkit_hash_algorithm_t hash_algorithm) {
   switch (hash_algorithm) {
@@ -53,6 +140,10 @@ uint32_t libhashkit_digest(const char *key, size_t key_length,
 #endif
   case HASHKIT_HASH_JENKINS:
     return libhashkit_jenkins(key, key_length);
+  case HASHKIT_HASH_XXH3:
+    return libhashkit_xxh3(key, key_length);
+  case HASHKIT_HASH_WYHASH:
+    return libhashkit_wyhash(key, key_length);
   case HASHKIT_HASH_CUSTOM:
   case HASHKIT_HASH_MAX:
   default:
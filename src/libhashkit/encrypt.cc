@@ -24,6 +24,29 @@ hashkit_string_st *hashkit_decrypt(hashkit_st *kit, const char *source, size_t s
   return aes_decrypt((aes_key_t *)kit->_key, source, source_length);
 }
 
+size_t hashkit_encrypt_length(const hashkit_st *, hashkit_cipher_mode_t mode,
+                              size_t source_length) {
+  return aes_encrypt_length(mode, source_length);
+}
+
+bool hashkit_encrypt_buffer(hashkit_st *kit, hashkit_cipher_mode_t mode, const char *source,
+                            size_t source_length, char *destination, size_t *destination_length) {
+  if (mode >= HASHKIT_CIPHER_MODE_MAX or destination_length == NULL) {
+    return false;
+  }
+  return aes_encrypt_buffer((aes_key_t *) kit->_key, mode, source, source_length, destination,
+                            destination_length);
+}
+
+bool hashkit_decrypt_buffer(hashkit_st *kit, hashkit_cipher_mode_t mode, const char *source,
+                            size_t source_length, char *destination, size_t *destination_length) {
+  if (mode >= HASHKIT_CIPHER_MODE_MAX or destination_length == NULL) {
+    return false;
+  }
+  return aes_decrypt_buffer((aes_key_t *) kit->_key, mode, source, source_length, destination,
+                            destination_length);
+}
+
 bool hashkit_key(hashkit_st *kit, const char *key, const size_t key_length) {
   if (kit->_key) {
     aes_free_key((aes_key_t *) kit->_key);
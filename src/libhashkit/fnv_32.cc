@@ -14,6 +14,7 @@
 */
 
 #include "libhashkit/common.h"
+#include "libhashkit/batch.hpp"
 
 /* FNV hash'es lifted from Dustin Sallings work */
 static uint32_t FNV_32_INIT = 2166136261UL;
@@ -44,3 +45,31 @@ uint32_t hashkit_fnv1a_32(const char *key, size_t key_length, void *context) {
 
   return hash;
 }
+
+static uint32_t fnv_32_final(uint32_t hash) {
+  return hash;
+}
+
+void hashkit_fnv1_32_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                           const size_t *key_length, size_t count, uint32_t *hashes) {
+  hashkit_batch_stream(
+      FNV_32_INIT,
+      [](uint32_t hash, char c) {
+        hash *= FNV_32_PRIME;
+        hash ^= (uint32_t) c;
+        return hash;
+      },
+      fnv_32_final, prefix, prefix_length, keys, key_length, count, hashes);
+}
+
+void hashkit_fnv1a_32_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                            const size_t *key_length, size_t count, uint32_t *hashes) {
+  hashkit_batch_stream(
+      FNV_32_INIT,
+      [](uint32_t hash, char c) {
+        hash ^= (uint32_t) c;
+        hash *= FNV_32_PRIME;
+        return hash;
+      },
+      fnv_32_final, prefix, prefix_length, keys, key_length, count, hashes);
+}
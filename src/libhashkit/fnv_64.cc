@@ -14,6 +14,7 @@
 */
 
 #include "libhashkit/common.h"
+#include "libhashkit/batch.hpp"
 
 #if __WORDSIZE == 64 && defined(HAVE_FNV64_HASH)
 
@@ -45,6 +46,36 @@ uint32_t hashkit_fnv1a_64(const char *key, size_t key_length, void *) {
   return hash;
 }
 
+void hashkit_fnv1_64_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                           const size_t *key_length, size_t count, uint32_t *hashes) {
+  hashkit_batch_stream(
+      FNV_64_INIT,
+      [](uint64_t hash, char c) {
+        hash *= FNV_64_PRIME;
+        hash ^= (uint64_t) c;
+        return hash;
+      },
+      [](uint64_t hash) {
+        return (uint32_t) hash;
+      },
+      prefix, prefix_length, keys, key_length, count, hashes);
+}
+
+void hashkit_fnv1a_64_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                            const size_t *key_length, size_t count, uint32_t *hashes) {
+  hashkit_batch_stream(
+      (uint32_t) FNV_64_INIT,
+      [](uint32_t hash, char c) {
+        hash ^= (uint32_t) c;
+        hash *= (uint32_t) FNV_64_PRIME;
+        return hash;
+      },
+      [](uint32_t hash) {
+        return hash;
+      },
+      prefix, prefix_length, keys, key_length, count, hashes);
+}
+
 #else
 uint32_t hashkit_fnv1_64(const char *, size_t, void *) {
   return 0;
@@ -53,4 +84,14 @@ uint32_t hashkit_fnv1_64(const char *, size_t, void *) {
 uint32_t hashkit_fnv1a_64(const char *, size_t, void *) {
   return 0;
 }
+
+void hashkit_fnv1_64_batch(const char *, size_t, const char *const *, const size_t *,
+                           size_t count, uint32_t *hashes) {
+  std::fill(hashes, hashes + count, 0);
+}
+
+void hashkit_fnv1a_64_batch(const char *, size_t, const char *const *, const size_t *,
+                            size_t count, uint32_t *hashes) {
+  std::fill(hashes, hashes + count, 0);
+}
 #endif
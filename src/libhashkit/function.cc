@@ -76,6 +76,14 @@ static hashkit_return_t _set_function(struct hashkit_st::hashkit_function_st *se
     self->function = hashkit_jenkins;
     break;
 
+  case HASHKIT_HASH_XXH3:
+    self->function = hashkit_xxh3;
+    break;
+
+  case HASHKIT_HASH_WYHASH:
+    self->function = hashkit_wyhash;
+    break;
+
   case HASHKIT_HASH_CUSTOM:
     return HASHKIT_INVALID_ARGUMENT;
 
@@ -159,6 +167,10 @@ static hashkit_hash_algorithm_t get_function_type(const hashkit_hash_fn function
     return HASHKIT_HASH_MURMUR3;
   } else if (function == hashkit_jenkins) {
     return HASHKIT_HASH_JENKINS;
+  } else if (function == hashkit_xxh3) {
+    return HASHKIT_HASH_XXH3;
+  } else if (function == hashkit_wyhash) {
+    return HASHKIT_HASH_WYHASH;
   }
 
   return HASHKIT_HASH_CUSTOM;
@@ -14,6 +14,7 @@
 */
 
 #include "libhashkit/common.h"
+#include "libhashkit/mul128.hpp"
 
 #include <cstring>
 #include <sys/types.h>
@@ -24,6 +25,14 @@
 #  pragma GCC diagnostic ignored "-Wunsafe-loop-optimizations"
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+#  define HASHKIT_MD5_INLINE inline __attribute__((always_inline))
+#  define HASHKIT_MD5_LANES  1
+#else
+#  define HASHKIT_MD5_INLINE inline
+#  define HASHKIT_MD5_LANES  0
+#endif
+
 /* POINTER defines a generic pointer type */
 typedef unsigned char *POINTER;
 typedef const unsigned char *CONST_POINTER;
@@ -205,12 +214,10 @@ static void MD5Final(unsigned char digest[16], /* message digest */
   memset((POINTER) context, 0, sizeof(*context));
 }
 
-/* MD5 basic transformation. Transforms state based on block.
- */
-static void MD5Transform(UINT4 state[4], const unsigned char block[64]) {
-  UINT4 a = state[0], b = state[1], c = state[2], d = state[3], x[16];
-
-  Decode(x, block, 64);
+/* The MD5 rounds, on single words or on vectors of words of independent messages */
+template<typename W>
+static HASHKIT_MD5_INLINE void MD5Rounds(W state[4], const W x[16]) {
+  W a = state[0], b = state[1], c = state[2], d = state[3];
 
   /* Round 1 */
   FF(a, b, c, d, x[0], S11, 0xd76aa478);  /* 1 */
@@ -288,6 +295,15 @@ static void MD5Transform(UINT4 state[4], const unsigned char block[64]) {
   state[1] += b;
   state[2] += c;
   state[3] += d;
+}
+
+/* MD5 basic transformation. Transforms state based on block.
+ */
+static void MD5Transform(UINT4 state[4], const unsigned char block[64]) {
+  UINT4 x[16];
+
+  Decode(x, block, 64);
+  MD5Rounds(state, x);
 
   /* Zeroize sensitive information.
    */
@@ -328,3 +344,193 @@ uint32_t hashkit_md5(const char *key, size_t key_length, void *context) {
   return ((uint32_t)(results[3] & 0xFF) << 24) | ((uint32_t)(results[2] & 0xFF) << 16)
       | ((uint32_t)(results[1] & 0xFF) << 8) | (results[0] & 0xFF);
 }
+
+/* The number of 64 byte blocks of a padded message */
+static inline size_t md5_blocks(size_t length) {
+  return (length + 8) / 64 + 1;
+}
+
+/*
+  Decodes the block-th block of prefix and key, padded as by MD5Final(), into every
+  stride-th word of x.
+*/
+static void md5_block(const unsigned char *prefix, size_t prefix_length, const unsigned char *key,
+                      size_t key_length, size_t block, UINT4 *x, size_t stride) {
+  unsigned char buffer[64];
+  const unsigned char *input = buffer;
+  size_t length = prefix_length + key_length;
+  size_t offset = block * 64;
+
+  if (offset >= prefix_length and offset + 64 <= length) {
+    input = key + (offset - prefix_length);
+  } else {
+    size_t filled = 0;
+
+    if (offset < prefix_length) {
+      filled = prefix_length - offset < 64 ? prefix_length - offset : 64;
+      memcpy(buffer, prefix + offset, filled);
+    }
+    if (filled < 64 and offset + filled < length) {
+      size_t from = offset + filled - prefix_length;
+      size_t n = key_length - from < 64 - filled ? key_length - from : 64 - filled;
+
+      memcpy(buffer + filled, key + from, n);
+      filled += n;
+    }
+    if (filled < 64) {
+      memset(buffer + filled, 0, 64 - filled);
+      if (offset + filled == length) {
+        buffer[filled] = 0x80;
+      }
+      if (block + 1 == md5_blocks(length)) {
+        UINT4 bits[2] = {(UINT4)(length << 3), (UINT4)((uint64_t) length >> 29)};
+
+        Encode(buffer + 56, bits, 8);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < 16; ++i) {
+    x[i * stride] = hashkit_read32le(input + 4 * i);
+  }
+}
+
+#if HASHKIT_MD5_LANES
+typedef UINT4 md5_v4 __attribute__((vector_size(16)));
+typedef UINT4 md5_v8 __attribute__((vector_size(32)));
+
+/*
+  Multi-buffer MD5: the words of up to Lanes messages are interleaved into vectors, and run
+  through the rounds at once, each message for as many blocks as it has.
+*/
+template<typename V, size_t Lanes>
+static HASHKIT_MD5_INLINE void md5_lanes(const unsigned char *prefix, size_t prefix_length,
+                                         const unsigned char *const *keys,
+                                         const size_t *key_length, size_t count,
+                                         unsigned char *results) {
+  V state[4] = {};
+  size_t blocks[Lanes], max_blocks = 0;
+
+  state[0] += 0x67452301;
+  state[1] += 0xefcdab89;
+  state[2] += 0x98badcfe;
+  state[3] += 0x10325476;
+
+  for (size_t lane = 0; lane < count; ++lane) {
+    blocks[lane] = md5_blocks(prefix_length + key_length[lane]);
+    if (blocks[lane] > max_blocks) {
+      max_blocks = blocks[lane];
+    }
+  }
+
+  /* lanes without a block to hash run over stale words, their state is not used anymore */
+  UINT4 words[16][Lanes] = {};
+
+  for (size_t block = 0; block < max_blocks; ++block) {
+    UINT4 digest[4][Lanes];
+    V x[16];
+
+    for (size_t lane = 0; lane < count; ++lane) {
+      if (block < blocks[lane]) {
+        md5_block(prefix, prefix_length, keys[lane], key_length[lane], block, &words[0][lane],
+                  Lanes);
+      }
+    }
+
+    memcpy(x, words, sizeof(x));
+    MD5Rounds(state, x);
+    memcpy(digest, state, sizeof(digest));
+
+    for (size_t lane = 0; lane < count; ++lane) {
+      if (block + 1 == blocks[lane]) {
+        UINT4 final[4] = {digest[0][lane], digest[1][lane], digest[2][lane], digest[3][lane]};
+
+        Encode(results + 16 * lane, final, 16);
+      }
+    }
+  }
+}
+
+static void md5_lanes4(const unsigned char *prefix, size_t prefix_length,
+                       const unsigned char *const *keys, const size_t *key_length, size_t count,
+                       unsigned char *results) {
+  md5_lanes<md5_v4, 4>(prefix, prefix_length, keys, key_length, count, results);
+}
+
+#  if defined(__x86_64__) || defined(__i386__)
+#    define HASHKIT_MD5_AVX2 1
+
+__attribute__((target("avx2"))) static void md5_lanes8(const unsigned char *prefix,
+                                                       size_t prefix_length,
+                                                       const unsigned char *const *keys,
+                                                       const size_t *key_length, size_t count,
+                                                       unsigned char *results) {
+  md5_lanes<md5_v8, 8>(prefix, prefix_length, keys, key_length, count, results);
+}
+
+static bool md5_has_avx2() {
+  static const bool has_avx2 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+
+  return has_avx2;
+}
+#  endif
+#endif
+
+/*
+  The signatures of prefix followed by each of the keys, 16 bytes per key. Keys are hashed
+  in parallel, with AVX2 if the CPU has it.
+*/
+void md5_signature_batch(const unsigned char *prefix, size_t prefix_length,
+                         const unsigned char *const *keys, const size_t *key_length, size_t count,
+                         unsigned char *results) {
+  size_t x = 0;
+
+#if HASHKIT_MD5_LANES
+#  if HASHKIT_MD5_AVX2
+  if (md5_has_avx2()) {
+    for (; x + 1 < count; x += 8) {
+      size_t lanes = count - x < 8 ? count - x : 8;
+
+      md5_lanes8(prefix, prefix_length, keys + x, key_length + x, lanes, results + 16 * x);
+    }
+  }
+#  endif
+  for (; x + 1 < count; x += 4) {
+    size_t lanes = count - x < 4 ? count - x : 4;
+
+    md5_lanes4(prefix, prefix_length, keys + x, key_length + x, lanes, results + 16 * x);
+  }
+#endif
+
+  for (; x < count; ++x) {
+    MD5_CTX my_md5;
+
+    MD5Init(&my_md5);
+    if (prefix_length) {
+      MD5Update(&my_md5, prefix, (unsigned int) prefix_length);
+    }
+    MD5Update(&my_md5, keys[x], (unsigned int) key_length[x]);
+    MD5Final(results + 16 * x, &my_md5);
+  }
+}
+
+void hashkit_md5_batch(const char *prefix, size_t prefix_length, const char *const *keys,
+                       const size_t *key_length, size_t count, uint32_t *hashes) {
+  unsigned char results[16 * 64];
+
+  for (size_t x = 0; x < count; x += 64) {
+    size_t n = count - x < 64 ? count - x : 64;
+
+    md5_signature_batch((const unsigned char *) prefix, prefix_length,
+                        (const unsigned char *const *) keys + x, key_length + x, n, results);
+    for (size_t i = 0; i < n; ++i) {
+      const unsigned char *r = results + 16 * i;
+
+      hashes[x + i] = ((uint32_t)(r[3] & 0xFF) << 24) | ((uint32_t)(r[2] & 0xFF) << 16)
+          | ((uint32_t)(r[1] & 0xFF) << 8) | (r[0] & 0xFF);
+    }
+  }
+}
@@ -0,0 +1,55 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/*
+  Helpers of the 64 bit multiply-mix hashes, xxh3.cc and wyhash.cc.
+*/
+
+static inline uint64_t hashkit_read64le(const uint8_t *p) {
+  return (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16)
+      | ((uint64_t) p[3] << 24) | ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40)
+      | ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+}
+
+static inline uint32_t hashkit_read32le(const uint8_t *p) {
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16)
+      | ((uint32_t) p[3] << 24);
+}
+
+/* the full 128 bit product of a and b, low half in *lo, high half in *hi */
+static inline void hashkit_mul128(uint64_t a, uint64_t b, uint64_t *lo, uint64_t *hi) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = (__uint128_t) a * b;
+  *lo = (uint64_t) r;
+  *hi = (uint64_t) (r >> 64);
+#else
+  uint64_t lo_lo = (a & 0xFFFFFFFFU) * (b & 0xFFFFFFFFU);
+  uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFFU);
+  uint64_t lo_hi = (a & 0xFFFFFFFFU) * (b >> 32);
+  uint64_t hi_hi = (a >> 32) * (b >> 32);
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFU) + lo_hi;
+
+  *hi = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  *lo = (cross << 32) | (lo_lo & 0xFFFFFFFFU);
+#endif
+}
+
+static inline uint64_t hashkit_mul128_fold64(uint64_t a, uint64_t b) {
+  uint64_t lo, hi;
+  hashkit_mul128(a, b, &lo, &hi);
+  return lo ^ hi;
+}
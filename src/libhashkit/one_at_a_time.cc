@@ -14,6 +14,7 @@
 */
 
 #include "libhashkit/common.h"
+#include "libhashkit/batch.hpp"
 
 uint32_t hashkit_one_at_a_time(const char *key, size_t key_length, void *context) {
   const char *ptr = key;
@@ -32,3 +33,23 @@ uint32_t hashkit_one_at_a_time(const char *key, size_t key_length, void *context
 
   return value;
 }
+
+void hashkit_one_at_a_time_batch(const char *prefix, size_t prefix_length,
+                                 const char *const *keys, const size_t *key_length,
+                                 size_t count, uint32_t *hashes) {
+  hashkit_batch_stream(
+      uint32_t(0),
+      [](uint32_t value, char c) {
+        value += (uint32_t) c;
+        value += (value << 10);
+        value ^= (value >> 6);
+        return value;
+      },
+      [](uint32_t value) {
+        value += (value << 3);
+        value ^= (value >> 11);
+        value += (value << 15);
+        return value;
+      },
+      prefix, prefix_length, keys, key_length, count, hashes);
+}
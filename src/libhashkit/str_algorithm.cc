@@ -39,6 +39,10 @@ const char *libhashkit_string_hash(hashkit_hash_algorithm_t type) {
     return "MURMUR3";
   case HASHKIT_HASH_JENKINS:
     return "JENKINS";
+  case HASHKIT_HASH_XXH3:
+    return "XXH3";
+  case HASHKIT_HASH_WYHASH:
+    return "WYHASH";
   case HASHKIT_HASH_CUSTOM:
     return "CUSTOM";
   default:
@@ -0,0 +1,87 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+/*
+  wyhash final version 4 by Wang Yi, https://github.com/wangyi-fudan/wyhash (The Unlicense),
+  with the default secret, and the hash truncated to its lower 32 bits.
+*/
+
+#include "libhashkit/common.h"
+#include "libhashkit/mul128.hpp"
+
+static const uint64_t wyp[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+                                0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+
+static inline uint64_t wymix(uint64_t a, uint64_t b) {
+  return hashkit_mul128_fold64(a, b);
+}
+
+static inline uint64_t wyr3(const uint8_t *p, size_t k) {
+  return ((uint64_t) p[0] << 16) | ((uint64_t) p[k >> 1] << 8) | p[k - 1];
+}
+
+static uint64_t wyhash64(const char *key, size_t key_length, uint64_t seed) {
+  const uint8_t *p = (const uint8_t *) key;
+  size_t len = key_length;
+  uint64_t a, b;
+
+  seed ^= wymix(seed ^ wyp[0], wyp[1]);
+
+  if (len <= 16) {
+    if (len >= 4) {
+      a = ((uint64_t) hashkit_read32le(p) << 32) | hashkit_read32le(p + ((len >> 3) << 2));
+      b = ((uint64_t) hashkit_read32le(p + len - 4) << 32)
+          | hashkit_read32le(p + len - 4 - ((len >> 3) << 2));
+    } else if (len > 0) {
+      a = wyr3(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+
+    if (i >= 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = wymix(hashkit_read64le(p) ^ wyp[1], hashkit_read64le(p + 8) ^ seed);
+        see1 = wymix(hashkit_read64le(p + 16) ^ wyp[2], hashkit_read64le(p + 24) ^ see1);
+        see2 = wymix(hashkit_read64le(p + 32) ^ wyp[3], hashkit_read64le(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i >= 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = wymix(hashkit_read64le(p) ^ wyp[1], hashkit_read64le(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = hashkit_read64le(p + i - 16);
+    b = hashkit_read64le(p + i - 8);
+  }
+
+  a ^= wyp[1];
+  b ^= seed;
+  hashkit_mul128(a, b, &a, &b);
+
+  return wymix(a ^ wyp[0] ^ len, b ^ wyp[1]);
+}
+
+uint32_t hashkit_wyhash(const char *key, size_t key_length, void *context) {
+  (void) context;
+
+  return (uint32_t) wyhash64(key, key_length, 0);
+}
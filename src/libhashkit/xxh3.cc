@@ -0,0 +1,233 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+/*
+  XXH3, the 64 bit variant with the default secret and seed 0, from xxHash by Yann Collet,
+  https://github.com/Cyan4973/xxHash (BSD 2-Clause), in a portable scalar form.
+  The hash is truncated to its lower 32 bits.
+*/
+
+#include "libhashkit/common.h"
+#include "libhashkit/mul128.hpp"
+
+#define XXH_STRIPE_LEN          64
+#define XXH_SECRET_CONSUME_RATE 8
+#define XXH_ACC_NB              8
+#define XXH_SECRET_SIZE         192
+#define XXH_SECRET_SIZE_MIN     136
+#define XXH_MIDSIZE_MAX         240
+
+static const uint32_t PRIME32_1 = 0x9E3779B1U;
+static const uint32_t PRIME32_2 = 0x85EBCA77U;
+static const uint32_t PRIME32_3 = 0xC2B2AE3DU;
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+static const uint64_t PRIME_MX1 = 0x165667919E3779F9ULL;
+static const uint64_t PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+static const uint8_t kSecret[XXH_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+static inline uint64_t xxh_rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh_swap64(uint64_t x) {
+  return ((x << 56) & 0xff00000000000000ULL) | ((x << 40) & 0x00ff000000000000ULL)
+      | ((x << 24) & 0x0000ff0000000000ULL) | ((x << 8) & 0x000000ff00000000ULL)
+      | ((x >> 8) & 0x00000000ff000000ULL) | ((x >> 24) & 0x0000000000ff0000ULL)
+      | ((x >> 40) & 0x000000000000ff00ULL) | ((x >> 56) & 0x00000000000000ffULL);
+}
+
+static inline uint64_t xxh64_avalanche(uint64_t h) {
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+static inline uint64_t xxh3_avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= PRIME_MX1;
+  h ^= h >> 32;
+  return h;
+}
+
+static inline uint64_t xxh3_rrmxmx(uint64_t h, uint64_t len) {
+  h ^= xxh_rotl64(h, 49) ^ xxh_rotl64(h, 24);
+  h *= PRIME_MX2;
+  h ^= (h >> 35) + len;
+  h *= PRIME_MX2;
+  h ^= h >> 28;
+  return h;
+}
+
+static inline uint64_t xxh3_mix16(const uint8_t *input, const uint8_t *secret) {
+  return hashkit_mul128_fold64(hashkit_read64le(input) ^ hashkit_read64le(secret),
+                               hashkit_read64le(input + 8) ^ hashkit_read64le(secret + 8));
+}
+
+static uint64_t xxh3_len_0to16(const uint8_t *input, size_t len) {
+  if (len > 8) {
+    uint64_t bitflip1 = hashkit_read64le(kSecret + 24) ^ hashkit_read64le(kSecret + 32);
+    uint64_t bitflip2 = hashkit_read64le(kSecret + 40) ^ hashkit_read64le(kSecret + 48);
+    uint64_t lo = hashkit_read64le(input) ^ bitflip1;
+    uint64_t hi = hashkit_read64le(input + len - 8) ^ bitflip2;
+
+    return xxh3_avalanche(len + xxh_swap64(lo) + hi + hashkit_mul128_fold64(lo, hi));
+  }
+  if (len >= 4) {
+    uint64_t bitflip = hashkit_read64le(kSecret + 8) ^ hashkit_read64le(kSecret + 16);
+    uint64_t value =
+        hashkit_read32le(input + len - 4) + ((uint64_t) hashkit_read32le(input) << 32);
+
+    return xxh3_rrmxmx(value ^ bitflip, len);
+  }
+  if (len) {
+    uint32_t combined = ((uint32_t) input[0] << 16) | ((uint32_t) input[len >> 1] << 24)
+        | ((uint32_t) input[len - 1]) | ((uint32_t) len << 8);
+    uint64_t bitflip = hashkit_read32le(kSecret) ^ hashkit_read32le(kSecret + 4);
+
+    return xxh64_avalanche((uint64_t) combined ^ bitflip);
+  }
+
+  return xxh64_avalanche(hashkit_read64le(kSecret + 56) ^ hashkit_read64le(kSecret + 64));
+}
+
+static uint64_t xxh3_len_17to128(const uint8_t *input, size_t len) {
+  uint64_t acc = len * PRIME64_1;
+
+  if (len > 32) {
+    if (len > 64) {
+      if (len > 96) {
+        acc += xxh3_mix16(input + 48, kSecret + 96);
+        acc += xxh3_mix16(input + len - 64, kSecret + 112);
+      }
+      acc += xxh3_mix16(input + 32, kSecret + 64);
+      acc += xxh3_mix16(input + len - 48, kSecret + 80);
+    }
+    acc += xxh3_mix16(input + 16, kSecret + 32);
+    acc += xxh3_mix16(input + len - 32, kSecret + 48);
+  }
+  acc += xxh3_mix16(input, kSecret);
+  acc += xxh3_mix16(input + len - 16, kSecret + 16);
+
+  return xxh3_avalanche(acc);
+}
+
+static uint64_t xxh3_len_129to240(const uint8_t *input, size_t len) {
+  uint64_t acc = len * PRIME64_1;
+  size_t rounds = len / 16;
+
+  for (size_t i = 0; i < 8; ++i) {
+    acc += xxh3_mix16(input + 16 * i, kSecret + 16 * i);
+  }
+  acc = xxh3_avalanche(acc);
+
+  for (size_t i = 8; i < rounds; ++i) {
+    acc += xxh3_mix16(input + 16 * i, kSecret + 16 * (i - 8) + 3);
+  }
+  acc += xxh3_mix16(input + len - 16, kSecret + XXH_SECRET_SIZE_MIN - 17);
+
+  return xxh3_avalanche(acc);
+}
+
+static inline void xxh3_accumulate_512(uint64_t *acc, const uint8_t *input, const uint8_t *secret) {
+  for (size_t i = 0; i < XXH_ACC_NB; ++i) {
+    uint64_t data = hashkit_read64le(input + 8 * i);
+    uint64_t key = data ^ hashkit_read64le(secret + 8 * i);
+
+    acc[i ^ 1] += data;
+    acc[i] += (key & 0xFFFFFFFFU) * (key >> 32);
+  }
+}
+
+static inline void xxh3_scramble(uint64_t *acc, const uint8_t *secret) {
+  for (size_t i = 0; i < XXH_ACC_NB; ++i) {
+    uint64_t a = acc[i];
+
+    a ^= a >> 47;
+    a ^= hashkit_read64le(secret + 8 * i);
+    a *= PRIME32_1;
+    acc[i] = a;
+  }
+}
+
+static uint64_t xxh3_long(const uint8_t *input, size_t len) {
+  uint64_t acc[XXH_ACC_NB] = {PRIME32_3, PRIME64_1, PRIME64_2, PRIME64_3,
+                              PRIME64_4, PRIME32_2, PRIME64_5, PRIME32_1};
+  size_t stripes_per_block = (XXH_SECRET_SIZE - XXH_STRIPE_LEN) / XXH_SECRET_CONSUME_RATE;
+  size_t block_len = XXH_STRIPE_LEN * stripes_per_block;
+  size_t blocks = (len - 1) / block_len;
+
+  for (size_t n = 0; n < blocks; ++n) {
+    for (size_t s = 0; s < stripes_per_block; ++s) {
+      xxh3_accumulate_512(acc, input + n * block_len + s * XXH_STRIPE_LEN,
+                          kSecret + s * XXH_SECRET_CONSUME_RATE);
+    }
+    xxh3_scramble(acc, kSecret + XXH_SECRET_SIZE - XXH_STRIPE_LEN);
+  }
+
+  size_t stripes = ((len - 1) - block_len * blocks) / XXH_STRIPE_LEN;
+  for (size_t s = 0; s < stripes; ++s) {
+    xxh3_accumulate_512(acc, input + blocks * block_len + s * XXH_STRIPE_LEN,
+                        kSecret + s * XXH_SECRET_CONSUME_RATE);
+  }
+  xxh3_accumulate_512(acc, input + len - XXH_STRIPE_LEN,
+                      kSecret + XXH_SECRET_SIZE - XXH_STRIPE_LEN - 7);
+
+  uint64_t result = len * PRIME64_1;
+  for (size_t i = 0; i < 4; ++i) {
+    result += hashkit_mul128_fold64(acc[2 * i] ^ hashkit_read64le(kSecret + 11 + 16 * i),
+                                    acc[2 * i + 1] ^ hashkit_read64le(kSecret + 11 + 16 * i + 8));
+  }
+
+  return xxh3_avalanche(result);
+}
+
+uint32_t hashkit_xxh3(const char *key, size_t key_length, void *context) {
+  const uint8_t *input = (const uint8_t *) key;
+  uint64_t hash;
+  (void) context;
+
+  if (key_length <= 16) {
+    hash = xxh3_len_0to16(input, key_length);
+  } else if (key_length <= 128) {
+    hash = xxh3_len_17to128(input, key_length);
+  } else if (key_length <= XXH_MIDSIZE_MAX) {
+    hash = xxh3_len_129to240(input, key_length);
+  } else {
+    hash = xxh3_long(input, key_length);
+  }
+
+  return (uint32_t) hash;
+}
@@ -0,0 +1,634 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#include "libmemcached/common.h"
+#include "p9y/clock_gettime.hpp"
+#include "p9y/poll.hpp"
+
+struct memcached_async_request_st {
+  uint32_t opaque;
+  uint8_t opcode;
+  memcached_async_fn callback;
+  void *context;
+};
+
+struct memcached_async_queue_st {
+  /* ring of requests awaiting their response */
+  memcached_async_request_st *requests;
+  uint32_t head;
+  uint32_t count;
+  uint32_t size;
+  uint32_t next_opaque;
+  /* bumped whenever the buffers are dropped, e.g. by a callback closing the connection */
+  uint32_t resets;
+  bool is_disconnected;
+  /* when the oldest pending request was submitted or the last response arrived, in ms */
+  int64_t progress;
+  char *out;
+  size_t out_offset;
+  size_t out_length;
+  size_t out_size;
+  char *in;
+  size_t in_length;
+  size_t in_size;
+};
+
+static int64_t async_now() {
+  timespec tspec{};
+  if (clock_gettime(CLOCK_MONOTONIC, &tspec)) {
+    return 0;
+  }
+  return int64_t(tspec.tv_sec) * 1000 + tspec.tv_nsec / 1000000;
+}
+
+static bool async_reserve(const memcached_st *memc, char *&buffer, size_t &size, size_t needed) {
+  if (needed > size) {
+    size_t new_size = size ? size : MEMCACHED_MAX_BUFFER;
+    while (new_size < needed) {
+      new_size *= 2;
+    }
+
+    char *new_buffer = libmemcached_xrealloc(memc, buffer, new_size, char);
+    if (new_buffer == NULL) {
+      return false;
+    }
+    buffer = new_buffer;
+    size = new_size;
+  }
+
+  return true;
+}
+
+static bool async_push(const memcached_st *memc, memcached_async_queue_st *queue,
+                       const memcached_async_request_st &request) {
+  if (queue->count == queue->size) {
+    uint32_t new_size = queue->size ? queue->size * 2 : 64;
+    memcached_async_request_st *requests =
+        libmemcached_xcalloc(memc, new_size, memcached_async_request_st);
+    if (requests == NULL) {
+      return false;
+    }
+
+    for (uint32_t x = 0; x < queue->count; ++x) {
+      requests[x] = queue->requests[(queue->head + x) % queue->size];
+    }
+    libmemcached_free(memc, queue->requests);
+    queue->requests = requests;
+    queue->head = 0;
+    queue->size = new_size;
+  }
+
+  if (queue->count == 0) {
+    queue->progress = async_now();
+  }
+  queue->requests[(queue->head + queue->count) % queue->size] = request;
+  queue->count++;
+
+  return true;
+}
+
+static void async_fail(Memcached *memc, memcached_async_queue_st *queue, memcached_return_t rc) {
+  /* Detach everything first, callbacks may well submit new requests */
+  memcached_async_request_st *requests = queue->requests;
+  uint32_t head = queue->head, count = queue->count, size = queue->size;
+
+  queue->requests = NULL;
+  queue->head = queue->count = queue->size = 0;
+  queue->out_offset = queue->out_length = 0;
+  queue->in_length = 0;
+  queue->resets++;
+  queue->is_disconnected = false;
+
+  for (uint32_t x = 0; x < count; ++x) {
+    memcached_async_request_st &request = requests[(head + x) % size];
+    if (request.callback) {
+      request.callback(memc, rc, NULL, request.context);
+    }
+  }
+
+  libmemcached_free(memc, requests);
+}
+
+void memcached_async_reset(memcached_instance_st *instance) {
+  memcached_async_queue_st *queue = instance->async;
+
+  if (queue) {
+    queue->out_offset = queue->out_length = 0;
+    queue->in_length = 0;
+    queue->resets++;
+    queue->is_disconnected = queue->count > 0;
+  }
+}
+
+void memcached_async_free(memcached_instance_st *instance) {
+  memcached_async_queue_st *queue = instance->async;
+
+  if (queue) {
+    async_fail(instance->root, queue, MEMCACHED_CONNECTION_FAILURE);
+    libmemcached_free(instance->root, queue->out);
+    libmemcached_free(instance->root, queue->in);
+    libmemcached_free(instance->root, queue);
+    instance->async = NULL;
+  }
+}
+
+static memcached_return_t async_submit(memcached_st *shell, uint8_t opcode, const char *key,
+                                       size_t key_length, const void *extras,
+                                       uint8_t extras_length, const char *value,
+                                       size_t value_length, memcached_async_fn callback,
+                                       void *context, uint64_t *request) {
+  Memcached *ptr = memcached2Memcached(shell);
+  memcached_return_t rc;
+  if (memcached_failed(rc = initialize_query(ptr, true))) {
+    return rc;
+  }
+
+  if (memcached_is_udp(ptr) or memcached_is_binary(ptr) == false) {
+    return memcached_set_error(
+        *ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
+        memcached_literal_param("Asynchronous requests need the binary protocol over TCP"));
+  }
+
+  if (memcached_is_encrypted(ptr)) {
+    return memcached_set_error(
+        *ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
+        memcached_literal_param("Operation not allowed while encyrption is enabled"));
+  }
+
+  if (memcached_failed(memcached_key_test(*ptr, &key, &key_length, 1))) {
+    return memcached_last_error(ptr);
+  }
+
+  uint32_t server_key = memcached_generate_hash_with_redistribution(ptr, key, key_length);
+  memcached_instance_st *instance = memcached_instance_fetch(ptr, server_key);
+
+  if (instance->async == NULL) {
+    if ((instance->async = libmemcached_xcalloc(ptr, 1, memcached_async_queue_st)) == NULL) {
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+  }
+  memcached_async_queue_st *queue = instance->async;
+
+  if (queue->is_disconnected) {
+    async_fail(ptr, queue, MEMCACHED_CONNECTION_FAILURE);
+  }
+
+  if (memcached_failed(rc = memcached_connect(instance))) {
+    return rc;
+  }
+
+  size_t prefix_length = memcached_array_size(ptr->_namespace);
+  protocol_binary_request_header header = {};
+  header.request.magic = PROTOCOL_BINARY_REQ;
+  header.request.opcode = opcode;
+  header.request.keylen = htons(uint16_t(prefix_length + key_length));
+  header.request.extlen = extras_length;
+  header.request.datatype = PROTOCOL_BINARY_RAW_BYTES;
+  header.request.bodylen =
+      htonl(uint32_t(extras_length + prefix_length + key_length + value_length));
+  header.request.opaque = htonl(++queue->next_opaque);
+
+  size_t request_length =
+      sizeof(header.bytes) + extras_length + prefix_length + key_length + value_length;
+  if (async_reserve(ptr, queue->out, queue->out_size, queue->out_length + request_length) == false)
+  {
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  memcached_async_request_st pending = {queue->next_opaque, opcode, callback, context};
+  if (async_push(ptr, queue, pending) == false) {
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  char *out = queue->out + queue->out_length;
+  memcpy(out, header.bytes, sizeof(header.bytes));
+  out += sizeof(header.bytes);
+  if (extras_length) {
+    memcpy(out, extras, extras_length);
+    out += extras_length;
+  }
+  if (prefix_length) {
+    memcpy(out, memcached_array_string(ptr->_namespace), prefix_length);
+    out += prefix_length;
+  }
+  memcpy(out, key, key_length);
+  out += key_length;
+  if (value_length) {
+    memcpy(out, value, value_length);
+  }
+  queue->out_length += request_length;
+
+  if (request) {
+    *request = (uint64_t(server_key) << 32) | queue->next_opaque;
+  }
+
+  return MEMCACHED_SUCCESS;
+}
+
+memcached_return_t memcached_async_get(memcached_st *ptr, const char *key, size_t key_length,
+                                       memcached_async_fn callback, void *context,
+                                       uint64_t *request) {
+  return async_submit(ptr, PROTOCOL_BINARY_CMD_GETK, key, key_length, NULL, 0, NULL, 0, callback,
+                      context, request);
+}
+
+memcached_return_t memcached_async_set(memcached_st *ptr, const char *key, size_t key_length,
+                                       const char *value, size_t value_length, time_t expiration,
+                                       uint32_t flags, memcached_async_fn callback, void *context,
+                                       uint64_t *request) {
+  uint32_t extras[2] = {htonl(flags), htonl(uint32_t(expiration))};
+
+  return async_submit(ptr, PROTOCOL_BINARY_CMD_SET, key, key_length, extras, sizeof(extras), value,
+                      value_length, callback, context, request);
+}
+
+memcached_return_t memcached_async_delete(memcached_st *ptr, const char *key, size_t key_length,
+                                          memcached_async_fn callback, void *context,
+                                          uint64_t *request) {
+  return async_submit(ptr, PROTOCOL_BINARY_CMD_DELETE, key, key_length, NULL, 0, NULL, 0,
+                      callback, context, request);
+}
+
+memcached_return_t memcached_async_cancel(memcached_st *shell, uint64_t request) {
+  Memcached *ptr = memcached2Memcached(shell);
+  if (ptr == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  uint32_t server_key = uint32_t(request >> 32);
+  if (server_key < memcached_server_count(ptr)) {
+    memcached_async_queue_st *queue = memcached_instance_fetch(ptr, server_key)->async;
+
+    for (uint32_t x = 0; queue and x < queue->count; ++x) {
+      memcached_async_request_st &pending = queue->requests[(queue->head + x) % queue->size];
+      if (pending.opaque == uint32_t(request) and pending.callback) {
+        /* The response still has to be read, it is just not reported */
+        pending.callback = NULL;
+        return MEMCACHED_SUCCESS;
+      }
+    }
+  }
+
+  return MEMCACHED_NOTFOUND;
+}
+
+uint32_t memcached_async_pending(const memcached_st *shell) {
+  const Memcached *ptr = memcached2Memcached(shell);
+  uint32_t count = 0;
+
+  if (ptr) {
+    for (uint32_t x = 0; x < memcached_server_count(ptr); ++x) {
+      memcached_async_queue_st *queue = memcached_instance_by_position(ptr, x)->async;
+      if (queue) {
+        count += queue->count;
+      }
+    }
+  }
+
+  return count;
+}
+
+uint32_t memcached_async_fds(memcached_st *shell, memcached_async_fd_st *fds,
+                             uint32_t number_of_fds) {
+  Memcached *ptr = memcached2Memcached(shell);
+  uint32_t count = 0;
+
+  if (ptr) {
+    for (uint32_t x = 0; x < memcached_server_count(ptr); ++x) {
+      memcached_instance_st *instance = memcached_instance_fetch(ptr, x);
+      memcached_async_queue_st *queue = instance->async;
+
+      if (queue == NULL) {
+        continue;
+      }
+      if (queue->is_disconnected) {
+        async_fail(ptr, queue, MEMCACHED_CONNECTION_FAILURE);
+      }
+      if (queue->count and ptr->poll_timeout >= 0
+          and async_now() - queue->progress > ptr->poll_timeout)
+      {
+        /* the server accepts requests but does not answer them anymore */
+        memcached_set_error(*instance, MEMCACHED_TIMEOUT, MEMCACHED_AT,
+                            memcached_literal_param("Asynchronous requests timed out"));
+        memcached_quit_server(instance, true);
+        async_fail(ptr, queue, MEMCACHED_TIMEOUT);
+      }
+      if (queue->count == 0 or instance->fd == INVALID_SOCKET) {
+        continue;
+      }
+
+      if (fds and count < number_of_fds) {
+        fds[count].fd = instance->fd;
+        fds[count].events = POLLIN;
+        if (queue->out_offset < queue->out_length) {
+          fds[count].events |= POLLOUT;
+        }
+      }
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+static memcached_return_t async_send(memcached_instance_st *instance,
+                                     memcached_async_queue_st *queue) {
+  while (queue->out_offset < queue->out_length) {
+    ssize_t sent = ::send(instance->fd, queue->out + queue->out_offset,
+                          queue->out_length - queue->out_offset, MSG_NOSIGNAL);
+
+    if (sent == SOCKET_ERROR) {
+      switch (get_socket_errno()) {
+      case EINTR:
+        continue;
+
+#if EWOULDBLOCK != EAGAIN
+      case EWOULDBLOCK:
+#endif
+      case EAGAIN:
+        return MEMCACHED_SUCCESS;
+
+      default:
+        return memcached_set_errno(*instance, get_socket_errno(), MEMCACHED_AT);
+      }
+    }
+
+    queue->out_offset += size_t(sent);
+  }
+
+  queue->out_offset = queue->out_length = 0;
+
+  return MEMCACHED_SUCCESS;
+}
+
+static memcached_return_t async_status(uint16_t status) {
+  switch (status) {
+  case PROTOCOL_BINARY_RESPONSE_SUCCESS:
+    return MEMCACHED_SUCCESS;
+  case PROTOCOL_BINARY_RESPONSE_KEY_ENOENT:
+    return MEMCACHED_NOTFOUND;
+  case PROTOCOL_BINARY_RESPONSE_KEY_EEXISTS:
+    return MEMCACHED_DATA_EXISTS;
+  case PROTOCOL_BINARY_RESPONSE_NOT_STORED:
+    return MEMCACHED_NOTSTORED;
+  case PROTOCOL_BINARY_RESPONSE_E2BIG:
+    return MEMCACHED_E2BIG;
+  case PROTOCOL_BINARY_RESPONSE_ENOMEM:
+    return MEMCACHED_SERVER_MEMORY_ALLOCATION_FAILURE;
+  case PROTOCOL_BINARY_RESPONSE_AUTH_ERROR:
+    return MEMCACHED_AUTH_FAILURE;
+  default:
+    return MEMCACHED_SERVER_ERROR;
+  }
+}
+
+/* Decompress a value stored compressed, e.g. by memcached_set(), into result and point item at it */
+static memcached_return_t async_decompress(memcached_instance_st *instance,
+                                           memcached_item_view_st &item,
+                                           memcached_result_st &result) {
+  if (memcached_failed(memcached_string_append(&result.value, item.value, item.value_length))) {
+    return memcached_set_error(*instance, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+  result.item_flags = item.flags;
+
+  memcached_return_t rc = memcached_decompress(instance, &result);
+  if (memcached_success(rc)) {
+    item.value = memcached_result_value(&result);
+    item.value_length = memcached_result_length(&result);
+    item.flags = memcached_result_flags(&result);
+  }
+
+  return rc;
+}
+
+static memcached_return_t async_dispatch(Memcached *memc, memcached_instance_st *instance,
+                                         memcached_async_queue_st *queue) {
+  size_t offset = 0;
+  size_t prefix_length = memcached_array_size(memc->_namespace);
+  const uint32_t resets = queue->resets;
+
+  while (queue->in_length - offset >= sizeof(protocol_binary_response_header)) {
+    protocol_binary_response_header header;
+    memcpy(header.bytes, queue->in + offset, sizeof(header.bytes));
+
+    size_t response_length = sizeof(header.bytes) + ntohl(header.response.bodylen);
+    if (queue->in_length - offset < response_length) {
+      if (async_reserve(memc, queue->in, queue->in_size, response_length) == false) {
+        return memcached_set_error(*instance, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+      }
+      break;
+    }
+
+    if (header.response.magic != PROTOCOL_BINARY_RES or queue->count == 0
+        or queue->requests[queue->head].opaque != ntohl(header.response.opaque))
+    {
+      return memcached_set_error(*instance, MEMCACHED_UNKNOWN_READ_FAILURE, MEMCACHED_AT,
+                                 memcached_literal_param("Unexpected asynchronous response"));
+    }
+
+    memcached_async_request_st request = queue->requests[queue->head];
+    queue->head = (queue->head + 1) % queue->size;
+    queue->count--;
+
+    const char *body = queue->in + offset + sizeof(header.bytes);
+    offset += response_length;
+
+    if (request.callback == NULL) {
+      continue;
+    }
+
+    memcached_return_t rc = async_status(ntohs(header.response.status));
+    if (memcached_success(rc) and request.opcode == PROTOCOL_BINARY_CMD_GETK) {
+      uint16_t keylen = ntohs(header.response.keylen);
+      uint8_t extlen = header.response.extlen;
+      uint32_t flags = 0;
+
+      if (extlen < sizeof(flags) or keylen < prefix_length
+          or response_length < sizeof(header.bytes) + extlen + keylen)
+      {
+        return memcached_set_error(*instance, MEMCACHED_UNKNOWN_READ_FAILURE, MEMCACHED_AT);
+      }
+      memcpy(&flags, body, sizeof(flags));
+
+      memcached_item_view_st item;
+      item.key = body + extlen + prefix_length;
+      item.key_length = keylen - prefix_length;
+      item.value = body + extlen + keylen;
+      item.value_length = response_length - sizeof(header.bytes) - extlen - keylen;
+      item.flags = ntohl(flags);
+      item.cas = memcached_ntohll(header.response.cas);
+
+      if (memcached_is_compressed(memc, item.flags)) {
+        memcached_result_st decompressed;
+        memcached_result_create(memc, &decompressed);
+        rc = async_decompress(instance, item, decompressed);
+        request.callback(memc, rc, memcached_success(rc) ? &item : NULL, request.context);
+        memcached_result_free(&decompressed);
+      } else {
+        request.callback(memc, rc, &item, request.context);
+      }
+    } else {
+      request.callback(memc, rc, NULL, request.context);
+    }
+
+    /* the callback closed the connection, the rest of the input went with it */
+    if (queue->resets != resets) {
+      return MEMCACHED_SUCCESS;
+    }
+  }
+
+  if (offset) {
+    queue->progress = async_now();
+    memmove(queue->in, queue->in + offset, queue->in_length - offset);
+    queue->in_length -= offset;
+  }
+
+  return MEMCACHED_SUCCESS;
+}
+
+static memcached_return_t async_recv(Memcached *memc, memcached_instance_st *instance,
+                                     memcached_async_queue_st *queue) {
+  while (true) {
+    if (async_reserve(memc, queue->in, queue->in_size, queue->in_length + MEMCACHED_MAX_BUFFER)
+        == false)
+    {
+      return memcached_set_error(*instance, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+
+    size_t space = queue->in_size - queue->in_length;
+    ssize_t data_read = ::recv(instance->fd, queue->in + queue->in_length, space, MSG_NOSIGNAL);
+
+    if (data_read == SOCKET_ERROR) {
+      switch (get_socket_errno()) {
+      case EINTR:
+        continue;
+
+#if EWOULDBLOCK != EAGAIN
+      case EWOULDBLOCK:
+#endif
+      case EAGAIN:
+        return async_dispatch(memc, instance, queue);
+
+      default:
+        return memcached_set_errno(*instance, get_socket_errno(), MEMCACHED_AT);
+      }
+    } else if (data_read == 0) {
+      return memcached_set_error(
+          *instance, MEMCACHED_CONNECTION_FAILURE, MEMCACHED_AT,
+          memcached_literal_param("::rec() returned zero, server has disconnected"));
+    }
+
+    instance->io_wait_count._bytes_read += data_read;
+    queue->in_length += size_t(data_read);
+
+    if (size_t(data_read) < space) {
+      /* drained the socket for now */
+      return async_dispatch(memc, instance, queue);
+    }
+  }
+}
+
+memcached_return_t memcached_async_process(memcached_st *shell, memcached_socket_t fd,
+                                           short revents) {
+  Memcached *ptr = memcached2Memcached(shell);
+  if (ptr == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  memcached_instance_st *instance = NULL;
+  for (uint32_t x = 0; x < memcached_server_count(ptr); ++x) {
+    memcached_instance_st *candidate = memcached_instance_fetch(ptr, x);
+    if (candidate->fd == fd and candidate->async) {
+      instance = candidate;
+      break;
+    }
+  }
+
+  if (instance == NULL or fd == INVALID_SOCKET) {
+    return memcached_set_error(*ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+                               memcached_literal_param("Not an asynchronous connection"));
+  }
+
+  memcached_async_queue_st *queue = instance->async;
+  memcached_return_t rc = MEMCACHED_SUCCESS;
+
+  if (revents & POLLOUT) {
+    rc = async_send(instance, queue);
+  }
+  if (memcached_success(rc) and (revents & (POLLIN | POLLERR | POLLHUP))) {
+    rc = async_recv(ptr, instance, queue);
+  }
+
+  if (memcached_failed(rc)) {
+    memcached_quit_server(instance, true);
+    async_fail(ptr, queue, rc);
+  }
+
+  return rc;
+}
+
+memcached_return_t memcached_async_poll(memcached_st *shell, int timeout) {
+  Memcached *ptr = memcached2Memcached(shell);
+  if (ptr == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  uint32_t count = memcached_async_fds(ptr, NULL, 0);
+  if (count == 0) {
+    return MEMCACHED_SUCCESS;
+  }
+
+  memcached_async_fd_st *fds = libmemcached_xcalloc(ptr, count, memcached_async_fd_st);
+  struct pollfd *pfds = libmemcached_xcalloc(ptr, count, struct pollfd);
+  if (fds == NULL or pfds == NULL) {
+    libmemcached_free(ptr, fds);
+    libmemcached_free(ptr, pfds);
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  /* callbacks of failed requests may have changed the picture meanwhile */
+  uint32_t filled = memcached_async_fds(ptr, fds, count);
+  if (filled < count) {
+    count = filled;
+  }
+  for (uint32_t x = 0; x < count; ++x) {
+    pfds[x].fd = fds[x].fd;
+    pfds[x].events = fds[x].events;
+  }
+
+  memcached_return_t rc = MEMCACHED_SUCCESS;
+  int ready = poll(pfds, count, timeout);
+  if (ready == -1) {
+    if (get_socket_errno() != EINTR) {
+      rc = memcached_set_errno(*ptr, get_socket_errno(), MEMCACHED_AT);
+    }
+  } else if (ready == 0) {
+    rc = memcached_set_error(*ptr, MEMCACHED_TIMEOUT, MEMCACHED_AT);
+  } else {
+    for (uint32_t x = 0; x < count; ++x) {
+      if (pfds[x].revents) {
+        memcached_return_t process_rc = memcached_async_process(ptr, pfds[x].fd, pfds[x].revents);
+        if (memcached_failed(process_rc)) {
+          rc = MEMCACHED_SOME_ERRORS;
+        }
+      }
+    }
+  }
+
+  libmemcached_free(ptr, fds);
+  libmemcached_free(ptr, pfds);
+
+  return rc;
+}
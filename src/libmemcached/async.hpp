@@ -0,0 +1,32 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/*
+  Per instance state of the asynchronous API, see libmemcached-1.0/async.h.
+
+  Requests are encoded into their own output buffer and answered strictly in
+  order, so pending requests are a FIFO matched against the opaque of each
+  response; the regular read and write buffers of the instance are not used.
+*/
+
+struct memcached_async_queue_st;
+
+/* The connection went away, pending requests are failed at the next opportunity */
+void memcached_async_reset(memcached_instance_st *);
+
+/* Fail pending requests with MEMCACHED_CONNECTION_FAILURE and release the queue */
+void memcached_async_free(memcached_instance_st *);
@@ -32,6 +32,10 @@ bool memcached_is_consistent_distribution(const Memcached *memc) {
   case MEMCACHED_DISTRIBUTION_MODULA:
   case MEMCACHED_DISTRIBUTION_RANDOM:
   case MEMCACHED_DISTRIBUTION_VIRTUAL_BUCKET:
+  case MEMCACHED_DISTRIBUTION_JUMP:
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS:
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON:
+  case MEMCACHED_DISTRIBUTION_MAGLEV:
   case MEMCACHED_DISTRIBUTION_CONSISTENT_MAX:
     break;
   }
@@ -269,6 +273,127 @@ memcached_return_t memcached_behavior_set(memcached_st *shell, const memcached_b
         memcached_literal_param(
             "MEMCACHED_BEHAVIOR_LOAD_FROM_FILE can not be set with memcached_behavior_set()"));
 
+  case MEMCACHED_BEHAVIOR_IO_URING:
+    if (bool(data)) {
+      return memcached_io_ring_init(ptr);
+    }
+    memcached_io_ring_free(ptr);
+    break;
+
+  case MEMCACHED_BEHAVIOR_IO_SENDMSG_THRESHOLD:
+    ptr->io_sendmsg_threshold = (uint32_t) data;
+    break;
+
+  case MEMCACHED_BEHAVIOR_IO_ZEROCOPY_THRESHOLD:
+#if !(HAVE_MSG_ZEROCOPY && HAVE_SO_ZEROCOPY && HAVE_LINUX_ERRQUEUE_H)
+    if (data) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
+          memcached_literal_param("MSG_ZEROCOPY is not available on this platform"));
+    }
+#endif
+    ptr->io_zerocopy_threshold = (uint32_t) data;
+    break;
+
+  case MEMCACHED_BEHAVIOR_IO_BUFFER_MIN:
+    if (data < MEMCACHED_IO_BUFFER_LOWER_LIMIT or data > ptr->io_buffer_max) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+          memcached_literal_param("MEMCACHED_BEHAVIOR_IO_BUFFER_MIN must be at least 256 and not "
+                                  "exceed MEMCACHED_BEHAVIOR_IO_BUFFER_MAX."));
+    }
+    ptr->io_buffer_min = uint32_t(data);
+    break;
+
+  case MEMCACHED_BEHAVIOR_IO_BUFFER_MAX:
+    if (data < ptr->io_buffer_min or data > UINT32_MAX) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+          memcached_literal_param(
+              "MEMCACHED_BEHAVIOR_IO_BUFFER_MAX must not be less than MEMCACHED_BEHAVIOR_IO_BUFFER_MIN."));
+    }
+    ptr->io_buffer_max = uint32_t(data);
+    break;
+
+  case MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG:
+    if (data > UINT32_MAX or (data & (data - 1))
+        or (data and data == ptr->compression.flag)) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+          memcached_literal_param("MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG must be 0 or a single "
+                                  "bit of the flags not used by compression."));
+    }
+    ptr->encryption_ctr_flag = uint32_t(data);
+    break;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION_FLAG:
+    if (data > UINT32_MAX or (data & (data - 1))
+        or (data and data == ptr->encryption_ctr_flag)) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+          memcached_literal_param("MEMCACHED_BEHAVIOR_COMPRESSION_FLAG must be 0 or a single bit "
+                                  "of the flags not used by encryption."));
+    }
+    if (data and libmemcached_has_compression(ptr->compression.algorithm) == false) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
+          memcached_literal_param("libmemcached was built without support for compression."));
+    }
+    ptr->compression.flag = uint32_t(data);
+    break;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION:
+    if (data == 0 or data >= MEMCACHED_COMPRESSION_MAX) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+          memcached_literal_param("Invalid memcached_compression_t passed to memcached_behavior_set()"));
+    }
+    if (libmemcached_has_compression(memcached_compression_t(data)) == false) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
+          memcached_literal_param("libmemcached was built without support for this compression."));
+    }
+    ptr->compression.algorithm = memcached_compression_t(data);
+    break;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION_LEVEL:
+    if (int64_t(data) < INT32_MIN or int64_t(data) > INT32_MAX) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+          memcached_literal_param("MEMCACHED_BEHAVIOR_COMPRESSION_LEVEL is out of range."));
+    }
+    ptr->compression.level = int32_t(int64_t(data));
+    break;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION_THRESHOLD:
+    if (data > UINT32_MAX) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+          memcached_literal_param("MEMCACHED_BEHAVIOR_COMPRESSION_THRESHOLD is out of range."));
+    }
+    ptr->compression.threshold = uint32_t(data);
+    break;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION_RATIO:
+    if (data == 0 or data > 100) {
+      return memcached_set_error(
+          *ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+          memcached_literal_param("MEMCACHED_BEHAVIOR_COMPRESSION_RATIO must be a percentage."));
+    }
+    ptr->compression.ratio = uint32_t(data);
+    break;
+
+  case MEMCACHED_BEHAVIOR_DNS_TTL:
+    if (data > INT32_MAX) {
+      return memcached_set_error(*ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+                                 memcached_literal_param("MEMCACHED_BEHAVIOR_DNS_TTL is out of range."));
+    }
+    ptr->dns_ttl = int32_t(data);
+    for (uint32_t x = 0; x < memcached_server_count(ptr); ++x) {
+      memcached_resolve_prefetch(memcached_instance_fetch(ptr, x));
+    }
+    break;
+
   case MEMCACHED_BEHAVIOR_MAX:
   default:
     /* Shouldn't get here */
@@ -472,6 +597,42 @@ uint64_t memcached_behavior_get(memcached_st *shell, const memcached_behavior_t
   case MEMCACHED_BEHAVIOR_LOAD_FROM_FILE:
     return bool(memcached_parse_filename(ptr));
 
+  case MEMCACHED_BEHAVIOR_IO_URING:
+    return bool(ptr->io_ring);
+
+  case MEMCACHED_BEHAVIOR_IO_SENDMSG_THRESHOLD:
+    return ptr->io_sendmsg_threshold;
+
+  case MEMCACHED_BEHAVIOR_IO_ZEROCOPY_THRESHOLD:
+    return ptr->io_zerocopy_threshold;
+
+  case MEMCACHED_BEHAVIOR_IO_BUFFER_MIN:
+    return ptr->io_buffer_min;
+
+  case MEMCACHED_BEHAVIOR_IO_BUFFER_MAX:
+    return ptr->io_buffer_max;
+
+  case MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG:
+    return ptr->encryption_ctr_flag;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION_FLAG:
+    return ptr->compression.flag;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION:
+    return ptr->compression.algorithm;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION_LEVEL:
+    return uint64_t(int64_t(ptr->compression.level));
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION_THRESHOLD:
+    return ptr->compression.threshold;
+
+  case MEMCACHED_BEHAVIOR_COMPRESSION_RATIO:
+    return ptr->compression.ratio;
+
+  case MEMCACHED_BEHAVIOR_DNS_TTL:
+    return uint64_t(ptr->dns_ttl);
+
   case MEMCACHED_BEHAVIOR_MAX:
   default:
     assert_msg(0, "Invalid behavior passed to memcached_behavior_get()");
@@ -507,6 +668,16 @@ memcached_return_t memcached_behavior_set_distribution(memcached_st *shell,
     case MEMCACHED_DISTRIBUTION_VIRTUAL_BUCKET:
       break;
 
+    case MEMCACHED_DISTRIBUTION_JUMP:
+      memcached_set_weighted_ketama(ptr, false);
+      break;
+
+    case MEMCACHED_DISTRIBUTION_RENDEZVOUS:
+    case MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON:
+    case MEMCACHED_DISTRIBUTION_MAGLEV:
+      memcached_set_weighted_ketama(ptr, false);
+      break;
+
     default:
     case MEMCACHED_DISTRIBUTION_CONSISTENT_MAX:
       return memcached_set_error(
@@ -657,6 +828,30 @@ const char *libmemcached_string_behavior(const memcached_behavior_t flag) {
     return "MEMCACHED_BEHAVIOR_TCP_KEEPIDLE";
   case MEMCACHED_BEHAVIOR_LOAD_FROM_FILE:
     return "MEMCACHED_BEHAVIOR_LOAD_FROM_FILE";
+  case MEMCACHED_BEHAVIOR_IO_URING:
+    return "MEMCACHED_BEHAVIOR_IO_URING";
+  case MEMCACHED_BEHAVIOR_IO_SENDMSG_THRESHOLD:
+    return "MEMCACHED_BEHAVIOR_IO_SENDMSG_THRESHOLD";
+  case MEMCACHED_BEHAVIOR_IO_ZEROCOPY_THRESHOLD:
+    return "MEMCACHED_BEHAVIOR_IO_ZEROCOPY_THRESHOLD";
+  case MEMCACHED_BEHAVIOR_IO_BUFFER_MIN:
+    return "MEMCACHED_BEHAVIOR_IO_BUFFER_MIN";
+  case MEMCACHED_BEHAVIOR_IO_BUFFER_MAX:
+    return "MEMCACHED_BEHAVIOR_IO_BUFFER_MAX";
+  case MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG:
+    return "MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG";
+  case MEMCACHED_BEHAVIOR_COMPRESSION_FLAG:
+    return "MEMCACHED_BEHAVIOR_COMPRESSION_FLAG";
+  case MEMCACHED_BEHAVIOR_COMPRESSION:
+    return "MEMCACHED_BEHAVIOR_COMPRESSION";
+  case MEMCACHED_BEHAVIOR_COMPRESSION_LEVEL:
+    return "MEMCACHED_BEHAVIOR_COMPRESSION_LEVEL";
+  case MEMCACHED_BEHAVIOR_COMPRESSION_THRESHOLD:
+    return "MEMCACHED_BEHAVIOR_COMPRESSION_THRESHOLD";
+  case MEMCACHED_BEHAVIOR_COMPRESSION_RATIO:
+    return "MEMCACHED_BEHAVIOR_COMPRESSION_RATIO";
+  case MEMCACHED_BEHAVIOR_DNS_TTL:
+    return "MEMCACHED_BEHAVIOR_DNS_TTL";
   default:
   case MEMCACHED_BEHAVIOR_MAX:
     return "INVALID memcached_behavior_t";
@@ -679,6 +874,14 @@ const char *libmemcached_string_distribution(const memcached_server_distribution
     return "MEMCACHED_DISTRIBUTION_CONSISTENT_WEIGHTED";
   case MEMCACHED_DISTRIBUTION_VIRTUAL_BUCKET:
     return "MEMCACHED_DISTRIBUTION_VIRTUAL_BUCKET";
+  case MEMCACHED_DISTRIBUTION_JUMP:
+    return "MEMCACHED_DISTRIBUTION_JUMP";
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS:
+    return "MEMCACHED_DISTRIBUTION_RENDEZVOUS";
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON:
+    return "MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON";
+  case MEMCACHED_DISTRIBUTION_MAGLEV:
+    return "MEMCACHED_DISTRIBUTION_MAGLEV";
   default:
   case MEMCACHED_DISTRIBUTION_CONSISTENT_MAX:
     return "INVALID memcached_server_distribution_t";
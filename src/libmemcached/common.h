@@ -71,12 +71,19 @@ memcached_instance_st *memcached_instance_fetch(memcached_st *ptr, uint32_t serv
 #  include "libmemcached/string.hpp"
 #  include "libmemcachedprotocol-0.0/binary.h"
 #  include "libmemcached/io.hpp"
+#  include "libmemcached/io_ring.hpp"
+#  include "libmemcached/rendezvous.hpp"
+#  include "libmemcached/maglev.hpp"
+#  include "libmemcached/async.hpp"
+#  include "libmemcached/compression.hpp"
+#  include "libmemcached/pipeline.hpp"
 #  include "libmemcached/udp.hpp"
 #  include "libmemcached/do.hpp"
 #  include "libmemcached/connect.hpp"
 #  include "libmemcached/allocators.hpp"
 #  include "libmemcached/hash.hpp"
 #  include "libmemcached/quit.hpp"
+#  include "libmemcached/resolver.hpp"
 #  include "libmemcached/instance.hpp"
 #  include "libmemcached/server_instance.h"
 #  include "libmemcached/server.hpp"
@@ -0,0 +1,361 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#include "libmemcached/common.h"
+
+#if HAVE_LIBLZ4
+#  include <lz4.h>
+#  include <lz4hc.h>
+#endif
+#if HAVE_LIBZSTD
+#  include <zstd.h>
+#endif
+
+/* the zstd contexts are kept across values, they are expensive to set up */
+struct memcached_compression_context_st {
+#if HAVE_LIBZSTD
+  ZSTD_CCtx *zstd_compress;
+  ZSTD_DCtx *zstd_decompress;
+#endif
+};
+
+#if HAVE_LIBZSTD
+static memcached_compression_context_st *compression_context(Memcached *ptr) {
+  if (ptr->compression.context == NULL) {
+    ptr->compression.context = libmemcached_xcalloc(ptr, 1, memcached_compression_context_st);
+  }
+  return ptr->compression.context;
+}
+#endif
+
+void memcached_compression_free(memcached_st *ptr) {
+  if (ptr->compression.context) {
+#if HAVE_LIBZSTD
+    ZSTD_freeCCtx(ptr->compression.context->zstd_compress);
+    ZSTD_freeDCtx(ptr->compression.context->zstd_decompress);
+#endif
+    libmemcached_free(ptr, ptr->compression.context);
+    ptr->compression.context = NULL;
+  }
+}
+
+memcached_compression_t memcached_compression_default() {
+#if HAVE_LIBZSTD
+  return MEMCACHED_COMPRESSION_ZSTD;
+#elif HAVE_LIBLZ4
+  return MEMCACHED_COMPRESSION_LZ4;
+#else
+  return MEMCACHED_COMPRESSION_MAX;
+#endif
+}
+
+/* returns the compressed length, or 0 if the value does not compress to dst_length */
+static size_t compress_value(Memcached *ptr, const char *src, size_t src_length, char *dst,
+                             size_t dst_length) {
+  int level = ptr->compression.level;
+#if !HAVE_LIBLZ4 && !HAVE_LIBZSTD
+  (void) level;
+  (void) src;
+  (void) src_length;
+  (void) dst;
+  (void) dst_length;
+#endif
+
+  switch (ptr->compression.algorithm) {
+  case MEMCACHED_COMPRESSION_LZ4:
+#if HAVE_LIBLZ4
+    if (src_length > LZ4_MAX_INPUT_SIZE) {
+      return 0;
+    }
+    if (dst_length > INT_MAX) {
+      dst_length = INT_MAX;
+    }
+    /* negative levels accelerate the default compressor, positive ones select LZ4HC */
+    if (level > 0) {
+      return size_t(LZ4_compress_HC(src, dst, int(src_length), int(dst_length), level));
+    }
+    return size_t(LZ4_compress_fast(src, dst, int(src_length), int(dst_length), 1 - level));
+#else
+    break;
+#endif
+
+  case MEMCACHED_COMPRESSION_ZSTD:
+#if HAVE_LIBZSTD
+  {
+    memcached_compression_context_st *context = compression_context(ptr);
+    if (context == NULL) {
+      return 0;
+    }
+    if (context->zstd_compress == NULL
+        and (context->zstd_compress = ZSTD_createCCtx()) == NULL) {
+      return 0;
+    }
+    size_t length = ZSTD_compressCCtx(context->zstd_compress, dst, dst_length, src, src_length,
+                                      level ? level : ZSTD_CLEVEL_DEFAULT);
+    return ZSTD_isError(length) ? 0 : length;
+  }
+#else
+    break;
+#endif
+
+  case MEMCACHED_COMPRESSION_MAX:
+  default:
+    break;
+  }
+
+  return 0;
+}
+
+/*
+  The length in the header of a value is checked before allocating it, so that a corrupt or foreign
+  value can not make us allocate up to 4GB.
+*/
+#define MEMCACHED_COMPRESSION_MAX_LENGTH (1024 * 1024 * 1024) /* memcached's largest item size */
+#define MEMCACHED_COMPRESSION_LZ4_RATIO  255                  /* LZ4's best possible ratio */
+
+static bool decompressed_length_valid(memcached_compression_t algorithm, const char *src,
+                                      size_t src_length, size_t length) {
+#if !HAVE_LIBZSTD
+  (void) src;
+#endif
+
+  if (length > MEMCACHED_COMPRESSION_MAX_LENGTH) {
+    return false;
+  }
+
+  switch (algorithm) {
+  case MEMCACHED_COMPRESSION_LZ4:
+    return length <= uint64_t(src_length) * MEMCACHED_COMPRESSION_LZ4_RATIO;
+
+  case MEMCACHED_COMPRESSION_ZSTD:
+#if HAVE_LIBZSTD
+    /* zstd frames record their content size */
+    return ZSTD_getFrameContentSize(src, src_length) == length;
+#else
+    break;
+#endif
+
+  case MEMCACHED_COMPRESSION_MAX:
+  default:
+    break;
+  }
+
+  return false;
+}
+
+static bool decompress_value(Memcached *ptr, memcached_compression_t algorithm, const char *src,
+                             size_t src_length, char *dst, size_t dst_length) {
+#if !HAVE_LIBZSTD
+  (void) ptr;
+#endif
+#if !HAVE_LIBLZ4 && !HAVE_LIBZSTD
+  (void) src;
+  (void) src_length;
+  (void) dst;
+  (void) dst_length;
+#endif
+
+  switch (algorithm) {
+  case MEMCACHED_COMPRESSION_LZ4:
+#if HAVE_LIBLZ4
+    if (src_length > INT_MAX or dst_length > INT_MAX) {
+      return false;
+    }
+    return LZ4_decompress_safe(src, dst, int(src_length), int(dst_length)) == int(dst_length);
+#else
+    break;
+#endif
+
+  case MEMCACHED_COMPRESSION_ZSTD:
+#if HAVE_LIBZSTD
+  {
+    memcached_compression_context_st *context = compression_context(ptr);
+    if (context == NULL) {
+      return false;
+    }
+    if (context->zstd_decompress == NULL
+        and (context->zstd_decompress = ZSTD_createDCtx()) == NULL) {
+      return false;
+    }
+    return ZSTD_decompressDCtx(context->zstd_decompress, dst, dst_length, src, src_length)
+        == dst_length;
+  }
+#else
+    break;
+#endif
+
+  case MEMCACHED_COMPRESSION_MAX:
+  default:
+    break;
+  }
+
+  return false;
+}
+
+char *memcached_compress(memcached_st *ptr, const char *value, size_t value_length, char *buffer,
+                         size_t &buffer_length) {
+  /* a value not compressing to the ratio does not fit, which ends compression early */
+  size_t length =
+      MEMCACHED_COMPRESSION_HEADER_SIZE + uint64_t(value_length) * ptr->compression.ratio / 100;
+  if (value_length > UINT32_MAX or length <= MEMCACHED_COMPRESSION_HEADER_SIZE) {
+    ptr->compression.stat.not_compressed++;
+    return NULL;
+  }
+
+  char *destination = buffer;
+  if (length > buffer_length
+      and (destination = (char *) libmemcached_malloc(ptr, length)) == NULL) {
+    return NULL;
+  }
+
+  size_t compressed_length =
+      compress_value(ptr, value, value_length, destination + MEMCACHED_COMPRESSION_HEADER_SIZE,
+                     length - MEMCACHED_COMPRESSION_HEADER_SIZE);
+  if (compressed_length == 0) {
+    if (destination != buffer) {
+      libmemcached_free(ptr, destination);
+    }
+    ptr->compression.stat.not_compressed++;
+    return NULL;
+  }
+
+  destination[0] = char(ptr->compression.algorithm);
+  for (int i = 0; i < 4; ++i) {
+    destination[1 + i] = char(value_length >> (8 * i));
+  }
+
+  buffer_length = MEMCACHED_COMPRESSION_HEADER_SIZE + compressed_length;
+  ptr->compression.stat.compressed++;
+  ptr->compression.stat.compressed_bytes += value_length;
+  ptr->compression.stat.compressed_size += buffer_length;
+
+  return destination;
+}
+
+memcached_return_t memcached_decompress(memcached_instance_st *instance,
+                                        memcached_result_st *result) {
+  Memcached *ptr = instance->root;
+  if (memcached_is_compressed(ptr, result->item_flags) == false) {
+    return MEMCACHED_SUCCESS;
+  }
+  result->item_flags &= ~ptr->compression.flag;
+
+  size_t compressed_length = memcached_result_length(result);
+  if (compressed_length < MEMCACHED_COMPRESSION_HEADER_SIZE) {
+    ptr->compression.stat.failed++;
+    return memcached_set_error(*ptr, MEMCACHED_FAILURE, MEMCACHED_AT,
+                               memcached_literal_param("Invalid compressed value"));
+  }
+
+  const unsigned char *header = (const unsigned char *) memcached_result_value(result);
+  memcached_compression_t algorithm = memcached_compression_t(header[0]);
+  size_t length = 0;
+  for (int i = 0; i < 4; ++i) {
+    length |= size_t(header[1 + i]) << (8 * i);
+  }
+  if (libmemcached_has_compression(algorithm) == false) {
+    ptr->compression.stat.failed++;
+    return memcached_set_error(*ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
+                               memcached_literal_param("Unsupported compression of value"));
+  }
+
+  if (decompressed_length_valid(algorithm, (const char *) header + MEMCACHED_COMPRESSION_HEADER_SIZE,
+                                compressed_length - MEMCACHED_COMPRESSION_HEADER_SIZE, length)
+      == false)
+  {
+    ptr->compression.stat.failed++;
+    return memcached_set_error(*ptr, MEMCACHED_FAILURE, MEMCACHED_AT,
+                               memcached_literal_param("Invalid length of compressed value"));
+  }
+
+  /* move the compressed value behind the space of the decompressed one */
+  if (memcached_failed(memcached_string_check(&result->value, length + 1))) {
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+  char *value = memcached_string_value_mutable(&result->value);
+  char *compressed = value + length + 1;
+  memmove(compressed, value, compressed_length);
+
+  if (decompress_value(ptr, algorithm, compressed + MEMCACHED_COMPRESSION_HEADER_SIZE,
+                       compressed_length - MEMCACHED_COMPRESSION_HEADER_SIZE, value, length)
+      == false)
+  {
+    ptr->compression.stat.failed++;
+    memcached_string_set_length(&result->value, 0);
+    return memcached_set_error(*ptr, MEMCACHED_FAILURE, MEMCACHED_AT,
+                               memcached_literal_param("Failed to decompress value"));
+  }
+
+  value[length] = 0;
+  memcached_string_set_length(&result->value, length);
+  ptr->compression.stat.decompressed++;
+  ptr->compression.stat.decompressed_bytes += length;
+
+  return MEMCACHED_SUCCESS;
+}
+
+memcached_return_t memcached_compression_stat(const memcached_st *shell,
+                                              memcached_compression_stat_st *stat) {
+  const Memcached *ptr = memcached2Memcached(shell);
+  if (ptr == NULL or stat == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  *stat = ptr->compression.stat;
+  return MEMCACHED_SUCCESS;
+}
+
+void memcached_compression_stat_reset(memcached_st *shell) {
+  Memcached *ptr = memcached2Memcached(shell);
+  if (ptr) {
+    memset(&ptr->compression.stat, 0, sizeof(ptr->compression.stat));
+  }
+}
+
+bool libmemcached_has_compression(memcached_compression_t algorithm) {
+  switch (algorithm) {
+  case MEMCACHED_COMPRESSION_LZ4:
+#if HAVE_LIBLZ4
+    return true;
+#else
+    break;
+#endif
+  case MEMCACHED_COMPRESSION_ZSTD:
+#if HAVE_LIBZSTD
+    return true;
+#else
+    break;
+#endif
+  case MEMCACHED_COMPRESSION_MAX:
+  default:
+    break;
+  }
+
+  return false;
+}
+
+const char *libmemcached_string_compression(memcached_compression_t algorithm) {
+  switch (algorithm) {
+  case MEMCACHED_COMPRESSION_LZ4:
+    return "MEMCACHED_COMPRESSION_LZ4";
+  case MEMCACHED_COMPRESSION_ZSTD:
+    return "MEMCACHED_COMPRESSION_ZSTD";
+  case MEMCACHED_COMPRESSION_MAX:
+  default:
+    break;
+  }
+
+  return "INVALID memcached_compression_t";
+}
@@ -0,0 +1,47 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/*
+  Transparent compression of values, see MEMCACHED_BEHAVIOR_COMPRESSION_FLAG.
+
+  A compressed value starts with a header of the algorithm and the little endian
+  length of the uncompressed value, so that each value is decompressed with the
+  algorithm it was compressed with, whatever the current settings are.
+*/
+
+#define MEMCACHED_COMPRESSION_HEADER_SIZE 5
+
+memcached_compression_t memcached_compression_default();
+void memcached_compression_free(memcached_st *);
+
+static inline bool memcached_is_compressing(const memcached_st *ptr, size_t value_length) {
+  return ptr->compression.flag and value_length >= ptr->compression.threshold;
+}
+
+static inline bool memcached_is_compressed(const memcached_st *ptr, uint32_t flags) {
+  return ptr->compression.flag and (flags & ptr->compression.flag);
+}
+
+/*
+  Compress a value into buffer, or an allocation if buffer_length is too small, and
+  return it, or NULL if the value is to be stored uncompressed.
+*/
+char *memcached_compress(memcached_st *, const char *value, size_t value_length, char *buffer,
+                         size_t &buffer_length);
+
+/* Decompress the value of a result flagged as compressed in place */
+memcached_return_t memcached_decompress(memcached_instance_st *, memcached_result_st *);
@@ -15,8 +15,11 @@
 
 #include "libmemcached/common.h"
 #include "p9y/poll.hpp"
+#include "p9y/clock_gettime.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 
 static memcached_return_t set_hostinfo(memcached_instance_st *server) {
   assert(server->type != MEMCACHED_CONNECTION_UNIX_SOCKET);
@@ -24,37 +27,7 @@ static memcached_return_t set_hostinfo(memcached_instance_st *server) {
 
   server->clear_addrinfo();
 
-  char str_host[MEMCACHED_NI_MAXHOST] = {0}, str_port[MEMCACHED_NI_MAXSERV] = {0};
-  errno = 0;
-
-  auto length = snprintf(str_port, MEMCACHED_NI_MAXSERV, "%u", uint32_t(server->port()));
-  if (length <= 0 or errno) {
-    return memcached_set_error(*server, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT,
-                               memcached_literal_param("snprintf(NI_MAXSERV)"));
-  }
-
-  struct addrinfo hints{};
-  hints.ai_family = AF_UNSPEC;
-  if (memcached_is_udp(server->root)) {
-    hints.ai_protocol = IPPROTO_UDP;
-    hints.ai_socktype = SOCK_DGRAM;
-  } else {
-    hints.ai_protocol = IPPROTO_TCP;
-    hints.ai_socktype = SOCK_STREAM;
-  }
-
-  auto hostname = server->hostname();
-  if (*hostname == '[') {
-    auto closing_bracket = &hostname[strlen(hostname) - 1];
-    if (*closing_bracket == ']') {
-      auto host_len = closing_bracket - hostname - 1;
-      if (host_len < MEMCACHED_NI_MAXHOST) {
-        hostname = strncpy(str_host, hostname + 1, host_len);
-      }
-    }
-  }
-
-  auto errcode = getaddrinfo(hostname, str_port, &hints, &server->address_info);
+  auto errcode = memcached_resolve(server);
   switch (errcode) {
   case 0:
     server->address_info_next = server->address_info;
@@ -90,10 +63,10 @@ static memcached_return_t set_hostinfo(memcached_instance_st *server) {
   return MEMCACHED_SUCCESS;
 }
 
-static inline void set_socket_nonblocking(memcached_instance_st *server) {
+static inline void set_socket_nonblocking(memcached_instance_st *server, memcached_socket_t fd) {
 #if defined(_WIN32)
   u_long arg = 1;
-  if (ioctlsocket(server->fd, FIONBIO, &arg) == SOCKET_ERROR) {
+  if (ioctlsocket(fd, FIONBIO, &arg) == SOCKET_ERROR) {
     memcached_set_errno(*server, get_socket_errno(), NULL);
   }
 #else
@@ -101,7 +74,7 @@ static inline void set_socket_nonblocking(memcached_instance_st *server) {
 
   if (SOCK_NONBLOCK == 0) {
     do {
-      flags = fcntl(server->fd, F_GETFL, 0);
+      flags = fcntl(fd, F_GETFL, 0);
     } while (flags == -1 && (errno == EINTR || errno == EAGAIN));
 
     if (flags == -1) {
@@ -110,7 +83,7 @@ static inline void set_socket_nonblocking(memcached_instance_st *server) {
       int rval;
 
       do {
-        rval = fcntl(server->fd, F_SETFL, flags | O_NONBLOCK);
+        rval = fcntl(fd, F_SETFL, flags | O_NONBLOCK);
       } while (rval == -1 && (errno == EINTR or errno == EAGAIN));
 
       if (rval == -1) {
@@ -121,8 +94,8 @@ static inline void set_socket_nonblocking(memcached_instance_st *server) {
 #endif
 }
 
-static bool set_socket_options(memcached_instance_st *server) {
-  assert_msg(server->fd != INVALID_SOCKET, "invalid socket was passed to set_socket_options()");
+static bool set_socket_options(memcached_instance_st *server, memcached_socket_t fd) {
+  assert_msg(fd != INVALID_SOCKET, "invalid socket was passed to set_socket_options()");
 
 #ifdef HAVE_FCNTL
   // If SOCK_CLOEXEC exists then we don't need to call the following
@@ -130,13 +103,13 @@ static bool set_socket_options(memcached_instance_st *server) {
     if (FD_CLOEXEC) {
       int flags;
       do {
-        flags = fcntl(server->fd, F_GETFD, 0);
+        flags = fcntl(fd, F_GETFD, 0);
       } while (flags == -1 and (errno == EINTR or errno == EAGAIN));
 
       if (flags != -1) {
         int rval;
         do {
-          rval = fcntl(server->fd, F_SETFD, flags | FD_CLOEXEC);
+          rval = fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
         } while (rval == -1 && (errno == EINTR or errno == EAGAIN));
         // we currently ignore the case where rval is -1
       }
@@ -155,7 +128,7 @@ static bool set_socket_options(memcached_instance_st *server) {
     waittime.tv_sec = server->root->snd_timeout / 1000000;
     waittime.tv_usec = server->root->snd_timeout % 1000000;
 
-    int error = setsockopt(server->fd, SOL_SOCKET, SO_SNDTIMEO, (char *) &waittime,
+    int error = setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, (char *) &waittime,
                            (socklen_t) sizeof(struct timeval));
     (void) error;
     assert(error == 0);
@@ -169,7 +142,7 @@ static bool set_socket_options(memcached_instance_st *server) {
     waittime.tv_sec = server->root->rcv_timeout / 1000000;
     waittime.tv_usec = server->root->rcv_timeout % 1000000;
 
-    int error = setsockopt(server->fd, SOL_SOCKET, SO_RCVTIMEO, (char *) &waittime,
+    int error = setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (char *) &waittime,
                            (socklen_t) sizeof(struct timeval));
     (void) (error);
     assert(error == 0);
@@ -181,7 +154,7 @@ static bool set_socket_options(memcached_instance_st *server) {
 #  if defined(SO_NOSIGPIPE)
   if (SO_NOSIGPIPE) {
     int set = 1;
-    int error = setsockopt(server->fd, SOL_SOCKET, SO_NOSIGPIPE, (void *) &set, sizeof(int));
+    int error = setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, (void *) &set, sizeof(int));
 
     assert(error == 0);
 
@@ -200,7 +173,7 @@ static bool set_socket_options(memcached_instance_st *server) {
 
     linger.l_onoff = 1;
     linger.l_linger = 0; /* By default on close() just drop the socket */
-    int error = setsockopt(server->fd, SOL_SOCKET, SO_LINGER, (char *) &linger,
+    int error = setsockopt(fd, SOL_SOCKET, SO_LINGER, (char *) &linger,
                            (socklen_t) sizeof(struct linger));
     (void) (error);
     assert(error == 0);
@@ -211,7 +184,7 @@ static bool set_socket_options(memcached_instance_st *server) {
       int flag = 1;
 
       int error =
-          setsockopt(server->fd, IPPROTO_TCP, TCP_NODELAY, (char *) &flag, (socklen_t) sizeof(int));
+          setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (char *) &flag, (socklen_t) sizeof(int));
       (void) (error);
       assert(error == 0);
     }
@@ -221,14 +194,14 @@ static bool set_socket_options(memcached_instance_st *server) {
     int flag = 1;
 
     int error =
-        setsockopt(server->fd, SOL_SOCKET, SO_KEEPALIVE, (char *) &flag, (socklen_t) sizeof(int));
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, (char *) &flag, (socklen_t) sizeof(int));
     (void) (error);
     assert(error == 0);
   }
 
   if (TCP_KEEPIDLE) {
     if (server->root->tcp_keepidle > 0) {
-      int error = setsockopt(server->fd, IPPROTO_TCP, TCP_KEEPIDLE,
+      int error = setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE,
                              (char *) &server->root->tcp_keepidle, (socklen_t) sizeof(int));
       (void) (error);
       assert(error == 0);
@@ -236,21 +209,21 @@ static bool set_socket_options(memcached_instance_st *server) {
   }
 
   if (server->root->send_size > 0) {
-    int error = setsockopt(server->fd, SOL_SOCKET, SO_SNDBUF, (char *) &server->root->send_size,
+    int error = setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (char *) &server->root->send_size,
                            (socklen_t) sizeof(int));
     (void) (error);
     assert(error == 0);
   }
 
   if (server->root->recv_size > 0) {
-    int error = setsockopt(server->fd, SOL_SOCKET, SO_RCVBUF, (char *) &server->root->recv_size,
+    int error = setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (char *) &server->root->recv_size,
                            (socklen_t) sizeof(int));
     (void) (error);
     assert(error == 0);
   }
 
   /* libmemcached will always use nonblocking IO to avoid write deadlocks */
-  set_socket_nonblocking(server);
+  set_socket_nonblocking(server, fd);
 
   return true;
 }
@@ -320,8 +293,102 @@ static memcached_return_t unix_socket_connect(memcached_instance_st *server) {
 #endif
 }
 
-static memcached_return_t network_connect(memcached_instance_st *server) {
-  bool timeout_error_occured = false;
+/*
+  The addresses of a server are raced happy eyeballs style (RFC 8305): they
+  alternate between address families, and the next one is tried as soon as
+  the previous attempt failed or did not complete within
+  CONNECT_ATTEMPT_DELAY. The first attempt to complete wins, and the races
+  of several servers share a single poll().
+*/
+#define CONNECT_ATTEMPT_DELAY 250 /* ms */
+#define CONNECT_POLL_BUFFER   16
+
+struct connect_race_st;
+
+struct connect_attempt_st {
+  connect_race_st *race;
+  struct addrinfo *address;
+  memcached_socket_t fd;
+  int64_t expires;
+};
+
+struct connect_race_st {
+  memcached_instance_st *server;
+  connect_attempt_st *attempts;
+  uint32_t count;
+  uint32_t started;
+  uint32_t active;
+  int64_t next_start;
+  bool in_timeout;
+  bool done;
+  memcached_return_t rc;
+};
+
+static int64_t connect_now() {
+  timespec tspec{};
+  clock_gettime(CLOCK_MONOTONIC, &tspec);
+  return int64_t(tspec.tv_sec) * 1000 + tspec.tv_nsec / 1000000;
+}
+
+static struct addrinfo *race_next_address(struct addrinfo *address, const struct addrinfo *first,
+                                          bool same_family) {
+  while (address
+         and (address == first or (address->ai_family == first->ai_family) != same_family))
+  {
+    address = address->ai_next;
+  }
+  return address;
+}
+
+static void race_finish(connect_race_st &race, memcached_return_t rc) {
+  for (uint32_t x = 0; x < race.started; ++x) {
+    if (race.attempts[x].fd != INVALID_SOCKET) {
+      (void) closesocket(race.attempts[x].fd);
+      race.attempts[x].fd = INVALID_SOCKET;
+    }
+  }
+  race.active = 0;
+  race.done = true;
+  race.rc = rc;
+}
+
+static void race_won(connect_race_st &race, connect_attempt_st &attempt) {
+  memcached_instance_st *server = race.server;
+
+  server->fd = attempt.fd;
+  server->address_info_next = attempt.address;
+  server->state = MEMCACHED_SERVER_STATE_CONNECTED;
+  attempt.fd = INVALID_SOCKET;
+
+  race_finish(race, MEMCACHED_SUCCESS);
+}
+
+static void race_lost(connect_race_st &race) {
+  memcached_instance_st *server = race.server;
+
+  /* look the server up again on the next try */
+  server->address_info_next = NULL;
+
+  WATCHPOINT_STRING("Never got a good file descriptor");
+  if (memcached_has_current_error(*server)) {
+    race_finish(race, memcached_instance_error_return(server));
+  } else {
+    /* The last error should be from connect() */
+    race_finish(race, memcached_set_error(*server, MEMCACHED_CONNECTION_FAILURE, MEMCACHED_AT));
+  }
+}
+
+static void race_failed(connect_race_st &race, connect_attempt_st &attempt, int local_error,
+                        int64_t now) {
+  (void) closesocket(attempt.fd);
+  attempt.fd = INVALID_SOCKET;
+  race.active--;
+  race.next_start = now;
+  memcached_set_errno(*race.server, local_error, MEMCACHED_AT);
+}
+
+static void race_init(connect_race_st &race) {
+  memcached_instance_st *server = race.server;
 
   WATCHPOINT_ASSERT(server->fd == INVALID_SOCKET);
   WATCHPOINT_ASSERT(server->cursor_active_ == 0);
@@ -336,117 +403,265 @@ static memcached_return_t network_connect(memcached_instance_st *server) {
     memcached_return_t rc = set_hostinfo(server);
 
     if (memcached_failed(rc)) {
-      return rc;
+      race.done = true;
+      race.rc = rc;
+      return;
     }
   }
 
-  assert(server->address_info_next);
-  assert(server->address_info);
+  for (struct addrinfo *address = server->address_info; address; address = address->ai_next) {
+    race.count++;
+  }
 
-  /* Create the socket */
-  while (server->address_info_next and server->fd == INVALID_SOCKET) {
-    int type = server->address_info_next->ai_socktype;
-    if (SOCK_CLOEXEC) {
-      type |= SOCK_CLOEXEC;
-    }
+  race.attempts = libmemcached_xcalloc(server->root, race.count, connect_attempt_st);
+  if (race.attempts == NULL) {
+    race.done = true;
+    race.rc = memcached_set_error(*server, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    return;
+  }
 
-    if (SOCK_NONBLOCK) {
-      type |= SOCK_NONBLOCK;
+  /* the address we last connected to goes first */
+  struct addrinfo *first = server->address_info_next;
+  struct addrinfo *same = race_next_address(server->address_info, first, true);
+  struct addrinfo *other = race_next_address(server->address_info, first, false);
+
+  for (uint32_t x = 0; x < race.count; ++x) {
+    connect_attempt_st &attempt = race.attempts[x];
+
+    attempt.race = &race;
+    attempt.fd = INVALID_SOCKET;
+    if (x == 0) {
+      attempt.address = first;
+    } else if (other and (x % 2 or same == NULL)) {
+      attempt.address = other;
+      other = race_next_address(other->ai_next, first, false);
+    } else {
+      attempt.address = same;
+      same = race_next_address(same->ai_next, first, true);
     }
+  }
+}
 
-    server->fd =
-        socket(server->address_info_next->ai_family, type, server->address_info_next->ai_protocol);
+static void race_attempt(connect_race_st &race, int64_t now) {
+  memcached_instance_st *server = race.server;
+  connect_attempt_st &attempt = race.attempts[race.started++];
 
-    if (int(server->fd) == SOCKET_ERROR) {
-      return memcached_set_errno(*server, get_socket_errno(), NULL);
-    }
+  race.next_start = now + CONNECT_ATTEMPT_DELAY;
 
-    if (set_socket_options(server) == false) {
-      server->reset_socket();
-      return MEMCACHED_CONNECTION_FAILURE;
-    }
+  int type = attempt.address->ai_socktype;
+  if (SOCK_CLOEXEC) {
+    type |= SOCK_CLOEXEC;
+  }
 
-    /* connect to server */
-    if ((connect(server->fd, server->address_info_next->ai_addr,
-                 server->address_info_next->ai_addrlen)
-         != SOCKET_ERROR))
-    {
-      server->state = MEMCACHED_SERVER_STATE_CONNECTED;
-      return MEMCACHED_SUCCESS;
-    }
+  if (SOCK_NONBLOCK) {
+    type |= SOCK_NONBLOCK;
+  }
 
-    /* An error occurred */
-    int local_error = get_socket_errno();
-    switch (local_error) {
-    case ETIMEDOUT:
-      timeout_error_occured = true;
-      break;
+  memcached_socket_t fd =
+      socket(attempt.address->ai_family, type, attempt.address->ai_protocol);
+
+  if (int(fd) == SOCKET_ERROR) {
+    memcached_set_errno(*server, get_socket_errno(), NULL);
+    return;
+  }
+
+  if (set_socket_options(server, fd) == false) {
+    (void) closesocket(fd);
+    return;
+  }
 
+  attempt.fd = fd;
+  race.active++;
+
+  /* connect to server */
+  if (connect(fd, attempt.address->ai_addr, attempt.address->ai_addrlen) != SOCKET_ERROR) {
+    race_won(race, attempt);
+    return;
+  }
+
+  int local_error = get_socket_errno();
+  switch (local_error) {
 #if EWOULDBLOCK != EAGAIN
-    case EWOULDBLOCK:
+  case EWOULDBLOCK:
 #endif
-    case EAGAIN:
-    case EINPROGRESS: // nonblocking mode - first return
-    case EALREADY:    // nonblocking mode - subsequent returns
-    {
-      server->events(POLLOUT);
-      server->state = MEMCACHED_SERVER_STATE_IN_PROGRESS;
-      memcached_return_t rc = memcached_io_poll(server, IO_POLL_CONNECT, local_error);
+  case EAGAIN:
+  case EINPROGRESS: // nonblocking mode - first return
+  case EALREADY:    // nonblocking mode - subsequent returns
+  case EINTR:       // the connection is still established asynchronously
+    server->events(POLLOUT);
+    server->state = MEMCACHED_SERVER_STATE_IN_PROGRESS;
+    if (server->root->connect_timeout < 0) {
+      attempt.expires = INT64_MAX;
+    } else {
+      attempt.expires = now + server->root->connect_timeout;
+    }
+    break;
+
+  case ECONNREFUSED:
+    // Probably not running service
+
+  default:
+    race_failed(race, attempt, local_error, now);
+    break;
+  }
+}
 
-      if (memcached_success(rc)) {
-        server->state = MEMCACHED_SERVER_STATE_CONNECTED;
-        return MEMCACHED_SUCCESS;
+static void network_race(connect_race_st *races, uint32_t count) {
+  uint32_t total = 0;
+
+  for (uint32_t x = 0; x < count; ++x) {
+    race_init(races[x]);
+    total += races[x].count;
+  }
+
+  struct pollfd fds_buffer[CONNECT_POLL_BUFFER];
+  connect_attempt_st *attempts_buffer[CONNECT_POLL_BUFFER];
+  struct pollfd *fds = fds_buffer;
+  connect_attempt_st **attempts = attempts_buffer;
+
+  if (total > CONNECT_POLL_BUFFER) {
+    Memcached *memc = races[0].server->root;
+
+    fds = libmemcached_xcalloc(memc, total, struct pollfd);
+    attempts = libmemcached_xcalloc(memc, total, connect_attempt_st *);
+    if (fds == NULL or attempts == NULL) {
+      for (uint32_t x = 0; x < count; ++x) {
+        if (races[x].done == false) {
+          race_finish(races[x], memcached_set_error(*races[x].server,
+                                                    MEMCACHED_MEMORY_ALLOCATION_FAILURE,
+                                                    MEMCACHED_AT));
+        }
       }
+      total = 0;
+    }
+  }
+
+  int64_t now = connect_now();
+  while (total) {
+    int64_t wakeup = INT64_MAX;
+    nfds_t nfds = 0;
 
-      // A timeout here is treated as an error, we will not retry
-      if (rc == MEMCACHED_TIMEOUT) {
-        timeout_error_occured = true;
+    for (uint32_t x = 0; x < count; ++x) {
+      connect_race_st &race = races[x];
+
+      while (race.done == false and race.started < race.count
+             and (race.active == 0 or race.next_start <= now))
+      {
+        race_attempt(race, now);
+      }
+      if (race.done) {
+        continue;
+      }
+      if (race.active == 0) {
+        race_lost(race);
+        continue;
       }
-    } break;
 
-    case EISCONN:           // we are connected :-)
-      WATCHPOINT_ASSERT(0); // This is a programmer's error
+      if (race.started < race.count) {
+        wakeup = std::min(wakeup, race.next_start);
+      }
+      for (uint32_t y = 0; y < race.started; ++y) {
+        if (race.attempts[y].fd != INVALID_SOCKET) {
+          fds[nfds].fd = race.attempts[y].fd;
+          fds[nfds].events = POLLOUT;
+          fds[nfds].revents = 0;
+          attempts[nfds++] = &race.attempts[y];
+          wakeup = std::min(wakeup, race.attempts[y].expires);
+        }
+      }
+    }
+
+    if (nfds == 0) {
       break;
+    }
 
-    case EINTR: // Special case, we retry ai_addr
-      WATCHPOINT_ASSERT(server->fd != INVALID_SOCKET);
-      server->reset_socket();
-      continue;
+    int timeout = wakeup == INT64_MAX ? -1 : int(std::max(wakeup - now, int64_t(0)));
+    int active = poll(fds, nfds, timeout);
 
-    case ECONNREFUSED:
-      // Probably not running service
+    if (active == SOCKET_ERROR) {
+      int local_errno = get_socket_errno();
 
-    default:
-      memcached_set_errno(*server, local_error, MEMCACHED_AT);
-      break;
+      switch (local_errno) {
+#ifdef HAVE_ERESTART
+      case ERESTART:
+#endif
+      case EINTR:
+        now = connect_now();
+        continue;
+
+      default:
+        for (uint32_t x = 0; x < count; ++x) {
+          if (races[x].done == false) {
+            race_finish(races[x], memcached_set_errno(*races[x].server, local_errno, MEMCACHED_AT,
+                                                      memcached_literal_param("poll()")));
+          }
+        }
+        total = 0;
+        continue;
+      }
     }
 
-    WATCHPOINT_ASSERT(server->fd != INVALID_SOCKET);
-    server->reset_socket();
-    server->address_info_next = server->address_info_next->ai_next;
-  }
+    now = connect_now();
+    for (nfds_t x = 0; active and x < nfds; ++x) {
+      connect_attempt_st &attempt = *attempts[x];
+      connect_race_st &race = *attempt.race;
 
-  WATCHPOINT_ASSERT(server->fd == INVALID_SOCKET);
+      if (fds[x].revents == 0 or race.done) {
+        continue;
+      }
 
-  if (timeout_error_occured) {
-    server->reset_socket();
-  }
+      int err = 0;
+      socklen_t len = sizeof(err);
+      if (getsockopt(attempt.fd, SOL_SOCKET, SO_ERROR, (char *) &err, &len) == -1) {
+        err = get_socket_errno();
+      } else if (err == 0 and (fds[x].revents & POLLOUT) == 0) {
+        err = ECONNREFUSED;
+      }
 
-  WATCHPOINT_STRING("Never got a good file descriptor");
+      if (err) {
+        race_failed(race, attempt, err, now);
+      } else {
+        race_won(race, attempt);
+      }
+    }
 
-  if (memcached_has_current_error(*server)) {
-    return memcached_instance_error_return(server);
+    for (uint32_t x = 0; x < count; ++x) {
+      connect_race_st &race = races[x];
+
+      for (uint32_t y = 0; race.done == false and y < race.started; ++y) {
+        connect_attempt_st &attempt = race.attempts[y];
+
+        if (attempt.fd != INVALID_SOCKET and attempt.expires <= now) {
+          (void) closesocket(attempt.fd);
+          attempt.fd = INVALID_SOCKET;
+          race.active--;
+          race.next_start = now;
+          memcached_set_error(*race.server, MEMCACHED_TIMEOUT, MEMCACHED_AT,
+                              memcached_literal_param("time out"));
+        }
+      }
+    }
   }
 
-  if (timeout_error_occured and server->state < MEMCACHED_SERVER_STATE_IN_PROGRESS) {
-    return memcached_set_error(
-        *server, MEMCACHED_TIMEOUT, MEMCACHED_AT,
-        memcached_literal_param(
-            "if (timeout_error_occured and server->state < MEMCACHED_SERVER_STATE_IN_PROGRESS)"));
+  for (uint32_t x = 0; x < count; ++x) {
+    libmemcached_free(races[x].server->root, races[x].attempts);
+    races[x].attempts = NULL;
+  }
+  if (fds != fds_buffer) {
+    Memcached *memc = races[0].server->root;
+
+    libmemcached_free(memc, fds);
+    libmemcached_free(memc, attempts);
   }
+}
+
+static memcached_return_t network_connect(memcached_instance_st *server) {
+  connect_race_st race{};
 
-  return memcached_set_error(*server, MEMCACHED_CONNECTION_FAILURE,
-                             MEMCACHED_AT); /* The last error should be from connect() */
+  race.server = server;
+  network_race(&race, 1);
+
+  return race.rc;
 }
 
 /*
@@ -515,16 +730,7 @@ static memcached_return_t backoff_handling(memcached_instance_st *server, bool &
   return MEMCACHED_SUCCESS;
 }
 
-static memcached_return_t _memcached_connect(memcached_instance_st *server,
-                                             const bool set_last_disconnected) {
-  assert(server);
-  if (server->fd != INVALID_SOCKET) {
-    return MEMCACHED_SUCCESS;
-  }
-
-  LIBMEMCACHED_MEMCACHED_CONNECT_START();
-
-  bool in_timeout = false;
+static memcached_return_t connect_prepare(memcached_instance_st *server, bool &in_timeout) {
   memcached_return_t rc;
   if (memcached_failed(rc = backoff_handling(server, in_timeout))) {
     set_last_disconnected_host(server);
@@ -543,29 +749,24 @@ static memcached_return_t _memcached_connect(memcached_instance_st *server,
     server->type = MEMCACHED_CONNECTION_UNIX_SOCKET;
   }
 
-  /* We need to clean up the multi startup piece */
-  switch (server->type) {
-  case MEMCACHED_CONNECTION_UDP:
-  case MEMCACHED_CONNECTION_TCP:
-    rc = network_connect(server);
+  return memcached_io_buffers_init(server);
+}
 
+static memcached_return_t connect_finish(memcached_instance_st *server, memcached_return_t rc,
+                                         const bool in_timeout, const bool set_last_disconnected) {
 #if defined(LIBMEMCACHED_WITH_SASL_SUPPORT)
-    if (LIBMEMCACHED_WITH_SASL_SUPPORT) {
-      if (server->fd != INVALID_SOCKET and server->root->sasl.callbacks) {
-        rc = memcached_sasl_authenticate_connection(server);
-        if (memcached_failed(rc) and server->fd != INVALID_SOCKET) {
-          WATCHPOINT_ASSERT(server->fd != INVALID_SOCKET);
-          server->reset_socket();
-        }
+  if (LIBMEMCACHED_WITH_SASL_SUPPORT) {
+    if (server->type != MEMCACHED_CONNECTION_UNIX_SOCKET and server->fd != INVALID_SOCKET
+        and server->root->sasl.callbacks)
+    {
+      rc = memcached_sasl_authenticate_connection(server);
+      if (memcached_failed(rc) and server->fd != INVALID_SOCKET) {
+        WATCHPOINT_ASSERT(server->fd != INVALID_SOCKET);
+        server->reset_socket();
       }
     }
-#endif
-    break;
-
-  case MEMCACHED_CONNECTION_UNIX_SOCKET:
-    rc = unix_socket_connect(server);
-    break;
   }
+#endif
 
   if (memcached_success(rc)) {
     server->mark_server_as_clean();
@@ -595,6 +796,84 @@ static memcached_return_t _memcached_connect(memcached_instance_st *server,
   return rc;
 }
 
+static memcached_return_t _memcached_connect(memcached_instance_st *server,
+                                             const bool set_last_disconnected) {
+  assert(server);
+  if (server->fd != INVALID_SOCKET) {
+    return MEMCACHED_SUCCESS;
+  }
+
+  LIBMEMCACHED_MEMCACHED_CONNECT_START();
+
+  bool in_timeout = false;
+  memcached_return_t rc;
+  if (memcached_failed(rc = connect_prepare(server, in_timeout))) {
+    return rc;
+  }
+
+  /* We need to clean up the multi startup piece */
+  switch (server->type) {
+  case MEMCACHED_CONNECTION_UDP:
+  case MEMCACHED_CONNECTION_TCP:
+    rc = network_connect(server);
+    break;
+
+  case MEMCACHED_CONNECTION_UNIX_SOCKET:
+    rc = unix_socket_connect(server);
+    break;
+  }
+
+  return connect_finish(server, rc, in_timeout, set_last_disconnected);
+}
+
 memcached_return_t memcached_connect(memcached_instance_st *server) {
   return _memcached_connect(server, true);
 }
+
+memcached_return_t memcached_connect_all(memcached_st *shell) {
+  Memcached *memc = memcached2Memcached(shell);
+  memcached_return_t rc;
+  if (memcached_failed(rc = initialize_query(memc, false))) {
+    return rc;
+  }
+
+  connect_race_st *races =
+      libmemcached_xcalloc(memc, memcached_server_count(memc), connect_race_st);
+  if (races == NULL) {
+    return memcached_set_error(*memc, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  bool some_errors = false;
+  uint32_t count = 0;
+  for (uint32_t x = 0; x < memcached_server_count(memc); ++x) {
+    memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+
+    if (instance->fd != INVALID_SOCKET) {
+      continue;
+    }
+
+    LIBMEMCACHED_MEMCACHED_CONNECT_START();
+
+    bool in_timeout = false;
+    if (memcached_failed(connect_prepare(instance, in_timeout))) {
+      some_errors = true;
+    } else if (instance->type == MEMCACHED_CONNECTION_UNIX_SOCKET) {
+      rc = unix_socket_connect(instance);
+      some_errors |= memcached_failed(connect_finish(instance, rc, in_timeout, true));
+    } else {
+      races[count].server = instance;
+      races[count++].in_timeout = in_timeout;
+    }
+  }
+
+  if (count) {
+    network_race(races, count);
+  }
+  for (uint32_t x = 0; x < count; ++x) {
+    rc = connect_finish(races[x].server, races[x].rc, races[x].in_timeout, true);
+    some_errors |= memcached_failed(rc);
+  }
+  libmemcached_free(memc, races);
+
+  return some_errors ? MEMCACHED_SOME_ERRORS : MEMCACHED_SUCCESS;
+}
@@ -20,3 +20,63 @@ struct memcached_continuum_item_st {
   uint32_t index;
   uint32_t value;
 };
+
+/*
+  The points of a server in ascending order, with the position they were generated at,
+  which update_continuum() caches per instance, so that it only hashes the points of new
+  servers, and filters the cached ones when a server's share of points changes.
+*/
+struct memcached_continuum_point_st {
+  uint32_t value;
+  uint32_t rank;
+};
+
+struct memcached_continuum_points_st {
+  uint32_t mode;
+  hashkit_hash_fn function;
+  void *context;
+  uint32_t count;
+  uint32_t size;
+  struct memcached_continuum_point_st points[];
+};
+
+/*
+  The sorted continuum in Eytzinger (breadth first) order, rebuilt by update_continuum(),
+  so that the first levels of the search share a few cache lines, and the next ones can
+  be prefetched. keys and servers are 1-based, servers[0] is the server of the first
+  point, where keys after the last point wrap around to.
+*/
+struct memcached_continuum_search_st {
+  uint32_t count;
+  uint32_t *keys;
+  uint32_t *servers;
+  char memory[];
+};
+
+/* The server of the first point not less than hash, same as a binary search */
+static inline uint32_t memcached_continuum_search(const struct memcached_continuum_search_st *search,
+                                                  uint32_t hash) {
+  const uint32_t *keys = search->keys;
+  uint32_t count = search->count;
+  uint32_t k = 1;
+
+  while (k <= count) {
+    /* the 16 descendants four levels down share a cache line */
+#if defined(__GNUC__)
+    __builtin_prefetch(keys + 16 * k);
+#endif
+    k = 2 * k + (keys[k] < hash);
+  }
+
+  /* undo the right turns after the last left one, which was at the point found */
+#if defined(__GNUC__)
+  k >>= __builtin_ffs(~k);
+#else
+  while (k & 1) {
+    k >>= 1;
+  }
+  k >>= 1;
+#endif
+
+  return search->servers[k];
+}
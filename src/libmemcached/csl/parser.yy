@@ -155,6 +155,7 @@ inline void __config_error(Context *context, yyscan_t *scanner, const char *erro
 /* Pool */
 %token POOL_MIN
 %token POOL_MAX
+%token POOL_THREAD_CACHE
 
 /* Hash types */
 %token MD5
@@ -166,11 +167,17 @@ inline void __config_error(Context *context, yyscan_t *scanner, const char *erro
 %token HSIEH
 %token MURMUR
 %token JENKINS
+%token XXH3
+%token WYHASH
 
 /* Distributions */
 %token CONSISTENT
 %token MODULA
 %token RANDOM
+%token JUMP
+%token RENDEZVOUS
+%token RENDEZVOUS_SKELETON
+%token MAGLEV
 
 /* Boolean values */
 %token <boolean> CSL_TRUE
@@ -281,6 +288,10 @@ expression:
           {
             context->memc->configure.max_pool_size= uint32_t($2);
           }
+        | POOL_THREAD_CACHE
+          {
+            context->memc->configure.pool_thread_cache= true;
+          }
         | behaviors
         ;
 
@@ -506,6 +517,14 @@ hash:
           {
             $$= MEMCACHED_HASH_JENKINS;
           }
+        | XXH3
+          {
+            $$= MEMCACHED_HASH_XXH3;
+          }
+        | WYHASH
+          {
+            $$= MEMCACHED_HASH_WYHASH;
+          }
         ;
 
 string:
@@ -532,6 +551,22 @@ distribution:
           {
             $$= MEMCACHED_DISTRIBUTION_RANDOM;
           }
+        | JUMP
+          {
+            $$= MEMCACHED_DISTRIBUTION_JUMP;
+          }
+        | RENDEZVOUS
+          {
+            $$= MEMCACHED_DISTRIBUTION_RENDEZVOUS;
+          }
+        | RENDEZVOUS_SKELETON
+          {
+            $$= MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON;
+          }
+        | MAGLEV
+          {
+            $$= MEMCACHED_DISTRIBUTION_MAGLEV;
+          }
         ;
 
 %% 
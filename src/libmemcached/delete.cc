@@ -36,14 +36,20 @@ static inline memcached_return_t ascii_delete(memcached_instance_st *instance, u
   return memcached_vdo(instance, vector, 6, is_buffering ? false : true);
 }
 
-static inline memcached_return_t binary_delete(memcached_instance_st *instance, uint32_t server_key,
+static inline memcached_return_t binary_delete(memcached_instance_st *instance,
+                                               const char *group_key, const size_t group_key_length,
                                                const char *key, const size_t key_length,
-                                               const bool reply, const bool is_buffering) {
+                                               const bool reply, const bool is_buffering,
+                                               const uint32_t opaque = 0) {
   protocol_binary_request_delete request = {};
 
   bool should_flush = is_buffering ? false : true;
 
   initialize_binary_request(instance, request.message.header);
+  if (opaque) {
+    /* identifies the response of a quiet request, see memcached_pipeline() */
+    request.message.header.request.opaque = htonl(opaque);
+  }
 
   if (reply) {
     request.message.header.request.opcode = PROTOCOL_BINARY_CMD_DELETE;
@@ -65,20 +71,23 @@ static inline memcached_return_t binary_delete(memcached_instance_st *instance,
   memcached_return_t rc = memcached_vdo(instance, vector, 4, should_flush);
 
   if (memcached_has_replicas(instance)) {
+    Memcached *ptr = instance->root;
     request.message.header.request.opcode = PROTOCOL_BINARY_CMD_DELETEQ;
 
-    for (uint32_t x = 0; x < memcached_has_replicas(instance); ++x) {
-      ++server_key;
-
-      if (server_key == memcached_server_count(instance->root)) {
-        server_key = 0;
-      }
+    /* the replicas memcached_send_binary() stored the key on, best effort like those */
+    uint32_t *server_keys = libmemcached_xvalloc(ptr, ptr->number_of_replicas + 1, uint32_t);
+    if (server_keys) {
+      uint32_t count = memcached_generate_replicas_with_redistribution(
+          ptr, group_key, group_key_length, server_keys, ptr->number_of_replicas + 1);
 
-      memcached_instance_st *replica = memcached_instance_fetch(instance->root, server_key);
+      for (uint32_t x = 1; x < count; ++x) {
+        memcached_instance_st *replica = memcached_instance_fetch(ptr, server_keys[x]);
 
-      if (memcached_success(memcached_vdo(replica, vector, 4, should_flush))) {
-        memcached_server_response_decrement(replica);
+        if (memcached_success(memcached_vdo(replica, vector, 4, should_flush))) {
+          memcached_server_response_decrement(replica);
+        }
       }
+      libmemcached_free(ptr, server_keys);
     }
   }
 
@@ -131,7 +140,8 @@ memcached_return_t memcached_delete_by_key(memcached_st *shell, const char *grou
   }
 
   if (memcached_is_binary(memc)) {
-    rc = binary_delete(instance, server_key, key, key_length, is_replying, is_buffering);
+    rc = binary_delete(instance, group_key, group_key_length, key, key_length, is_replying,
+                       is_buffering);
   } else {
     rc = ascii_delete(instance, server_key, key, key_length, is_replying, is_buffering);
   }
@@ -156,3 +166,106 @@ memcached_return_t memcached_delete_by_key(memcached_st *shell, const char *grou
   LIBMEMCACHED_MEMCACHED_DELETE_END();
   return rc;
 }
+
+struct memcached_mdelete_st {
+  const char *group_key;
+  size_t group_key_length;
+  const char *const *keys;
+  const size_t *key_length;
+};
+
+static memcached_return_t mdelete_send(Memcached *memc, memcached_instance_st *instance,
+                                       uint32_t server_key, size_t n, void *context) {
+  memcached_mdelete_st *mdelete = static_cast<memcached_mdelete_st *>(context);
+  memcached_return_t rc;
+
+  if (memcached_is_binary(memc)) {
+    /* replicas are routed like memcached_delete_by_key() with the group key */
+    bool by_group = mdelete->group_key_length > 0;
+    rc = binary_delete(instance, by_group ? mdelete->group_key : mdelete->keys[n],
+                       by_group ? mdelete->group_key_length : mdelete->key_length[n],
+                       mdelete->keys[n], mdelete->key_length[n], false, true, uint32_t(n + 1));
+  } else {
+    rc = ascii_delete(instance, server_key, mdelete->keys[n], mdelete->key_length[n],
+                      memcached_is_replying(memc), true);
+  }
+
+  if (memcached_success(rc) and (memcached_is_binary(memc) or memcached_is_replying(memc))) {
+    return MEMCACHED_BUFFERED;
+  }
+
+  return rc;
+}
+
+memcached_return_t memcached_mdelete(memcached_st *shell, const char *const *keys,
+                                     const size_t *key_length, size_t number_of_keys,
+                                     memcached_return_t *results) {
+  return memcached_mdelete_by_key(shell, NULL, 0, keys, key_length, number_of_keys, results);
+}
+
+memcached_return_t memcached_mdelete_by_key(memcached_st *shell, const char *group_key,
+                                            size_t group_key_length, const char *const *keys,
+                                            const size_t *key_length, size_t number_of_keys,
+                                            memcached_return_t *results) {
+  Memcached *memc = memcached2Memcached(shell);
+
+  memcached_return_t rc;
+  if (memcached_fatal(rc = initialize_query(memc, true))) {
+    return rc;
+  }
+
+  if (number_of_keys == 0 or keys == NULL or key_length == NULL) {
+    return memcached_set_error(*memc, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT);
+  }
+
+  if (memc->delete_trigger and memcached_is_replying(memc) == false) {
+    return memcached_set_error(
+        *memc, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT,
+        memcached_literal_param(
+            "Delete triggers cannot be used if MEMCACHED_BEHAVIOR_NOREPLY is set"));
+  }
+
+  /* there are no responses to pipeline over UDP */
+  if (memcached_is_udp(memc)) {
+    bool failed = false;
+
+    for (size_t x = 0; x < number_of_keys; ++x) {
+      rc = memcached_delete_by_key(memc, group_key_length ? group_key : keys[x],
+                                   group_key_length ? group_key_length : key_length[x], keys[x],
+                                   key_length[x], 0);
+      if (results) {
+        results[x] = rc;
+      }
+      failed = failed or memcached_failed(rc);
+    }
+
+    return failed ? MEMCACHED_SOME_ERRORS : MEMCACHED_SUCCESS;
+  }
+
+  /* the delete trigger needs the result of each key */
+  memcached_return_t *rcs = results;
+  if (memc->delete_trigger and results == NULL
+      and (rcs = libmemcached_xvalloc(memc, number_of_keys, memcached_return_t)) == NULL)
+  {
+    return memcached_set_error(*memc, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  memcached_mdelete_st mdelete = {group_key, group_key_length, keys, key_length};
+  rc = memcached_pipeline(memc, group_key, group_key_length, keys, key_length, number_of_keys,
+                          rcs, PROTOCOL_BINARY_CMD_DELETEQ,
+                          memcached_is_binary(memc) or memcached_is_replying(memc), mdelete_send,
+                          &mdelete);
+
+  if (memc->delete_trigger) {
+    for (size_t x = 0; x < number_of_keys; ++x) {
+      if (rcs[x] == MEMCACHED_SUCCESS) {
+        memc->delete_trigger(memc, keys[x], key_length[x]);
+      }
+    }
+    if (rcs != results) {
+      libmemcached_free(memc, rcs);
+    }
+  }
+
+  return rc;
+}
@@ -235,3 +235,69 @@ memcached_return_t memcached_fetch_execute(memcached_st *shell, memcached_execut
 
   return rc;
 }
+
+memcached_return_t memcached_fetch_view(memcached_st *shell, memcached_fetch_view_fn callback,
+                                        void *context) {
+  Memcached *ptr = memcached2Memcached(shell);
+  if (ptr == NULL or callback == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  if (memcached_is_udp(ptr)) {
+    return memcached_set_error(*ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT);
+  }
+
+  // Only keys, flags and cas end up in here, values are handed out in place
+  memcached_result_st result_buffer;
+  memcached_result_st *result = memcached_result_create(ptr, &result_buffer);
+
+  memcached_return_t rc = MEMCACHED_MAXIMUM_RETURN; // We use this to see if we ever go into the loop
+  memcached_instance_st *server;
+  memcached_return_t read_ret = MEMCACHED_SUCCESS;
+  bool connection_failures = false;
+  bool timeouts = false;
+  bool some_errors = false;
+  while ((server = memcached_io_get_readable_server(ptr, read_ret))) {
+    char buffer[MEMCACHED_DEFAULT_COMMAND_SIZE];
+    memcached_item_view_st view;
+    rc = memcached_response(server, buffer, sizeof(buffer), result, &view);
+
+    if (rc == MEMCACHED_IN_PROGRESS) {
+      continue;
+    } else if (rc == MEMCACHED_CONNECTION_FAILURE) {
+      connection_failures = true;
+      continue;
+    } else if (rc == MEMCACHED_TIMEOUT) {
+      timeouts = true;
+    } else if (rc == MEMCACHED_SUCCESS) {
+      result->count++;
+
+      memcached_return_t ret = callback(ptr, &view, context);
+      if (memcached_failed(ret)) {
+        some_errors = true;
+        memcached_set_error(*ptr, ret, MEMCACHED_AT);
+      }
+    } else if (rc == MEMCACHED_END) {
+      memcached_server_response_reset(server);
+    } else if (rc != MEMCACHED_NOTFOUND) {
+      break;
+    }
+  }
+
+  uint64_t count = result->count;
+  memcached_result_free(result);
+
+  if (some_errors) {
+    return MEMCACHED_SOME_ERRORS;
+  } else if (connection_failures) {
+    return MEMCACHED_CONNECTION_FAILURE;
+  } else if (timeouts) {
+    return MEMCACHED_TIMEOUT;
+  } else if (rc == MEMCACHED_MAXIMUM_RETURN or rc == MEMCACHED_NOTFOUND or rc == MEMCACHED_END
+             or rc == MEMCACHED_SUCCESS)
+  {
+    return count ? MEMCACHED_SUCCESS : MEMCACHED_NOTFOUND;
+  }
+
+  return rc;
+}
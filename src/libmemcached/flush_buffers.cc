@@ -19,6 +19,7 @@ memcached_return_t memcached_flush_buffers(memcached_st *shell) {
   Memcached *memc = memcached2Memcached(shell);
   if (memc) {
     memcached_return_t ret = MEMCACHED_SUCCESS;
+    const bool batch = memcached_io_ring_enabled(memc);
 
     for (uint32_t x = 0; x < memcached_server_count(memc); ++x) {
       memcached_instance_st *instance = memcached_instance_fetch(memc, x);
@@ -30,12 +31,16 @@ memcached_return_t memcached_flush_buffers(memcached_st *shell) {
           return ret;
         }
 
-        if (memcached_io_write(instance) == false) {
+        if (batch == false and memcached_io_write(instance) == false) {
           ret = MEMCACHED_SOME_ERRORS;
         }
       }
     }
 
+    if (batch) {
+      ret = memcached_io_ring_flush(memc);
+    }
+
     return ret;
   }
 
@@ -16,6 +16,8 @@
 #include "libmemcached/common.h"
 #include "p9y/random.hpp"
 
+#include <algorithm>
+
 char *memcached_get(memcached_st *ptr, const char *key, size_t key_length, size_t *value_length,
                     uint32_t *flags, memcached_return_t *error) {
   return memcached_get_by_key(ptr, NULL, 0, key, key_length, value_length, flags, error);
@@ -129,6 +131,7 @@ memcached_return_t memcached_mget(memcached_st *ptr, const char *const *keys,
 }
 
 static memcached_return_t binary_mget_by_key(memcached_st *ptr, const uint32_t master_server_key,
+                                             const char *group_key, size_t group_key_length,
                                              const bool is_group_key_set, const char *const *keys,
                                              const size_t *key_length, const size_t number_of_keys,
                                              const bool mget_mode);
@@ -194,8 +197,8 @@ static memcached_return_t mget_by_key_real(memcached_st *ptr, const char *group_
   }
 
   if (memcached_is_binary(ptr)) {
-    return binary_mget_by_key(ptr, master_server_key, is_group_key_set, keys, key_length,
-                              number_of_keys, mget_mode);
+    return binary_mget_by_key(ptr, master_server_key, group_key, group_key_length,
+                              is_group_key_set, keys, key_length, number_of_keys, mget_mode);
   }
 
   if (ptr->flags.support_cas) {
@@ -209,13 +212,22 @@ static memcached_return_t mget_by_key_real(memcached_st *ptr, const char *group_
   */
   WATCHPOINT_ASSERT(rc == MEMCACHED_SUCCESS);
   size_t hosts_connected = 0;
+  uint32_t server_keys[MEMCACHED_HASH_BATCH];
+  if (is_group_key_set == false) {
+    memcached_autoeject(ptr);
+  }
   for (uint32_t x = 0; x < number_of_keys; x++) {
     uint32_t server_key;
 
     if (is_group_key_set) {
       server_key = master_server_key;
     } else {
-      server_key = memcached_generate_hash_with_redistribution(ptr, keys[x], key_length[x]);
+      if (x % MEMCACHED_HASH_BATCH == 0) {
+        memcached_dispatch_hash_batch(
+            ptr, keys + x, key_length + x,
+            std::min(number_of_keys - x, size_t(MEMCACHED_HASH_BATCH)), server_keys);
+      }
+      server_key = server_keys[x % MEMCACHED_HASH_BATCH];
     }
 
     memcached_instance_st *instance = memcached_instance_fetch(ptr, server_key);
@@ -267,12 +279,13 @@ static memcached_return_t mget_by_key_real(memcached_st *ptr, const char *group_
     Should we muddle on if some servers are dead?
   */
   bool success_happened = false;
+  const bool batch = memcached_io_ring_enabled(ptr);
   for (uint32_t x = 0; x < memcached_server_count(ptr); x++) {
     memcached_instance_st *instance = memcached_instance_fetch(ptr, x);
 
     if (instance->response_count()) {
       /* We need to do something about non-connnected hosts in the future */
-      if ((memcached_io_write(instance, "\r\n", 2, true)) == -1) {
+      if ((memcached_io_write(instance, "\r\n", 2, batch == false)) == -1) {
         failures_occured_in_sending = true;
       } else {
         success_happened = true;
@@ -280,6 +293,10 @@ static memcached_return_t mget_by_key_real(memcached_st *ptr, const char *group_
     }
   }
 
+  if (batch and memcached_failed(memcached_io_ring_flush(ptr))) {
+    failures_occured_in_sending = true;
+  }
+
   LIBMEMCACHED_MEMCACHED_MGET_END();
 
   if (failures_occured_in_sending and success_happened) {
@@ -356,13 +373,22 @@ static memcached_return_t simple_binary_mget(memcached_st *ptr, const uint32_t m
     If a server fails we warn about errors and start all over with sending keys
     to the server.
   */
+  uint32_t server_keys[MEMCACHED_HASH_BATCH];
+  if (is_group_key_set == false) {
+    memcached_autoeject(ptr);
+  }
   for (uint32_t x = 0; x < number_of_keys; ++x) {
     uint32_t server_key;
 
     if (is_group_key_set) {
       server_key = master_server_key;
     } else {
-      server_key = memcached_generate_hash_with_redistribution(ptr, keys[x], key_length[x]);
+      if (x % MEMCACHED_HASH_BATCH == 0) {
+        memcached_dispatch_hash_batch(
+            ptr, keys + x, key_length + x,
+            std::min(number_of_keys - x, size_t(MEMCACHED_HASH_BATCH)), server_keys);
+      }
+      server_key = server_keys[x % MEMCACHED_HASH_BATCH];
     }
 
     memcached_instance_st *instance = memcached_instance_fetch(ptr, server_key);
@@ -433,13 +459,15 @@ static memcached_return_t simple_binary_mget(memcached_st *ptr, const uint32_t m
     request.message.header.request.opcode = PROTOCOL_BINARY_CMD_NOOP;
     request.message.header.request.datatype = PROTOCOL_BINARY_RAW_BYTES;
 
+    const bool batch = memcached_io_ring_enabled(ptr);
     for (uint32_t x = 0; x < memcached_server_count(ptr); ++x) {
       memcached_instance_st *instance = memcached_instance_fetch(ptr, x);
 
       if (instance->response_count()) {
         initialize_binary_request(instance, request.message.header);
-        if ((memcached_io_write(instance) == false)
-            or (memcached_io_write(instance, request.bytes, sizeof(request.bytes), true) == -1))
+        if ((batch == false and memcached_io_write(instance) == false)
+            or (memcached_io_write(instance, request.bytes, sizeof(request.bytes), batch == false)
+                == -1))
         {
           memcached_instance_response_reset(instance);
           memcached_io_reset(instance);
@@ -447,44 +475,49 @@ static memcached_return_t simple_binary_mget(memcached_st *ptr, const uint32_t m
         }
       }
     }
+
+    if (batch and memcached_failed(memcached_io_ring_flush(ptr))) {
+      rc = MEMCACHED_SOME_ERRORS;
+    }
   }
 
   return rc;
 }
 
+/*
+  hash holds number_of_replicas + 1 server keys per key, primary first, padded with
+  memcached_server_count(), see memcached_generate_replicas_batch().
+*/
 static memcached_return_t replication_binary_mget(memcached_st *ptr, uint32_t *hash,
                                                   bool *dead_servers, const char *const *keys,
                                                   const size_t *key_length,
                                                   const size_t number_of_keys) {
   memcached_return_t rc = MEMCACHED_NOTFOUND;
   uint32_t start = 0;
+  uint32_t stride = ptr->number_of_replicas + 1;
   uint64_t randomize_read = memcached_behavior_get(ptr, MEMCACHED_BEHAVIOR_RANDOMIZE_REPLICA_READ);
 
   if (randomize_read) {
-    start = (uint32_t) random() % (uint32_t)(ptr->number_of_replicas + 1);
+    start = (uint32_t) random() % stride;
   }
 
   /* Loop for each replica */
-  for (uint32_t replica = 0; replica <= ptr->number_of_replicas; ++replica) {
+  for (uint32_t replica = 0; replica < stride; ++replica) {
     bool success = true;
 
     for (uint32_t x = 0; x < number_of_keys; ++x) {
-      if (hash[x] == memcached_server_count(ptr)) {
+      if (hash[x * stride] == memcached_server_count(ptr)) {
         continue; /* Already successfully sent */
       }
 
-      uint32_t server = hash[x] + replica;
+      uint32_t server = hash[x * stride + replica];
 
       /* In case of randomized reads */
-      if (randomize_read and ((server + start) <= (hash[x] + ptr->number_of_replicas))) {
-        server += start;
-      }
-
-      while (server >= memcached_server_count(ptr)) {
-        server -= memcached_server_count(ptr);
+      if (randomize_read and replica + start < stride) {
+        server = hash[x * stride + replica + start];
       }
 
-      if (dead_servers[server]) {
+      if (server == memcached_server_count(ptr) or dead_servers[server]) {
         continue;
       }
 
@@ -533,7 +566,7 @@ static memcached_return_t replication_binary_mget(memcached_st *ptr, uint32_t *h
       }
 
       memcached_server_response_increment(instance);
-      hash[x] = memcached_server_count(ptr);
+      hash[x * stride] = memcached_server_count(ptr);
     }
 
     if (success) {
@@ -545,6 +578,7 @@ static memcached_return_t replication_binary_mget(memcached_st *ptr, uint32_t *h
 }
 
 static memcached_return_t binary_mget_by_key(memcached_st *ptr, const uint32_t master_server_key,
+                                             const char *group_key, size_t group_key_length,
                                              bool is_group_key_set, const char *const *keys,
                                              const size_t *key_length, const size_t number_of_keys,
                                              const bool mget_mode) {
@@ -553,7 +587,8 @@ static memcached_return_t binary_mget_by_key(memcached_st *ptr, const uint32_t m
                               number_of_keys, mget_mode);
   }
 
-  uint32_t *hash = libmemcached_xvalloc(ptr, number_of_keys, uint32_t);
+  uint32_t stride = ptr->number_of_replicas + 1;
+  uint32_t *hash = libmemcached_xvalloc(ptr, number_of_keys * stride, uint32_t);
   bool *dead_servers = libmemcached_xcalloc(ptr, memcached_server_count(ptr), bool);
 
   if (hash == NULL or dead_servers == NULL) {
@@ -563,13 +598,12 @@ static memcached_return_t binary_mget_by_key(memcached_st *ptr, const uint32_t m
   }
 
   if (is_group_key_set) {
-    for (size_t x = 0; x < number_of_keys; x++) {
-      hash[x] = master_server_key;
+    memcached_generate_replicas_batch(ptr, &group_key, &group_key_length, 1, hash, stride);
+    for (size_t x = 1; x < number_of_keys; x++) {
+      memcpy(hash + x * stride, hash, sizeof(*hash) * stride);
     }
   } else {
-    for (size_t x = 0; x < number_of_keys; x++) {
-      hash[x] = memcached_generate_hash_with_redistribution(ptr, keys[x], key_length[x]);
-    }
+    memcached_generate_replicas_batch(ptr, keys, key_length, number_of_keys, hash, stride);
   }
 
   memcached_return_t rc =
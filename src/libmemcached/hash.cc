@@ -18,6 +18,8 @@
 #include "p9y/gettimeofday.hpp"
 #include "p9y/random.hpp"
 
+#include <algorithm>
+
 uint32_t memcached_generate_hash_value(const char *key, size_t key_length,
                                        memcached_hash_t hash_algorithm) {
   return libhashkit_digest(key, key_length, (hashkit_hash_algorithm_t) hash_algorithm);
@@ -32,25 +34,9 @@ static uint32_t dispatch_host(const Memcached *ptr, uint32_t hash) {
   case MEMCACHED_DISTRIBUTION_CONSISTENT:
   case MEMCACHED_DISTRIBUTION_CONSISTENT_WEIGHTED:
   case MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA:
-  case MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA_SPY: {
-    uint32_t num = ptr->ketama.continuum_points_counter;
-    WATCHPOINT_ASSERT(ptr->ketama.continuum);
-
-    memcached_continuum_item_st *begin, *end, *left, *right, *middle;
-    begin = left = ptr->ketama.continuum;
-    end = right = ptr->ketama.continuum + num;
-
-    while (left < right) {
-      middle = left + (right - left) / 2;
-      if (middle->value < hash)
-        left = middle + 1;
-      else
-        right = middle;
-    }
-    if (right == end)
-      right = begin;
-    return right->index;
-  }
+  case MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA_SPY:
+    WATCHPOINT_ASSERT(ptr->ketama.continuum_search);
+    return memcached_continuum_search(ptr->ketama.continuum_search, hash);
   case MEMCACHED_DISTRIBUTION_MODULA:
     return hash % memcached_server_count(ptr);
   case MEMCACHED_DISTRIBUTION_RANDOM:
@@ -58,6 +44,13 @@ static uint32_t dispatch_host(const Memcached *ptr, uint32_t hash) {
   case MEMCACHED_DISTRIBUTION_VIRTUAL_BUCKET: {
     return memcached_virtual_bucket_get(ptr, hash);
   }
+  case MEMCACHED_DISTRIBUTION_JUMP:
+    return memcached_jump_consistent_hash(hash, memcached_server_count(ptr));
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS:
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON:
+    return memcached_rendezvous_get(ptr, hash);
+  case MEMCACHED_DISTRIBUTION_MAGLEV:
+    return memcached_maglev_get(ptr, hash);
   default:
   case MEMCACHED_DISTRIBUTION_CONSISTENT_MAX:
     WATCHPOINT_ASSERT(0); /* We have added a distribution without extending the logic */
@@ -66,6 +59,35 @@ static uint32_t dispatch_host(const Memcached *ptr, uint32_t hash) {
   /* NOTREACHED */
 }
 
+/*
+  Replicas are stored on the servers ranked next by rendezvous hashing, else on the
+  servers following the primary one in the server list.
+*/
+static uint32_t dispatch_replicas(const Memcached *ptr, uint32_t hash, uint32_t *server_keys,
+                                  uint32_t count) {
+  switch (ptr->distribution) {
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS:
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON:
+    if (uint32_t found = memcached_rendezvous_rank(ptr, hash, server_keys, count)) {
+      return found;
+    }
+    break;
+  default:
+    break;
+  }
+
+  uint32_t server_key = dispatch_host(ptr, hash);
+
+  if (count > memcached_server_count(ptr)) {
+    count = memcached_server_count(ptr);
+  }
+  for (uint32_t x = 0; x < count; ++x) {
+    server_keys[x] = (server_key + x) % memcached_server_count(ptr);
+  }
+
+  return count;
+}
+
 /*
   One version is public and will not modify the distribution hash, the other will.
 */
@@ -92,6 +114,55 @@ static inline uint32_t _generate_hash_wrapper(const Memcached *ptr, const char *
   }
 }
 
+/*
+  The batched _generate_hash_wrapper(), hashing the namespace only once.
+*/
+static void _generate_hash_batch(const Memcached *ptr, const char *const *keys,
+                                 const size_t *key_length, size_t number_of_keys,
+                                 uint32_t *hashes) {
+  WATCHPOINT_ASSERT(memcached_server_count(ptr));
+
+  if (memcached_server_count(ptr) == 1) {
+    std::fill(hashes, hashes + number_of_keys, 0);
+    return;
+  }
+
+  const char *prefix = NULL;
+  size_t prefix_length = 0;
+  if (ptr->flags.hash_with_namespace) {
+    prefix = memcached_array_string(ptr->_namespace);
+    prefix_length = memcached_array_size(ptr->_namespace);
+  }
+
+  if (hashkit_digest_batch(&ptr->hashkit, prefix, prefix_length, keys, key_length,
+                           number_of_keys, hashes)
+      == false)
+  {
+    for (size_t x = 0; x < number_of_keys; ++x) {
+      hashes[x] = _generate_hash_wrapper(ptr, keys[x], key_length[x]);
+    }
+    return;
+  }
+
+  if (prefix_length) {
+    for (size_t x = 0; x < number_of_keys; ++x) {
+      if (prefix_length + key_length[x] > MEMCACHED_MAX_KEY - 1) {
+        hashes[x] = 0;
+      }
+    }
+  }
+}
+
+void memcached_dispatch_hash_batch(const Memcached *ptr, const char *const *keys,
+                                   const size_t *key_length, size_t number_of_keys,
+                                   uint32_t *server_keys) {
+  _generate_hash_batch(ptr, keys, key_length, number_of_keys, server_keys);
+
+  for (size_t x = 0; x < number_of_keys; ++x) {
+    server_keys[x] = dispatch_host(ptr, server_keys[x]);
+  }
+}
+
 static inline void _regen_for_auto_eject(Memcached *ptr) {
   if (_is_auto_eject_host(ptr) && ptr->ketama.next_distribution_rebuild) {
     struct timeval now;
@@ -124,6 +195,72 @@ uint32_t memcached_generate_hash(const memcached_st *shell, const char *key, siz
   return UINT32_MAX;
 }
 
+memcached_return_t memcached_generate_hash_batch(memcached_st *shell, const char *const *keys,
+                                                 const size_t *key_length,
+                                                 size_t number_of_keys, uint32_t *server_keys) {
+  Memcached *ptr = memcached2Memcached(shell);
+  if (ptr == NULL or keys == NULL or key_length == NULL or server_keys == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+  if (memcached_server_count(ptr) == 0) {
+    return memcached_set_error(*ptr, MEMCACHED_NO_SERVERS, MEMCACHED_AT);
+  }
+
+  _regen_for_auto_eject(ptr);
+
+  for (size_t x = 0; x < number_of_keys; x += MEMCACHED_HASH_BATCH) {
+    memcached_dispatch_hash_batch(ptr, keys + x, key_length + x,
+                                  std::min(number_of_keys - x, size_t(MEMCACHED_HASH_BATCH)),
+                                  server_keys + x);
+  }
+
+  return MEMCACHED_SUCCESS;
+}
+
+uint32_t memcached_generate_replicas_with_redistribution(memcached_st *ptr, const char *key,
+                                                         size_t key_length, uint32_t *server_keys,
+                                                         uint32_t count) {
+  uint32_t hash = _generate_hash_wrapper(ptr, key, key_length);
+
+  _regen_for_auto_eject(ptr);
+
+  return dispatch_replicas(ptr, hash, server_keys, count);
+}
+
+void memcached_generate_replicas_batch(memcached_st *ptr, const char *const *keys,
+                                       const size_t *key_length, size_t number_of_keys,
+                                       uint32_t *server_keys, uint32_t stride) {
+  uint32_t hash[MEMCACHED_HASH_BATCH];
+
+  _regen_for_auto_eject(ptr);
+
+  for (size_t x = 0; x < number_of_keys; ++x) {
+    uint32_t *replicas = server_keys + x * stride;
+
+    if (x % MEMCACHED_HASH_BATCH == 0) {
+      _generate_hash_batch(ptr, keys + x, key_length + x,
+                           std::min(number_of_keys - x, size_t(MEMCACHED_HASH_BATCH)), hash);
+    }
+
+    uint32_t count = dispatch_replicas(ptr, hash[x % MEMCACHED_HASH_BATCH], replicas, stride);
+    for (; count < stride; ++count) {
+      replicas[count] = memcached_server_count(ptr);
+    }
+  }
+}
+
+uint32_t memcached_generate_hash_replicas(const memcached_st *shell, const char *key,
+                                          size_t key_length, uint32_t *server_keys,
+                                          uint32_t count) {
+  const Memcached *ptr = memcached2Memcached(shell);
+  if (ptr and server_keys and memcached_server_count(ptr)) {
+    return dispatch_replicas(ptr, _generate_hash_wrapper(ptr, key, key_length), server_keys,
+                             count);
+  }
+
+  return 0;
+}
+
 const hashkit_st *memcached_get_hashkit(const memcached_st *shell) {
   const Memcached *ptr = memcached2Memcached(shell);
   if (ptr) {
@@ -15,5 +15,42 @@
 
 #pragma once
 
+/* The number of keys hashed at a time by the batched routing functions */
+#define MEMCACHED_HASH_BATCH 64
+
+/*
+  Jump consistent hash, John Lamping and Eric Veach, https://arxiv.org/abs/1406.2294
+  Moves only 1/n of the keys when the n-th bucket is added, needs no state and runs in
+  O(log n).
+*/
+static inline uint32_t memcached_jump_consistent_hash(uint64_t key, const uint32_t buckets) {
+  int64_t b = -1, j = 0;
+
+  while (j < int64_t(buckets)) {
+    b = j;
+    key = key * 2862933555777941757ULL + 1;
+    j = int64_t(double(b + 1) * (double(1LL << 31) / double((key >> 33) + 1)));
+  }
+
+  return uint32_t(b);
+}
+
 uint32_t memcached_generate_hash_with_redistribution(memcached_st *ptr, const char *key,
                                                      size_t key_length);
+
+uint32_t memcached_generate_replicas_with_redistribution(memcached_st *ptr, const char *key,
+                                                         size_t key_length, uint32_t *server_keys,
+                                                         uint32_t count);
+
+/* Routes at most MEMCACHED_HASH_BATCH keys, without checking for an auto eject rebuild */
+void memcached_dispatch_hash_batch(const memcached_st *ptr, const char *const *keys,
+                                   const size_t *key_length, size_t number_of_keys,
+                                   uint32_t *server_keys);
+
+/*
+  Fills number_of_keys rows of stride server keys, see
+  memcached_generate_replicas_with_redistribution(), padded with memcached_server_count().
+*/
+void memcached_generate_replicas_batch(memcached_st *ptr, const char *const *keys,
+                                       const size_t *key_length, size_t number_of_keys,
+                                       uint32_t *server_keys, uint32_t stride);
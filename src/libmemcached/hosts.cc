@@ -18,6 +18,7 @@
 #include "p9y/gettimeofday.hpp"
 #include "p9y/random.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 /* Protoypes (static) */
@@ -44,6 +45,9 @@ static void sort_hosts(Memcached *ptr) {
 }
 
 memcached_return_t run_distribution(Memcached *ptr) {
+  /* the epoll set refers to instances by address */
+  memcached_io_epoll_reset(ptr);
+
   if (ptr->flags.use_sort_hosts) {
     sort_hosts(ptr);
   }
@@ -55,8 +59,16 @@ memcached_return_t run_distribution(Memcached *ptr) {
   case MEMCACHED_DISTRIBUTION_CONSISTENT_WEIGHTED:
     return update_continuum(ptr);
 
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS:
+  case MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON:
+    return memcached_rendezvous_update(ptr);
+
+  case MEMCACHED_DISTRIBUTION_MAGLEV:
+    return memcached_maglev_update(ptr);
+
   case MEMCACHED_DISTRIBUTION_VIRTUAL_BUCKET:
   case MEMCACHED_DISTRIBUTION_MODULA:
+  case MEMCACHED_DISTRIBUTION_JUMP:
     break;
 
   case MEMCACHED_DISTRIBUTION_RANDOM:
@@ -71,42 +83,228 @@ memcached_return_t run_distribution(Memcached *ptr) {
   return MEMCACHED_SUCCESS;
 }
 
-static uint32_t ketama_server_hash(const char *key, size_t key_length, uint32_t alignment) {
-  unsigned char results[16];
-
-  libhashkit_md5_signature((unsigned char *) key, key_length, results);
-
+static uint32_t ketama_server_hash(const unsigned char results[16], uint32_t alignment) {
   return ((uint32_t)(results[3 + alignment * 4] & 0xFF) << 24)
       | ((uint32_t)(results[2 + alignment * 4] & 0xFF) << 16)
       | ((uint32_t)(results[1 + alignment * 4] & 0xFF) << 8) | (results[0 + alignment * 4] & 0xFF);
 }
 
-static int continuum_item_cmp(const void *t1, const void *t2) {
-  memcached_continuum_item_st *ct1 = (memcached_continuum_item_st *) t1;
-  memcached_continuum_item_st *ct2 = (memcached_continuum_item_st *) t2;
-
-  /* Why 153? Hmmm... */
-  WATCHPOINT_ASSERT(ct1->value != 153);
-  if (ct1->value == ct2->value) {
-    if (ct1->index == ct2->index) {
-      return 0;
-    } else if (ct1->index > ct2->index) {
-      return 1;
+static uint32_t continuum_search_fill(const memcached_continuum_item_st *continuum,
+                                      uint32_t position, uint32_t k,
+                                      memcached_continuum_search_st *search) {
+  if (k <= search->count) {
+    position = continuum_search_fill(continuum, position, 2 * k, search);
+    search->keys[k] = continuum[position].value;
+    search->servers[k] = continuum[position].index;
+    position = continuum_search_fill(continuum, position + 1, 2 * k + 1, search);
+  }
+
+  return position;
+}
+
+static memcached_return_t update_continuum_search(Memcached *ptr) {
+  uint32_t count = ptr->ketama.continuum_points_counter;
+  size_t size = sizeof(memcached_continuum_search_st) + 64 + 2 * sizeof(uint32_t) * (count + 1);
+  memcached_continuum_search_st *search =
+      (memcached_continuum_search_st *) libmemcached_realloc(ptr, ptr->ketama.continuum_search, 1,
+                                                            size);
+
+  if (search == NULL) {
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+  ptr->ketama.continuum_search = search;
+
+  /* align keys[0] to a cache line, so the children of each node share one */
+  uintptr_t keys = ((uintptr_t) search->memory + 63) & ~(uintptr_t) 63;
+  search->count = count;
+  search->keys = (uint32_t *) keys;
+  search->servers = search->keys + count + 1;
+  search->keys[0] = 0;
+  search->servers[0] = count ? ptr->ketama.continuum[0].index : 0;
+  continuum_search_fill(ptr->ketama.continuum, 0, 1, search);
+
+  return MEMCACHED_SUCCESS;
+}
+
+static inline uint32_t continuum_points_mode(const Memcached *ptr) {
+  return (memcached_is_weighted_ketama(ptr) ? 1 : 0)
+      | (ptr->distribution == MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA_SPY ? 2 : 0);
+}
+
+/* The keys of a server's points are this prefix followed by their number */
+static memcached_return_t continuum_points_prefix(Memcached *ptr,
+                                                  const memcached_instance_st &instance,
+                                                  char *sort_host, size_t size,
+                                                  size_t &sort_host_length) {
+  int length;
+
+  if (ptr->distribution == MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA_SPY) {
+    // Spymemcached ketema key format is: hostname/ip:port-index
+    // If hostname is not available then: /ip:port-index
+    length = snprintf(sort_host, size, "/%s:%u-", instance._hostname, (uint32_t) instance.port());
+  } else if (instance.port() == MEMCACHED_DEFAULT_PORT) {
+    length = snprintf(sort_host, size, "%s-", instance._hostname);
+  } else {
+    length = snprintf(sort_host, size, "%s:%u-", instance._hostname, (uint32_t) instance.port());
+  }
+
+  if (size_t(length) >= size or length < 0) {
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT,
+                               memcached_literal_param("snprintf(sizeof(sort_host))"));
+  }
+  sort_host_length = size_t(length);
+
+  return MEMCACHED_SUCCESS;
+}
+
+/*
+  Hash the keys first to last of a server into points, MEMCACHED_HASH_BATCH keys at a time,
+  4 points per key with weighted ketama, else 1.
+*/
+static memcached_return_t continuum_points_hash(Memcached *ptr, const char *sort_host,
+                                                size_t sort_host_length, uint32_t first,
+                                                uint32_t last,
+                                                memcached_continuum_point_st *points) {
+  uint32_t pointer_per_hash = memcached_is_weighted_ketama(ptr) ? 4 : 1;
+  char numbers[MEMCACHED_HASH_BATCH][sizeof("4294967295")];
+  const char *keys[MEMCACHED_HASH_BATCH];
+  size_t key_length[MEMCACHED_HASH_BATCH];
+
+  for (uint32_t n = first; n < last; n += MEMCACHED_HASH_BATCH) {
+    uint32_t count = std::min(last - n, uint32_t(MEMCACHED_HASH_BATCH));
+
+    for (uint32_t x = 0; x < count; x++) {
+      key_length[x] = (size_t) snprintf(numbers[x], sizeof(numbers[x]), "%u", n + x);
+      keys[x] = numbers[x];
+    }
+
+    if (memcached_is_weighted_ketama(ptr)) {
+      unsigned char results[MEMCACHED_HASH_BATCH][16];
+
+      libhashkit_md5_signature_batch((const unsigned char *) sort_host, sort_host_length,
+                                     (const unsigned char *const *) keys, key_length, count,
+                                     results[0]);
+      for (uint32_t x = 0; x < count; x++) {
+        for (uint32_t alignment = 0; alignment < 4; alignment++) {
+          points->value = ketama_server_hash(results[x], alignment);
+          points->rank = (n + x) * pointer_per_hash + alignment;
+          ++points;
+        }
+      }
     } else {
-      return -1;
+      uint32_t hashes[MEMCACHED_HASH_BATCH];
+
+      if (hashkit_digest_batch(&ptr->hashkit, sort_host, sort_host_length, keys, key_length,
+                               count, hashes)
+          == false)
+      {
+        return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+      }
+      for (uint32_t x = 0; x < count; x++) {
+        points->value = hashes[x];
+        points->rank = n + x;
+        ++points;
+      }
     }
-  } else if (ct1->value > ct2->value) {
-    return 1;
-  } else {
-    return -1;
   }
+
+  return MEMCACHED_SUCCESS;
+}
+
+static bool continuum_point_less(const memcached_continuum_point_st &a,
+                                 const memcached_continuum_point_st &b) {
+  return a.value < b.value or (a.value == b.value and a.rank < b.rank);
+}
+
+/*
+  Make sure the points cached in the instance were generated the way the continuum is
+  built now, and that there are at least count of them.
+*/
+static memcached_return_t continuum_points_update(Memcached *ptr, memcached_instance_st &instance,
+                                                  uint32_t count) {
+  memcached_continuum_points_st *points = instance.continuum_points;
+  uint32_t mode = continuum_points_mode(ptr);
+  uint32_t pointer_per_hash = memcached_is_weighted_ketama(ptr) ? 4 : 1;
+
+  if (points and (points->mode != mode or points->function != ptr->hashkit.base_hash.function
+                  or points->context != ptr->hashkit.base_hash.context))
+  {
+    points->count = 0;
+  }
+  if (points and points->count >= count) {
+    return MEMCACHED_SUCCESS;
+  }
+
+  /* generate whole keys, and a few more, so small weight changes need no rehashing */
+  count = (count + count / 8 + pointer_per_hash - 1) / pointer_per_hash * pointer_per_hash;
+
+  if (points == NULL or points->size < count) {
+    points = (memcached_continuum_points_st *) libmemcached_realloc(
+        ptr, points, 1,
+        sizeof(memcached_continuum_points_st) + sizeof(memcached_continuum_point_st) * count);
+    if (points == NULL) {
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    if (instance.continuum_points == NULL) {
+      points->count = 0;
+    }
+    points->size = count;
+    instance.continuum_points = points;
+  }
+
+  points->mode = mode;
+  points->function = ptr->hashkit.base_hash.function;
+  points->context = ptr->hashkit.base_hash.context;
+
+  char sort_host[1 + MEMCACHED_NI_MAXHOST + 1 + MEMCACHED_NI_MAXSERV + 1 + MEMCACHED_NI_MAXSERV] =
+      "";
+  size_t sort_host_length;
+  uint32_t generated = points->count;
+  memcached_return_t rc;
+
+  if (memcached_failed(
+          rc = continuum_points_prefix(ptr, instance, sort_host, sizeof(sort_host), sort_host_length))
+      or memcached_failed(rc = continuum_points_hash(ptr, sort_host, sort_host_length,
+                                                     generated / pointer_per_hash,
+                                                     count / pointer_per_hash,
+                                                     points->points + generated)))
+  {
+    points->count = 0;
+    return rc;
+  }
+
+  std::sort(points->points + generated, points->points + count, continuum_point_less);
+  std::inplace_merge(points->points, points->points + generated, points->points + count,
+                     continuum_point_less);
+  points->count = count;
+
+  return MEMCACHED_SUCCESS;
 }
 
+/* A live server's points of rank below count, in ascending order */
+struct continuum_cursor {
+  const memcached_continuum_point_st *point;
+  const memcached_continuum_point_st *end;
+  uint32_t count;
+  uint32_t index;
+
+  void skip() {
+    while (point < end and point->rank >= count) {
+      ++point;
+    }
+  }
+
+  /* heap order, smallest first, ties broken by server like the sorted continuum */
+  bool operator<(const continuum_cursor &other) const {
+    return point->value > other.point->value
+        or (point->value == other.point->value and index > other.index);
+  }
+};
+
 static memcached_return_t update_continuum(Memcached *ptr) {
   uint32_t continuum_index = 0;
   uint32_t pointer_counter = 0;
   uint32_t pointer_per_server = MEMCACHED_POINTS_PER_SERVER;
-  uint32_t pointer_per_hash = 1;
   uint32_t live_servers = 0;
   struct timeval now;
 
@@ -170,6 +368,13 @@ static memcached_return_t update_continuum(Memcached *ptr) {
     }
   }
 
+  continuum_cursor *cursors = libmemcached_xvalloc(ptr, live_servers, continuum_cursor);
+  if (cursors == NULL) {
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  /* Only servers new to the continuum, or needing more points, are hashed. */
+  uint32_t cursor_count = 0;
   for (uint32_t host_index = 0; host_index < memcached_server_count(ptr); ++host_index) {
     if (is_auto_ejecting and list[host_index].next_retry > now.tv_sec) {
       continue;
@@ -181,95 +386,52 @@ static memcached_return_t update_continuum(Memcached *ptr) {
           (::floor((float) (pct * MEMCACHED_POINTS_PER_SERVER_KETAMA / 4 * (float) live_servers
                             + 0.0000000001F)))
           * 4);
-      pointer_per_hash = 4;
-      if (0 && DEBUG) {
-        printf("ketama_weighted:%s|%d|%llu|%u\n", list[host_index]._hostname,
-               list[host_index].port(), (unsigned long long) list[host_index].weight,
-               pointer_per_server);
-      }
     }
 
-    if (ptr->distribution == MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA_SPY) {
-      for (uint32_t pointer_index = 0; pointer_index < pointer_per_server / pointer_per_hash;
-           pointer_index++)
-      {
-        char sort_host[1 + MEMCACHED_NI_MAXHOST + 1 + MEMCACHED_NI_MAXSERV + 1
-                       + MEMCACHED_NI_MAXSERV] = "";
-        int sort_host_length;
-
-        // Spymemcached ketema key format is: hostname/ip:port-index
-        // If hostname is not available then: /ip:port-index
-        sort_host_length =
-            snprintf(sort_host, sizeof(sort_host), "/%s:%u-%u", list[host_index]._hostname,
-                     (uint32_t) list[host_index].port(), pointer_index);
-
-        if (size_t(sort_host_length) >= sizeof(sort_host) or sort_host_length < 0) {
-          return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT,
-                                     memcached_literal_param("snprintf(sizeof(sort_host))"));
-        }
+    memcached_return_t rc;
+    if (memcached_failed(rc = continuum_points_update(ptr, list[host_index], pointer_per_server))) {
+      libmemcached_free(ptr, cursors);
+      return rc;
+    }
 
-        if (0 && DEBUG) {
-          fprintf(stdout, "update_continuum: key is %s\n", sort_host);
-        }
+    continuum_cursor &cursor = cursors[cursor_count];
+    cursor.point = list[host_index].continuum_points->points;
+    cursor.end = cursor.point + list[host_index].continuum_points->count;
+    cursor.count = pointer_per_server;
+    cursor.index = host_index;
+    cursor.skip();
+    if (cursor.point < cursor.end) {
+      ++cursor_count;
+    }
 
-        if (memcached_is_weighted_ketama(ptr)) {
-          for (uint32_t x = 0; x < pointer_per_hash; x++) {
-            uint32_t value = ketama_server_hash(sort_host, (size_t) sort_host_length, x);
-            ptr->ketama.continuum[continuum_index].index = host_index;
-            ptr->ketama.continuum[continuum_index++].value = value;
-          }
-        } else {
-          uint32_t value = hashkit_digest(&ptr->hashkit, sort_host, (size_t) sort_host_length);
-          ptr->ketama.continuum[continuum_index].index = host_index;
-          ptr->ketama.continuum[continuum_index++].value = value;
-        }
-      }
-    } else {
-      for (uint32_t pointer_index = 1; pointer_index <= pointer_per_server / pointer_per_hash;
-           pointer_index++)
-      {
-        char sort_host[MEMCACHED_NI_MAXHOST + 1 + MEMCACHED_NI_MAXSERV + 1 + MEMCACHED_NI_MAXSERV] =
-            "";
-        int sort_host_length;
-
-        if (list[host_index].port() == MEMCACHED_DEFAULT_PORT) {
-          sort_host_length = snprintf(sort_host, sizeof(sort_host), "%s-%u",
-                                      list[host_index]._hostname, pointer_index - 1);
-        } else {
-          sort_host_length =
-              snprintf(sort_host, sizeof(sort_host), "%s:%u-%u", list[host_index]._hostname,
-                       (uint32_t) list[host_index].port(), pointer_index - 1);
-        }
+    pointer_counter += pointer_per_server;
+  }
 
-        if (size_t(sort_host_length) >= sizeof(sort_host) or sort_host_length < 0) {
-          return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT,
-                                     memcached_literal_param("snprintf(sizeof(sort_host)))"));
-        }
+  /* merge the sorted points of all servers */
+  std::make_heap(cursors, cursors + cursor_count);
+  while (cursor_count) {
+    std::pop_heap(cursors, cursors + cursor_count);
 
-        if (memcached_is_weighted_ketama(ptr)) {
-          for (uint32_t x = 0; x < pointer_per_hash; x++) {
-            uint32_t value = ketama_server_hash(sort_host, (size_t) sort_host_length, x);
-            ptr->ketama.continuum[continuum_index].index = host_index;
-            ptr->ketama.continuum[continuum_index++].value = value;
-          }
-        } else {
-          uint32_t value = hashkit_digest(&ptr->hashkit, sort_host, (size_t) sort_host_length);
-          ptr->ketama.continuum[continuum_index].index = host_index;
-          ptr->ketama.continuum[continuum_index++].value = value;
-        }
-      }
-    }
+    continuum_cursor &cursor = cursors[cursor_count - 1];
+    ptr->ketama.continuum[continuum_index].index = cursor.index;
+    ptr->ketama.continuum[continuum_index++].value = cursor.point->value;
 
-    pointer_counter += pointer_per_server;
+    ++cursor.point;
+    cursor.skip();
+    if (cursor.point < cursor.end) {
+      std::push_heap(cursors, cursors + cursor_count);
+    } else {
+      --cursor_count;
+    }
   }
+  libmemcached_free(ptr, cursors);
 
   assert_msg(ptr, "Programmer Error, no valid ptr");
   assert_msg(ptr->ketama.continuum, "Programmer Error, empty ketama continuum");
   assert_msg(memcached_server_count(ptr) * MEMCACHED_POINTS_PER_SERVER <= MEMCACHED_CONTINUUM_SIZE,
              "invalid size information being given to qsort()");
+  assert(continuum_index == pointer_counter);
   ptr->ketama.continuum_points_counter = pointer_counter;
-  qsort(ptr->ketama.continuum, ptr->ketama.continuum_points_counter,
-        sizeof(memcached_continuum_item_st), continuum_item_cmp);
 
   if (DEBUG) {
     for (uint32_t pointer_index = 0; memcached_server_count(ptr)
@@ -281,7 +443,7 @@ static memcached_return_t update_continuum(Memcached *ptr) {
     }
   }
 
-  return MEMCACHED_SUCCESS;
+  return update_continuum_search(ptr);
 }
 
 static memcached_return_t server_add(Memcached *memc, const memcached_string_t &hostname,
@@ -419,6 +581,116 @@ memcached_return_t memcached_instance_push(memcached_st *ptr,
   return run_distribution(ptr);
 }
 
+/*
+  Find an instance of ptr, not taken yet, which connects to the same server as wanted.
+*/
+static uint32_t servers_update_match(Memcached *ptr, const memcached_instance_st *wanted,
+                                     const bool *taken) {
+  for (uint32_t x = 0; x < memcached_server_count(ptr); ++x) {
+    memcached_instance_st *instance = memcached_instance_fetch(ptr, x);
+
+    if (taken[x] == false and instance->type == wanted->type and instance->port() == wanted->port()
+        and strcmp(instance->_hostname, wanted->_hostname) == 0)
+    {
+      return x;
+    }
+  }
+
+  return UINT32_MAX;
+}
+
+memcached_return_t memcached_servers_update(memcached_st *shell, const memcached_st *source) {
+  Memcached *ptr = memcached2Memcached(shell);
+  if (ptr == NULL or source == NULL or ptr == source) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  uint32_t original_host_size = memcached_server_count(ptr);
+  uint32_t host_list_size = memcached_server_count(source);
+  memcached_instance_st *new_host_list = NULL;
+  uint32_t *match = NULL;
+  bool *taken = NULL;
+
+  if (host_list_size) {
+    new_host_list = libmemcached_xcalloc(ptr, host_list_size, memcached_instance_st);
+    match = libmemcached_xcalloc(ptr, host_list_size, uint32_t);
+  }
+  if (original_host_size) {
+    taken = libmemcached_xcalloc(ptr, original_host_size, bool);
+  }
+  if ((host_list_size and (new_host_list == NULL or match == NULL))
+      or (original_host_size and taken == NULL))
+  {
+    libmemcached_free(ptr, new_host_list);
+    libmemcached_free(ptr, match);
+    libmemcached_free(ptr, taken);
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  /* create the instances of new servers first, so that a failure leaves ptr untouched */
+  ptr->state.is_parsing = true;
+  for (uint32_t x = 0; x < host_list_size; ++x) {
+    const memcached_instance_st *wanted = memcached_instance_by_position(source, x);
+
+    match[x] = servers_update_match(ptr, wanted, taken);
+    if (match[x] != UINT32_MAX) {
+      taken[match[x]] = true;
+      continue;
+    }
+
+    memcached_string_t hostname = {memcached_string_make_from_cstr(wanted->_hostname)};
+    if (instance_create_with(ptr, &new_host_list[x], hostname, wanted->port(), wanted->weight,
+                             wanted->type)
+        == NULL)
+    {
+      for (uint32_t y = 0; y < x; ++y) {
+        if (match[y] == UINT32_MAX) {
+          instance_free(&new_host_list[y]);
+        }
+      }
+      ptr->state.is_parsing = false;
+      libmemcached_free(ptr, new_host_list);
+      libmemcached_free(ptr, match);
+      libmemcached_free(ptr, taken);
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+  }
+  ptr->state.is_parsing = false;
+
+  /* move the instances of kept servers over, along with their connections */
+  bool weighted = false;
+  for (uint32_t x = 0; x < host_list_size; ++x) {
+    if (match[x] != UINT32_MAX) {
+      memcpy(&new_host_list[x], memcached_instance_fetch(ptr, match[x]),
+             sizeof(memcached_instance_st));
+      new_host_list[x].weight = memcached_instance_by_position(source, x)->weight;
+    }
+    if (new_host_list[x].weight > 1) {
+      weighted = true;
+    }
+  }
+
+  /* and close the connections of removed servers */
+  memcached_io_epoll_reset(ptr);
+  for (uint32_t x = 0; x < original_host_size; ++x) {
+    if (taken[x] == false) {
+      instance_free(memcached_instance_fetch(ptr, x));
+    }
+  }
+  libmemcached_free(ptr, memcached_instance_list(ptr));
+  libmemcached_free(ptr, match);
+  libmemcached_free(ptr, taken);
+
+  memcached_instance_set(ptr, new_host_list, host_list_size);
+  memcached_reset_last_disconnected_server(ptr);
+
+  if (weighted and memcached_is_consistent_distribution(ptr)) {
+    memcached_set_weighted_ketama(ptr, true);
+  }
+
+  return run_distribution(ptr);
+}
+
 memcached_return_t memcached_server_add_unix_socket(memcached_st *ptr, const char *filename) {
   return memcached_server_add_unix_socket_with_weight(ptr, filename, 0);
 }
@@ -15,12 +15,14 @@
 
 #include "libmemcached/common.h"
 
-static inline void _server_init(memcached_instance_st *self, Memcached *root,
+static inline bool _server_init(memcached_instance_st *self, Memcached *root,
                                 const memcached_string_t &hostname, in_port_t port, uint32_t weight,
                                 memcached_connection_t type) {
   self->options.is_shutting_down = false;
   self->options.is_dead = false;
   self->options.ready = false;
+  self->options.is_zerocopy = false;
+  self->options.is_epoll_registered = false;
   self->_events = 0;
   self->_revents = 0;
   self->cursor_active_ = 0;
@@ -42,11 +44,21 @@ static inline void _server_init(memcached_instance_st *self, Memcached *root,
   self->minor_version = UINT8_MAX;
   self->type = type;
   self->error_messages = NULL;
-  self->read_ptr = self->read_buffer;
+  self->async = NULL;
+  self->view_buffer = NULL;
+  self->view_buffer_size = 0;
+  self->read_buffer = NULL;
+  self->read_buffer_size = 0;
+  self->read_buffer_underused = 0;
+  self->read_ptr = NULL;
   self->read_buffer_length = 0;
+  self->write_buffer = NULL;
+  self->write_buffer_size = 0;
+  self->write_buffer_underused = 0;
   self->write_buffer_offset = 0;
   self->address_info = NULL;
   self->address_info_next = NULL;
+  self->resolved = NULL;
 
   self->state = MEMCACHED_SERVER_STATE_NEW;
   self->next_retry = 0;
@@ -58,7 +70,9 @@ static inline void _server_init(memcached_instance_st *self, Memcached *root,
     self->version = UINT_MAX;
   }
   self->limit_maxbytes = 0;
-  self->hostname(hostname);
+  self->continuum_points = NULL;
+  self->_hostname = NULL;
+  return self->hostname(hostname);
 }
 
 static memcached_instance_st *_server_create(memcached_instance_st *self,
@@ -80,6 +94,28 @@ static memcached_instance_st *_server_create(memcached_instance_st *self,
   return self;
 }
 
+bool memcached_instance_st::hostname(const memcached_string_t &hostname_) {
+  const char *name = hostname_.c_str;
+  size_t name_length = hostname_.size;
+  if (name_length == 0) {
+    name = "localhost";
+    name_length = memcached_literal_param_size("localhost");
+  } else if (name_length >= MEMCACHED_NI_MAXHOST) {
+    return false;
+  }
+
+  char *new_hostname = libmemcached_xrealloc(root, _hostname, name_length + 1, char);
+  if (new_hostname == NULL) {
+    return false;
+  }
+
+  memcpy(new_hostname, name, name_length);
+  new_hostname[name_length] = 0;
+  _hostname = new_hostname;
+
+  return true;
+}
+
 void memcached_instance_st::events(short arg) {
   if ((_events | arg) == _events) {
     return;
@@ -97,6 +133,17 @@ void memcached_instance_st::revents(short arg) {
   _events &= short(~arg);
 }
 
+void memcached_instance_st::clear_addrinfo() {
+  if (resolved) {
+    memcached_addrinfo_release(resolved);
+    resolved = NULL;
+  } else if (address_info) {
+    freeaddrinfo(address_info);
+  }
+  address_info = NULL;
+  address_info_next = NULL;
+}
+
 memcached_instance_st *instance_create_with(memcached_st *memc, memcached_instance_st *self,
                                               const memcached_string_t &_hostname,
                                               const in_port_t port, uint32_t weight,
@@ -113,13 +160,18 @@ memcached_instance_st *instance_create_with(memcached_st *memc, memcached_instan
     return NULL;
   }
 
-  _server_init(self, const_cast<memcached_st *>(memc), _hostname, port, weight, type);
+  if (_server_init(self, const_cast<memcached_st *>(memc), _hostname, port, weight, type) == false)
+  {
+    instance_free(self);
+    return NULL;
+  }
 
   if (memc and memcached_is_udp(memc)) {
     self->write_buffer_offset = UDP_DATAGRAM_HEADER_LENGTH;
-    memcached_io_init_udp_header(self, 0);
   }
 
+  memcached_resolve_prefetch(self);
+
   return self;
 }
 
@@ -129,8 +181,15 @@ void instance_free(memcached_instance_st *self) {
   self->clear_addrinfo();
   assert(self->address_info_next == NULL);
 
+  memcached_async_free(self);
   memcached_error_free(*self);
 
+  memcached_io_buffers_free(self, false);
+  libmemcached_free(self->root, self->_hostname);
+  self->_hostname = NULL;
+  libmemcached_free(self->root, self->continuum_points);
+  self->continuum_points = NULL;
+
   if (memcached_is_allocated(self)) {
     libmemcached_free(self->root, self);
   } else {
@@ -67,6 +67,8 @@ struct memcached_instance_st {
     bool is_shutting_down;
     bool is_dead;
     bool ready;
+    bool is_zerocopy;
+    bool is_epoll_registered;
   } options;
 
   short _events;
@@ -78,15 +80,7 @@ struct memcached_instance_st {
 
   const char *hostname() { return _hostname; }
 
-  void hostname(const memcached_string_t &hostname_) {
-    if (hostname_.size) {
-      memcpy(_hostname, hostname_.c_str, hostname_.size);
-      _hostname[hostname_.size] = 0;
-    } else {
-      memcpy(_hostname, memcached_literal_param("localhost"));
-      _hostname[memcached_literal_param_size("localhost")] = 0;
-    }
-  }
+  bool hostname(const memcached_string_t &hostname_);
 
   void events(short);
   void revents(short);
@@ -118,21 +112,24 @@ struct memcached_instance_st {
   size_t write_buffer_offset;
   struct addrinfo *address_info;
   struct addrinfo *address_info_next;
+  struct memcached_addrinfo_st *resolved; /* owns address_info if cached, see resolver.hpp */
   time_t next_retry;
   struct memcached_st *root;
   uint64_t limit_maxbytes;
   struct memcached_error_t *error_messages;
-  char read_buffer[MEMCACHED_MAX_BUFFER];
-  char write_buffer[MEMCACHED_MAX_BUFFER];
-  char _hostname[MEMCACHED_NI_MAXHOST];
-
-  void clear_addrinfo() {
-    if (address_info) {
-      freeaddrinfo(address_info);
-      address_info = NULL;
-      address_info_next = NULL;
-    }
-  }
+  struct memcached_async_queue_st *async;
+  char *view_buffer; /* values too large for read_buffer, see memcached_io_read_view() */
+  size_t view_buffer_size;
+  char *read_buffer; /* allocated on connect, see memcached_io_buffers_init() */
+  size_t read_buffer_size;
+  uint32_t read_buffer_underused;
+  char *write_buffer;
+  size_t write_buffer_size;
+  uint32_t write_buffer_underused;
+  char *_hostname;
+  struct memcached_continuum_points_st *continuum_points; /* cached by update_continuum() */
+
+  void clear_addrinfo();
 };
 
 memcached_instance_st *instance_create_with(memcached_st *memc, memcached_instance_st *self,
@@ -17,6 +17,16 @@
 #include "p9y/poll.hpp"
 #include "p9y/clock_gettime.hpp"
 
+#if HAVE_SYS_EPOLL_H
+#  include <sys/epoll.h>
+#endif
+
+#if HAVE_SENDMSG && HAVE_STRUCT_MSGHDR && HAVE_MSG_ZEROCOPY && HAVE_SO_ZEROCOPY \
+    && HAVE_LINUX_ERRQUEUE_H
+#  define HAVE_IO_ZEROCOPY 1
+#  include <linux/errqueue.h>
+#endif
+
 void initialize_binary_request(memcached_instance_st *server,
                                protocol_binary_request_header &header) {
   server->request_id++;
@@ -26,6 +36,144 @@ void initialize_binary_request(memcached_instance_st *server,
 
 enum memc_read_or_write { MEM_READ, MEM_WRITE };
 
+static bool io_buffer_resize(memcached_instance_st *instance, char *&buffer, size_t &size,
+                             const size_t new_size) {
+  char *new_buffer = libmemcached_xrealloc(instance->root, buffer, new_size, char);
+  if (new_buffer == NULL) {
+    return false;
+  }
+
+  buffer = new_buffer;
+  size = new_size;
+
+  return true;
+}
+
+/* The caller makes sure that the unread data fits into the new size */
+static bool io_read_buffer_resize(memcached_instance_st *instance, const size_t new_size) {
+  const size_t offset = size_t(instance->read_ptr - instance->read_buffer);
+
+  if (io_buffer_resize(instance, instance->read_buffer, instance->read_buffer_size, new_size)
+      == false)
+  {
+    return false;
+  }
+  instance->read_ptr = instance->read_buffer + offset;
+
+  return true;
+}
+
+memcached_return_t memcached_io_buffers_init(memcached_instance_st *instance) {
+  const size_t size = instance->root->io_buffer_min;
+
+  if (instance->write_buffer == NULL) {
+    if (io_buffer_resize(instance, instance->write_buffer, instance->write_buffer_size, size)
+        == false)
+    {
+      return memcached_set_error(*instance, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    instance->write_buffer_underused = 0;
+
+    if (memcached_is_udp(instance->root)) {
+      memcached_io_init_udp_header(instance, 0);
+    }
+  }
+
+  if (instance->read_buffer == NULL) {
+    if (io_buffer_resize(instance, instance->read_buffer, instance->read_buffer_size, size)
+        == false)
+    {
+      return memcached_set_error(*instance, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    instance->read_buffer_underused = 0;
+    instance->read_buffer_length = 0;
+    instance->read_ptr = instance->read_buffer;
+  }
+
+  return MEMCACHED_SUCCESS;
+}
+
+void memcached_io_buffers_free(memcached_instance_st *instance, const bool keep_write_buffer) {
+  libmemcached_free(instance->root, instance->read_buffer);
+  instance->read_buffer = NULL;
+  instance->read_buffer_size = 0;
+  instance->read_buffer_length = 0;
+  instance->read_ptr = NULL;
+
+  if (keep_write_buffer == false) {
+    libmemcached_free(instance->root, instance->write_buffer);
+    instance->write_buffer = NULL;
+    instance->write_buffer_size = 0;
+  }
+
+  libmemcached_free(instance->root, instance->view_buffer);
+  instance->view_buffer = NULL;
+  instance->view_buffer_size = 0;
+}
+
+void memcached_io_read_buffer_adapt(memcached_instance_st *instance) {
+  const size_t used =
+      size_t(instance->read_ptr - instance->read_buffer) + instance->read_buffer_length;
+  const size_t size = instance->read_buffer_size;
+
+  if (used == size) {
+    /* There is probably more where that came from */
+    instance->read_buffer_underused = 0;
+    if (size < instance->root->io_buffer_max) {
+      size_t new_size = size * 2;
+      if (new_size > instance->root->io_buffer_max) {
+        new_size = instance->root->io_buffer_max;
+      }
+      (void) io_read_buffer_resize(instance, new_size);
+    }
+  } else if (used <= size / 4 and size > instance->root->io_buffer_min) {
+    if (++instance->read_buffer_underused >= MEMCACHED_IO_BUFFER_SHRINK_ROUNDS) {
+      size_t new_size = size / 2;
+      if (new_size < instance->root->io_buffer_min) {
+        new_size = instance->root->io_buffer_min;
+      }
+      instance->read_buffer_underused = 0;
+      (void) io_read_buffer_resize(instance, new_size);
+    }
+  } else {
+    instance->read_buffer_underused = 0;
+  }
+}
+
+/* Called with an empty write buffer after flushing length bytes */
+static void io_write_buffer_adapt(memcached_instance_st *instance, const size_t length) {
+  const size_t size = instance->write_buffer_size;
+
+  if (length == 0) {
+    return;
+  }
+
+  if (length == size) {
+    /* Requests are being batched beyond the capacity of the buffer */
+    instance->write_buffer_underused = 0;
+    if (size < instance->root->io_buffer_max) {
+      size_t new_size = size * 2;
+      if (new_size > instance->root->io_buffer_max) {
+        new_size = instance->root->io_buffer_max;
+      }
+      (void) io_buffer_resize(instance, instance->write_buffer, instance->write_buffer_size,
+                              new_size);
+    }
+  } else if (length <= size / 4 and size > instance->root->io_buffer_min) {
+    if (++instance->write_buffer_underused >= MEMCACHED_IO_BUFFER_SHRINK_ROUNDS) {
+      size_t new_size = size / 2;
+      if (new_size < instance->root->io_buffer_min) {
+        new_size = instance->root->io_buffer_min;
+      }
+      instance->write_buffer_underused = 0;
+      (void) io_buffer_resize(instance, instance->write_buffer, instance->write_buffer_size,
+                              new_size);
+    }
+  } else {
+    instance->write_buffer_underused = 0;
+  }
+}
+
 /**
  * Try to fill the input buffer for a server with as much
  * data as possible.
@@ -42,12 +190,12 @@ static bool repack_input_buffer(memcached_instance_st *instance) {
   }
 
   /* There is room in the buffer, try to fill it! */
-  if (instance->read_buffer_length != MEMCACHED_MAX_BUFFER) {
+  if (instance->read_buffer_length != instance->read_buffer_size) {
     do {
       /* Just try a single read to grab what's available */
       ssize_t nr;
       if ((nr = ::recv(instance->fd, instance->read_ptr + instance->read_buffer_length,
-                       MEMCACHED_MAX_BUFFER - instance->read_buffer_length, MSG_NOSIGNAL))
+                       instance->read_buffer_size - instance->read_buffer_length, MSG_NOSIGNAL))
           <= 0)
       {
         if (nr == 0) {
@@ -285,9 +433,9 @@ static bool io_flush(memcached_instance_st *instance, const bool with_flush,
 
   /* Looking for memory overflows */
 #if defined(DEBUG)
-  if (write_length == MEMCACHED_MAX_BUFFER)
+  if (write_length == instance->write_buffer_size)
     WATCHPOINT_ASSERT(instance->write_buffer == local_write_ptr);
-  WATCHPOINT_ASSERT((instance->write_buffer + MEMCACHED_MAX_BUFFER)
+  WATCHPOINT_ASSERT((instance->write_buffer + instance->write_buffer_size)
                     >= (local_write_ptr + write_length));
 #endif
 
@@ -356,6 +504,7 @@ static bool io_flush(memcached_instance_st *instance, const bool with_flush,
   }
 
   WATCHPOINT_ASSERT(write_length == 0);
+  io_write_buffer_adapt(instance, instance->write_buffer_offset);
   instance->write_buffer_offset = 0;
 
   return true;
@@ -369,10 +518,11 @@ memcached_return_t memcached_io_wait_for_read(memcached_instance_st *instance) {
   return io_wait(instance, POLLIN);
 }
 
-static memcached_return_t _io_fill(memcached_instance_st *instance) {
+static memcached_return_t _io_fill(memcached_instance_st *instance, size_t offset = 0) {
   ssize_t data_read;
   do {
-    data_read = ::recv(instance->fd, instance->read_buffer, MEMCACHED_MAX_BUFFER, MSG_NOSIGNAL);
+    data_read = ::recv(instance->fd, instance->read_buffer + offset,
+                       instance->read_buffer_size - offset, MSG_NOSIGNAL);
     int local_errno = get_socket_errno(); // We cache in case memcached_quit_server() modifies errno
 
     if (data_read == SOCKET_ERROR) {
@@ -437,8 +587,9 @@ static memcached_return_t _io_fill(memcached_instance_st *instance) {
   } while (data_read <= 0);
 
   instance->io_bytes_sent = 0;
-  instance->read_buffer_length = (size_t) data_read;
+  instance->read_buffer_length = offset + (size_t) data_read;
   instance->read_ptr = instance->read_buffer;
+  memcached_io_read_buffer_adapt(instance);
 
   return MEMCACHED_SUCCESS;
 }
@@ -490,6 +641,69 @@ memcached_return_t memcached_io_read(memcached_instance_st *instance, void *buff
   return MEMCACHED_SUCCESS;
 }
 
+memcached_return_t memcached_io_read_view(memcached_instance_st *instance, size_t length,
+                                          const char *&data) {
+  assert(memcached_is_udp(instance->root) == false);
+  assert_msg(instance, "Programmer error, memcached_io_read_view() recieved an invalid Instance");
+
+  if (instance->fd == INVALID_SOCKET) {
+    return MEMCACHED_CONNECTION_FAILURE;
+  }
+
+  if (length > instance->read_buffer_size and length <= instance->root->io_buffer_max) {
+    /* Grow the read buffer to fit, or fall back to copying below */
+    size_t new_size = instance->read_buffer_size;
+    while (new_size < length) {
+      new_size *= 2;
+    }
+    if (new_size > instance->root->io_buffer_max) {
+      new_size = instance->root->io_buffer_max;
+    }
+    (void) io_read_buffer_resize(instance, new_size);
+  }
+
+  if (length <= instance->read_buffer_size) {
+    if (instance->read_buffer_length < length) {
+      /* Move what we have got to the front and top up the rest behind it */
+      if (instance->read_buffer_length and instance->read_ptr != instance->read_buffer) {
+        memmove(instance->read_buffer, instance->read_ptr, instance->read_buffer_length);
+      }
+      instance->read_ptr = instance->read_buffer;
+
+      while (instance->read_buffer_length < length) {
+        memcached_return_t io_fill_ret;
+        if (memcached_fatal(io_fill_ret = _io_fill(instance, instance->read_buffer_length))) {
+          return io_fill_ret;
+        }
+      }
+    }
+
+    data = instance->read_ptr;
+    instance->read_ptr += length;
+    instance->read_buffer_length -= length;
+
+    return MEMCACHED_SUCCESS;
+  }
+
+  /* Larger than the read buffer, so it has to be copied once */
+  if (instance->view_buffer_size < length) {
+    char *new_buffer = libmemcached_xrealloc(instance->root, instance->view_buffer, length, char);
+    if (new_buffer == NULL) {
+      return memcached_set_error(*instance, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    instance->view_buffer = new_buffer;
+    instance->view_buffer_size = length;
+  }
+
+  memcached_return_t rc;
+  if (memcached_failed(rc = memcached_safe_read(instance, instance->view_buffer, length))) {
+    return rc;
+  }
+  data = instance->view_buffer;
+
+  return MEMCACHED_SUCCESS;
+}
+
 memcached_return_t memcached_io_slurp(memcached_instance_st *instance) {
   assert_msg(instance, "Programmer error, invalid Instance");
   assert(memcached_is_udp(instance->root) == false);
@@ -501,9 +715,8 @@ memcached_return_t memcached_io_slurp(memcached_instance_st *instance) {
   }
 
   ssize_t data_read;
-  char buffer[MEMCACHED_MAX_BUFFER];
   do {
-    data_read = ::recv(instance->fd, instance->read_buffer, sizeof(buffer), MSG_NOSIGNAL);
+    data_read = ::recv(instance->fd, instance->read_buffer, instance->read_buffer_size, MSG_NOSIGNAL);
     if (data_read == SOCKET_ERROR) {
       switch (get_socket_errno()) {
       case EINTR: // We just retry
@@ -554,7 +767,7 @@ static bool _io_write(memcached_instance_st *instance, const void *buffer, size_
 
   while (length) {
     char *write_ptr;
-    size_t buffer_end = MEMCACHED_MAX_BUFFER;
+    size_t buffer_end = instance->write_buffer_size;
     size_t should_write = buffer_end - instance->write_buffer_offset;
     should_write = (should_write < length) ? should_write : length;
 
@@ -605,11 +818,230 @@ ssize_t memcached_io_write(memcached_instance_st *instance, const void *buffer,
   return ssize_t(written);
 }
 
+#if HAVE_SENDMSG && HAVE_STRUCT_MSGHDR
+#  define IO_SENDMSG_MAX_IOV 16
+
+#  if HAVE_IO_ZEROCOPY
+static bool io_zerocopy_enable(memcached_instance_st *instance) {
+  if (instance->options.is_zerocopy == false) {
+    int enable = 1;
+    if (setsockopt(instance->fd, SOL_SOCKET, SO_ZEROCOPY, (const char *) &enable, sizeof(enable))
+        == SOCKET_ERROR)
+    {
+      return false;
+    }
+    instance->options.is_zerocopy = true;
+  }
+
+  return true;
+}
+
+/*
+  The kernel may still reference the caller's pages after sendmsg() returned,
+  so wait for the completion notifications of all MSG_ZEROCOPY sends before
+  handing the buffers back.
+*/
+static bool io_zerocopy_wait(memcached_instance_st *instance, uint32_t pending,
+                             memcached_return_t &error) {
+  while (pending) {
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err) + sizeof(struct sockaddr_in6))];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (::recvmsg(instance->fd, &msg, MSG_ERRQUEUE) == SOCKET_ERROR) {
+      switch (get_socket_errno()) {
+      case EINTR:
+        continue;
+
+#    if EWOULDBLOCK != EAGAIN
+      case EWOULDBLOCK:
+#    endif
+      case EAGAIN:
+        /* poll() always reports POLLERR once the error queue is not empty */
+        if (memcached_success(error = memcached_io_poll(instance, POLLERR))) {
+          continue;
+        }
+        return false;
+
+      default:
+        error = memcached_set_errno(*instance, get_socket_errno(), MEMCACHED_AT,
+                                    memcached_literal_param("recvmsg(MSG_ERRQUEUE)"));
+        return false;
+      }
+    }
+
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+      struct sock_extended_err *ee = (struct sock_extended_err *) CMSG_DATA(cm);
+
+      if (ee->ee_origin == SO_EE_ORIGIN_ZEROCOPY and ee->ee_errno == 0) {
+        uint32_t completed = ee->ee_data - ee->ee_info + 1;
+        pending = (completed < pending) ? pending - completed : 0;
+      }
+    }
+  }
+
+  return true;
+}
+#  endif // HAVE_IO_ZEROCOPY
+
+/*
+  Send the pending write buffer and all elements of vector with a single
+  sendmsg() straight from the caller's memory, instead of copying them into
+  the write buffer slice by slice.
+*/
+static bool io_sendmsg(memcached_instance_st *instance, libmemcached_io_vector_st vector[],
+                       const size_t number_of, const size_t largest, const bool with_flush,
+                       memcached_return_t &error) {
+  WATCHPOINT_ASSERT(instance->fd != INVALID_SOCKET);
+
+  if (memcached_purge(instance) == false) {
+    return false;
+  }
+
+  struct iovec iov[IO_SENDMSG_MAX_IOV];
+  size_t iovcnt = 0;
+  size_t total = 0;
+
+  if (instance->write_buffer_offset) {
+    iov[iovcnt].iov_base = instance->write_buffer;
+    iov[iovcnt].iov_len = instance->write_buffer_offset;
+    total += iov[iovcnt++].iov_len;
+  }
+  for (size_t x = 0; x < number_of; ++x) {
+    if (vector[x].length) {
+      iov[iovcnt].iov_base = const_cast<void *>(vector[x].buffer);
+      iov[iovcnt].iov_len = vector[x].length;
+      total += iov[iovcnt++].iov_len;
+    }
+  }
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iovcnt;
+
+  int flags = MSG_NOSIGNAL;
+  if (with_flush == false) {
+    flags |= MSG_MORE;
+  }
+
+#  if HAVE_IO_ZEROCOPY
+  uint32_t zerocopy_pending = 0;
+  bool zerocopy = instance->root->io_zerocopy_threshold
+      and largest >= instance->root->io_zerocopy_threshold and io_zerocopy_enable(instance);
+#  else
+  (void) largest;
+#  endif
+
+  error = MEMCACHED_SUCCESS;
+
+  while (total) {
+    int send_flags = flags;
+#  if HAVE_IO_ZEROCOPY
+    if (zerocopy) {
+      send_flags |= MSG_ZEROCOPY;
+    }
+#  endif
+
+    ssize_t sent_length = ::sendmsg(instance->fd, &msg, send_flags);
+    int local_errno = get_socket_errno(); // We cache in case memcached_quit_server() modifies errno
+
+    if (sent_length == SOCKET_ERROR) {
+      switch (local_errno) {
+      case ENOBUFS:
+#  if HAVE_IO_ZEROCOPY
+        /* exceeded optmem_max with pinned pages, copy the rest */
+        zerocopy = false;
+#  endif
+        continue;
+
+      case EINTR:
+        continue;
+
+#  if EWOULDBLOCK != EAGAIN
+      case EWOULDBLOCK:
+#  endif
+      case EAGAIN: {
+        if (repack_input_buffer(instance) or process_input_buffer(instance)) {
+          continue;
+        }
+
+        memcached_return_t rc = io_wait(instance, POLLOUT);
+        if (memcached_success(rc)) {
+          continue;
+        } else if (rc == MEMCACHED_TIMEOUT) {
+          return false;
+        }
+
+        memcached_quit_server(instance, true);
+        error = memcached_set_errno(*instance, local_errno, MEMCACHED_AT);
+        return false;
+      }
+
+      default:
+        memcached_quit_server(instance, true);
+        error = memcached_set_errno(*instance, local_errno, MEMCACHED_AT);
+        return false;
+      }
+    }
+
+#  if HAVE_IO_ZEROCOPY
+    if (zerocopy) {
+      ++zerocopy_pending;
+    }
+#  endif
+
+    instance->io_bytes_sent += uint32_t(sent_length);
+    total -= size_t(sent_length);
+
+    size_t consumed = size_t(sent_length);
+    while (msg.msg_iovlen and consumed >= msg.msg_iov->iov_len) {
+      consumed -= msg.msg_iov->iov_len;
+      ++msg.msg_iov;
+      --msg.msg_iovlen;
+    }
+    if (consumed) {
+      msg.msg_iov->iov_base = static_cast<char *>(msg.msg_iov->iov_base) + consumed;
+      msg.msg_iov->iov_len -= consumed;
+    }
+  }
+
+  instance->write_buffer_offset = 0;
+
+#  if HAVE_IO_ZEROCOPY
+  if (zerocopy_pending) {
+    return io_zerocopy_wait(instance, zerocopy_pending, error);
+  }
+#  endif
+
+  return true;
+}
+#endif // HAVE_SENDMSG && HAVE_STRUCT_MSGHDR
+
 bool memcached_io_writev(memcached_instance_st *instance, libmemcached_io_vector_st vector[],
                          const size_t number_of, const bool with_flush) {
   ssize_t complete_total = 0;
   ssize_t total = 0;
 
+#if HAVE_SENDMSG && HAVE_STRUCT_MSGHDR
+  const uint32_t threshold = instance->root->io_sendmsg_threshold;
+  if (threshold and number_of < IO_SENDMSG_MAX_IOV) {
+    size_t largest = 0;
+    for (size_t x = 0; x < number_of; ++x) {
+      if (vector[x].length > largest) {
+        largest = vector[x].length;
+      }
+    }
+
+    if (largest >= threshold) {
+      memcached_return_t rc;
+      return io_sendmsg(instance, vector, number_of, largest, with_flush, rc);
+    }
+  }
+#endif
+
   for (size_t x = 0; x < number_of; x++, vector++) {
     complete_total += vector->length;
     if (vector->length) {
@@ -666,49 +1098,167 @@ void memcached_instance_st::close_socket() {
   cursor_active_ = 0;
   io_bytes_sent = 0;
   write_buffer_offset = size_t(root and memcached_is_udp(root) ? UDP_DATAGRAM_HEADER_LENGTH : 0);
-  read_buffer_length = 0;
-  read_ptr = read_buffer;
+  memcached_io_buffers_free(this, root and memcached_is_udp(root));
   options.is_shutting_down = false;
+  options.is_zerocopy = false;
+  options.is_epoll_registered = false; // closing removed it from the epoll set
   memcached_server_response_reset(this);
+  memcached_async_reset(this);
 
   // We reset the version so that if we end up talking to a different server
   // we don't have stale server version information.
   major_version = minor_version = micro_version = UINT8_MAX;
 }
 
-memcached_instance_st *memcached_io_get_readable_server(Memcached *memc, memcached_return_t &) {
-#define MAX_SERVERS_TO_POLL 100
-  struct pollfd fds[MAX_SERVERS_TO_POLL];
-  nfds_t host_index = 0;
+void memcached_io_epoll_reset(Memcached *memc) {
+  if (memc->io_epoll != -1) {
+#if HAVE_SYS_EPOLL_H && HAVE_EPOLL_CREATE1
+    (void) close(memc->io_epoll);
+#endif
+    memc->io_epoll = -1;
 
-  for (uint32_t x = 0; x < memcached_server_count(memc) and host_index < MAX_SERVERS_TO_POLL; ++x) {
-    memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+    for (uint32_t x = 0; x < memcached_server_count(memc); ++x) {
+      memcached_instance_fetch(memc, x)->options.is_epoll_registered = false;
+    }
+  }
+}
 
-    if (instance->read_buffer_length > 0) /* I have data in the buffer */ {
-      return instance;
+#if HAVE_SYS_EPOLL_H && HAVE_EPOLL_CREATE1
+#  define IO_EPOLL_EVENTS 64
+
+/*
+  Add all instances awaiting responses to the persistent epoll set; they stay
+  registered until their socket is closed or they turn readable while idle.
+*/
+static bool io_epoll_prepare(Memcached *memc) {
+  if (memc->io_epoll == -1) {
+    if ((memc->io_epoll = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+      return false;
     }
+  }
 
-    if (instance->response_count() > 0) {
-      fds[host_index].events = POLLIN;
-      fds[host_index].revents = 0;
-      fds[host_index].fd = instance->fd;
-      ++host_index;
+  for (uint32_t x = 0; x < memcached_server_count(memc); ++x) {
+    memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+
+    if (instance->response_count() > 0 and instance->options.is_epoll_registered == false) {
+      struct epoll_event event;
+      event.events = EPOLLIN;
+      event.data.ptr = instance;
+
+      if (epoll_ctl(memc->io_epoll, EPOLL_CTL_ADD, instance->fd, &event) == -1
+          and errno != EEXIST) {
+        memcached_io_epoll_reset(memc);
+        return false;
+      }
+      instance->options.is_epoll_registered = true;
     }
   }
 
-  if (host_index < 2) {
-    /* We have 0 or 1 server with pending events.. */
-    for (uint32_t x = 0; x < memcached_server_count(memc); ++x) {
-      memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+  return true;
+}
+
+/* The part of the poll timeout left since start, so that retries do not wait longer in total */
+static int32_t io_epoll_remaining(const Memcached *memc, int64_t start) {
+  timespec tspec{}; // for clock_gettime()
+
+  if (memc->poll_timeout <= 0) {
+    return memc->poll_timeout;
+  }
+  if (start == 0 or clock_gettime(CLOCK_MONOTONIC, &tspec)) {
+    return 0; /* safety if clock_gettime is broken */
+  }
+
+  int64_t elapsed = (tspec.tv_sec * 1000000000 + tspec.tv_nsec - start) / 1000000; // ms
+  if (elapsed >= memc->poll_timeout) {
+    return 0;
+  }
+  return int32_t(memc->poll_timeout - elapsed);
+}
+
+static memcached_instance_st *io_epoll_wait(Memcached *memc) {
+  struct epoll_event events[IO_EPOLL_EVENTS];
+  timespec tspec{}; // for clock_gettime()
+  int64_t start = 0; // ns
+  int32_t timeout = memc->poll_timeout; // ms, what is left of it
+
+  if (timeout > 0 and clock_gettime(CLOCK_MONOTONIC, &tspec) == 0) {
+    start = tspec.tv_sec * 1000000000 + tspec.tv_nsec;
+  }
+
+  while (true) {
+    int ready = epoll_wait(memc->io_epoll, events, IO_EPOLL_EVENTS, timeout);
+
+    if (ready == -1) {
+      if (errno == EINTR) {
+        if ((timeout = io_epoll_remaining(memc, start)) == 0) {
+          return NULL;
+        }
+        continue;
+      }
+      memcached_set_errno(*memc, errno, MEMCACHED_AT);
+      return NULL;
+    }
+    if (ready == 0) {
+      return NULL;
+    }
+
+    memcached_instance_st *found = NULL;
+    for (int x = 0; x < ready; ++x) {
+      memcached_instance_st *instance = static_cast<memcached_instance_st *>(events[x].data.ptr);
 
       if (instance->response_count() > 0) {
-        return instance;
+        if (found == NULL) {
+          found = instance;
+        }
+      } else {
+        /* nothing expected from it, so do not let it wake us up again */
+        (void) epoll_ctl(memc->io_epoll, EPOLL_CTL_DEL, instance->fd, NULL);
+        instance->options.is_epoll_registered = false;
       }
     }
 
-    return NULL;
+    if (found) {
+      return found;
+    }
+    if ((timeout = io_epoll_remaining(memc, start)) == 0) {
+      return NULL;
+    }
+  }
+}
+#endif
+
+static memcached_instance_st *io_poll_readable(Memcached *memc, uint32_t pending) {
+#define MAX_SERVERS_TO_POLL 100
+  struct pollfd fds_buffer[MAX_SERVERS_TO_POLL];
+  memcached_instance_st *instances_buffer[MAX_SERVERS_TO_POLL];
+  struct pollfd *fds = fds_buffer;
+  memcached_instance_st **instances = instances_buffer;
+
+  if (pending > MAX_SERVERS_TO_POLL) {
+    fds = libmemcached_xcalloc(memc, pending, struct pollfd);
+    instances = libmemcached_xcalloc(memc, pending, memcached_instance_st *);
+    if (fds == NULL or instances == NULL) {
+      libmemcached_free(memc, fds);
+      libmemcached_free(memc, instances);
+      memcached_set_error(*memc, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+      return NULL;
+    }
+  }
+
+  nfds_t host_index = 0;
+  for (uint32_t x = 0; x < memcached_server_count(memc) and host_index < pending; ++x) {
+    memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+
+    if (instance->response_count() > 0) {
+      fds[host_index].events = POLLIN;
+      fds[host_index].revents = 0;
+      fds[host_index].fd = instance->fd;
+      instances[host_index] = instance;
+      ++host_index;
+    }
   }
 
+  memcached_instance_st *found = NULL;
   int error = poll(fds, host_index, memc->poll_timeout);
   switch (error) {
   case -1:
@@ -720,18 +1270,57 @@ memcached_instance_st *memcached_io_get_readable_server(Memcached *memc, memcach
   default:
     for (nfds_t x = 0; x < host_index; ++x) {
       if (fds[x].revents & POLLIN) {
-        for (uint32_t y = 0; y < memcached_server_count(memc); ++y) {
-          memcached_instance_st *instance = memcached_instance_fetch(memc, y);
-
-          if (instance->fd == fds[x].fd) {
-            return instance;
-          }
-        }
+        found = instances[x];
+        break;
       }
     }
   }
 
-  return NULL;
+  if (fds != fds_buffer) {
+    libmemcached_free(memc, fds);
+    libmemcached_free(memc, instances);
+  }
+
+  return found;
+}
+
+memcached_instance_st *memcached_io_get_readable_server(Memcached *memc, memcached_return_t &) {
+  uint32_t pending = 0;
+  memcached_instance_st *last_pending = NULL;
+
+  for (uint32_t x = 0; x < memcached_server_count(memc); ++x) {
+    memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+
+    if (instance->read_buffer_length > 0) /* I have data in the buffer */ {
+      return instance;
+    }
+
+    if (instance->response_count() > 0) {
+      last_pending = instance;
+      ++pending;
+    }
+  }
+
+  if (pending < 2) {
+    /* We have 0 or 1 server with pending events.. */
+    return last_pending;
+  }
+
+  if (memcached_io_ring_enabled(memc)) {
+    /* try to fill all pending read buffers with a single syscall first */
+    memcached_instance_st *ready = memcached_io_ring_fill(memc);
+    if (ready) {
+      return ready;
+    }
+  }
+
+#if HAVE_SYS_EPOLL_H && HAVE_EPOLL_CREATE1
+  if (io_epoll_prepare(memc)) {
+    return io_epoll_wait(memc);
+  }
+#endif
+
+  return io_poll_readable(memc, pending);
 }
 
 /*
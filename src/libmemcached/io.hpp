@@ -30,9 +30,30 @@ memcached_return_t memcached_io_wait_for_read(memcached_instance_st *);
 
 void memcached_io_reset(memcached_instance_st *ptr);
 
+/*
+  The read and write buffers of an instance are allocated on connect with
+  MEMCACHED_BEHAVIOR_IO_BUFFER_MIN bytes, doubled up to MEMCACHED_BEHAVIOR_IO_BUFFER_MAX
+  while responses or batched requests keep filling them, halved again after
+  MEMCACHED_IO_BUFFER_SHRINK_ROUNDS reads or flushes in a row used no more than a quarter,
+  and released when the connection is closed.
+*/
+#define MEMCACHED_IO_BUFFER_SHRINK_ROUNDS 16
+#define MEMCACHED_IO_BUFFER_LOWER_LIMIT   256
+
+memcached_return_t memcached_io_buffers_init(memcached_instance_st *ptr);
+void memcached_io_buffers_free(memcached_instance_st *ptr, bool keep_write_buffer);
+
+/* Adapt the size of the read buffer to the data it has just been filled with */
+void memcached_io_read_buffer_adapt(memcached_instance_st *ptr);
+
 memcached_return_t memcached_io_read(memcached_instance_st *ptr, void *buffer, size_t length,
                                      ssize_t &nread);
 
+/* Point data at the next length bytes of input without copying them, if they fit into the read
+   buffer; the data stays valid until the next read from the instance */
+memcached_return_t memcached_io_read_view(memcached_instance_st *ptr, size_t length,
+                                          const char *&data);
+
 /* Read a line (terminated by '\n') into the buffer */
 memcached_return_t memcached_io_readline(memcached_instance_st *ptr, char *buffer_ptr, size_t size,
                                          size_t &total);
@@ -42,6 +63,9 @@ memcached_return_t memcached_safe_read(memcached_instance_st *ptr, void *dta, co
 
 memcached_instance_st *memcached_io_get_readable_server(memcached_st *memc, memcached_return_t &);
 
+/* Drop the epoll set used by memcached_io_get_readable_server(), e.g. when the instances move */
+void memcached_io_epoll_reset(memcached_st *memc);
+
 memcached_return_t memcached_io_slurp(memcached_instance_st *ptr);
 
 #define IO_POLL_CONNECT 0
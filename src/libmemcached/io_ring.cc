@@ -0,0 +1,349 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#include "libmemcached/common.h"
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(HAVE___NR_IO_URING_SETUP)
+#  define HAVE_IO_RING 1
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+#if HAVE_IO_RING
+
+struct memcached_io_ring_st {
+  int fd;
+  unsigned entries;
+
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  struct io_uring_sqe *sqes;
+
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned *cq_mask;
+  struct io_uring_cqe *cqes;
+
+  void *sq_ptr;
+  size_t sq_size;
+  void *cq_ptr;
+  size_t cq_size;
+  size_t sqes_size;
+};
+
+typedef void (*io_ring_complete_fn)(memcached_instance_st *, int res,
+                                    memcached_instance_st *&ready);
+
+static void io_ring_unmap(memcached_io_ring_st *ring) {
+  if (ring->sqes) {
+    munmap(ring->sqes, ring->sqes_size);
+  }
+  if (ring->cq_ptr and ring->cq_ptr != ring->sq_ptr) {
+    munmap(ring->cq_ptr, ring->cq_size);
+  }
+  if (ring->sq_ptr) {
+    munmap(ring->sq_ptr, ring->sq_size);
+  }
+  if (ring->fd != -1) {
+    close(ring->fd);
+  }
+}
+
+memcached_return_t memcached_io_ring_init(memcached_st *memc) {
+  if (memc->io_ring) {
+    return MEMCACHED_SUCCESS;
+  }
+
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  int fd = int(syscall(__NR_io_uring_setup, MEMCACHED_IO_RING_ENTRIES, &params));
+  if (fd == -1) {
+    return memcached_set_errno(*memc, errno, MEMCACHED_AT,
+                               memcached_literal_param("io_uring_setup()"));
+  }
+
+  memcached_io_ring_st *ring = libmemcached_xcalloc(memc, 1, memcached_io_ring_st);
+  if (ring == NULL) {
+    close(fd);
+    return memcached_set_error(*memc, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+  ring->fd = fd;
+  ring->entries = params.sq_entries;
+
+  ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring->cq_size > ring->sq_size) {
+      ring->sq_size = ring->cq_size;
+    }
+    ring->cq_size = ring->sq_size;
+  }
+
+  void *ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                   IORING_OFF_SQ_RING);
+  if (ptr == MAP_FAILED) {
+    goto mmap_failed;
+  }
+  ring->sq_ptr = ptr;
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    ring->cq_ptr = ring->sq_ptr;
+  } else {
+    ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+               IORING_OFF_CQ_RING);
+    if (ptr == MAP_FAILED) {
+      goto mmap_failed;
+    }
+    ring->cq_ptr = ptr;
+  }
+
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ptr = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+             IORING_OFF_SQES);
+  if (ptr == MAP_FAILED) {
+    goto mmap_failed;
+  }
+  ring->sqes = static_cast<struct io_uring_sqe *>(ptr);
+
+  ring->sq_head = reinterpret_cast<unsigned *>(static_cast<char *>(ring->sq_ptr) + params.sq_off.head);
+  ring->sq_tail = reinterpret_cast<unsigned *>(static_cast<char *>(ring->sq_ptr) + params.sq_off.tail);
+  ring->sq_mask =
+      reinterpret_cast<unsigned *>(static_cast<char *>(ring->sq_ptr) + params.sq_off.ring_mask);
+  ring->sq_array =
+      reinterpret_cast<unsigned *>(static_cast<char *>(ring->sq_ptr) + params.sq_off.array);
+  ring->cq_head = reinterpret_cast<unsigned *>(static_cast<char *>(ring->cq_ptr) + params.cq_off.head);
+  ring->cq_tail = reinterpret_cast<unsigned *>(static_cast<char *>(ring->cq_ptr) + params.cq_off.tail);
+  ring->cq_mask =
+      reinterpret_cast<unsigned *>(static_cast<char *>(ring->cq_ptr) + params.cq_off.ring_mask);
+  ring->cqes = reinterpret_cast<struct io_uring_cqe *>(static_cast<char *>(ring->cq_ptr)
+                                                       + params.cq_off.cqes);
+
+  memc->io_ring = ring;
+  return MEMCACHED_SUCCESS;
+
+mmap_failed:
+  int local_errno = errno;
+  io_ring_unmap(ring);
+  libmemcached_free(memc, ring);
+  return memcached_set_errno(*memc, local_errno, MEMCACHED_AT, memcached_literal_param("mmap()"));
+}
+
+void memcached_io_ring_free(memcached_st *memc) {
+  if (memc->io_ring) {
+    io_ring_unmap(memc->io_ring);
+    libmemcached_free(memc, memc->io_ring);
+    memc->io_ring = NULL;
+  }
+}
+
+static void io_ring_prep(memcached_io_ring_st *ring, unsigned &tail, uint8_t opcode,
+                         memcached_instance_st *instance, void *buffer, size_t length) {
+  unsigned index = tail & *ring->sq_mask;
+  struct io_uring_sqe *sqe = &ring->sqes[index];
+
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = instance->fd;
+  sqe->addr = uint64_t(uintptr_t(buffer));
+  sqe->len = uint32_t(length);
+  sqe->msg_flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+  sqe->user_data = uint64_t(uintptr_t(instance));
+
+  ring->sq_array[index] = index;
+  ++tail;
+}
+
+/*
+  Submit everything queued since the last call and reap exactly as many
+  completions. A failing io_uring_enter() tears the ring down, which makes
+  the caller fall back to the poll() path for good.
+*/
+static void io_ring_submit(memcached_st *memc, unsigned tail, unsigned count,
+                           io_ring_complete_fn complete, memcached_instance_st *&ready) {
+  memcached_io_ring_st *ring = memc->io_ring;
+  unsigned reaped = 0;
+
+  __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+  while (reaped < count) {
+    unsigned pending = tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    long ret = syscall(__NR_io_uring_enter, ring->fd, pending, count - reaped,
+                       IORING_ENTER_GETEVENTS, NULL, 0);
+
+    if (ret == -1) {
+      switch (errno) {
+      case EINTR:
+      case EAGAIN:
+      case EBUSY:
+        break;
+      default:
+        memcached_set_errno(*memc, errno, MEMCACHED_AT,
+                            memcached_literal_param("io_uring_enter()"));
+        memcached_io_ring_free(memc);
+        return;
+      }
+    }
+
+    unsigned head = *ring->cq_head;
+    unsigned cq_tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; head != cq_tail; ++head, ++reaped) {
+      struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+      complete(reinterpret_cast<memcached_instance_st *>(uintptr_t(cqe->user_data)), cqe->res,
+               ready);
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+  }
+}
+
+static void io_ring_send_complete(memcached_instance_st *instance, int res,
+                                  memcached_instance_st *&) {
+  if (res > 0) {
+    size_t sent = size_t(res);
+
+    instance->io_bytes_sent += uint32_t(sent);
+    if (sent < instance->write_buffer_offset) {
+      memmove(instance->write_buffer, instance->write_buffer + sent,
+              instance->write_buffer_offset - sent);
+    }
+    instance->write_buffer_offset -= sent;
+  }
+  /* errors and short writes are left to io_flush() */
+}
+
+memcached_return_t memcached_io_ring_flush(memcached_st *memc) {
+  memcached_return_t rc = MEMCACHED_SUCCESS;
+  memcached_instance_st *unused = NULL;
+  uint32_t x = 0;
+
+  while (memcached_io_ring_enabled(memc) and x < memcached_server_count(memc)) {
+    memcached_io_ring_st *ring = memc->io_ring;
+    unsigned tail = *ring->sq_tail;
+    unsigned count = 0;
+
+    for (; x < memcached_server_count(memc) and count < ring->entries; ++x) {
+      memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+
+      if (instance->fd == INVALID_SOCKET or instance->write_buffer_offset == 0) {
+        continue;
+      }
+      if (memcached_purge(instance) == false) {
+        continue;
+      }
+      io_ring_prep(ring, tail, IORING_OP_SEND, instance, instance->write_buffer,
+                   instance->write_buffer_offset);
+      ++count;
+    }
+
+    if (count) {
+      io_ring_submit(memc, tail, count, io_ring_send_complete, unused);
+    }
+  }
+
+  for (x = 0; x < memcached_server_count(memc); ++x) {
+    memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+
+    if (instance->fd != INVALID_SOCKET and instance->write_buffer_offset) {
+      if (memcached_io_write(instance) == false) {
+        rc = MEMCACHED_SOME_ERRORS;
+      }
+    }
+  }
+
+  return rc;
+}
+
+static void io_ring_recv_complete(memcached_instance_st *instance, int res,
+                                  memcached_instance_st *&ready) {
+  if (res > 0) {
+    instance->io_wait_count._bytes_read += size_t(res);
+    instance->io_bytes_sent = 0;
+    instance->read_buffer_length = size_t(res);
+    instance->read_ptr = instance->read_buffer;
+    memcached_io_read_buffer_adapt(instance);
+  } else {
+    switch (-res) {
+#  if EWOULDBLOCK != EAGAIN
+    case EWOULDBLOCK:
+#  endif
+    case EAGAIN:
+    case EINTR:
+    case EINVAL:
+    case EOPNOTSUPP:
+      return;
+
+    default:
+      /* EOF or a socket error, which the regular read path is going to report */
+      break;
+    }
+  }
+
+  if (ready == NULL) {
+    ready = instance;
+  }
+}
+
+memcached_instance_st *memcached_io_ring_fill(memcached_st *memc) {
+  memcached_instance_st *ready = NULL;
+  uint32_t x = 0;
+
+  while (memcached_io_ring_enabled(memc) and x < memcached_server_count(memc)) {
+    memcached_io_ring_st *ring = memc->io_ring;
+    unsigned tail = *ring->sq_tail;
+    unsigned count = 0;
+
+    for (; x < memcached_server_count(memc) and count < ring->entries; ++x) {
+      memcached_instance_st *instance = memcached_instance_fetch(memc, x);
+
+      if (instance->fd == INVALID_SOCKET or instance->response_count() == 0
+          or instance->read_buffer_length)
+      {
+        continue;
+      }
+      io_ring_prep(ring, tail, IORING_OP_RECV, instance, instance->read_buffer,
+                   instance->read_buffer_size);
+      ++count;
+    }
+
+    if (count) {
+      io_ring_submit(memc, tail, count, io_ring_recv_complete, ready);
+    }
+  }
+
+  return ready;
+}
+
+#else // !HAVE_IO_RING
+
+memcached_return_t memcached_io_ring_init(memcached_st *memc) {
+  return memcached_set_error(*memc, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
+                             memcached_literal_param("io_uring is not available on this platform"));
+}
+
+void memcached_io_ring_free(memcached_st *) {}
+
+memcached_return_t memcached_io_ring_flush(memcached_st *) {
+  return MEMCACHED_NOT_SUPPORTED;
+}
+
+memcached_instance_st *memcached_io_ring_fill(memcached_st *) {
+  return NULL;
+}
+
+#endif // HAVE_IO_RING
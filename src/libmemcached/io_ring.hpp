@@ -0,0 +1,39 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/*
+  Optional io_uring backend, see MEMCACHED_BEHAVIOR_IO_URING.
+
+  All operations are submitted with MSG_DONTWAIT and reaped before returning,
+  so no buffer of an instance is ever left in flight; anything the ring could
+  not complete is handled by the regular send()/recv()/poll() path afterwards.
+*/
+
+#define MEMCACHED_IO_RING_ENTRIES 256
+
+memcached_return_t memcached_io_ring_init(memcached_st *);
+void memcached_io_ring_free(memcached_st *);
+
+static inline bool memcached_io_ring_enabled(const memcached_st *memc) {
+  return memc->io_ring and memc->flags.use_udp == false;
+}
+
+/* Send the pending write buffers of all instances in one batch */
+memcached_return_t memcached_io_ring_flush(memcached_st *);
+
+/* Receive into the empty read buffers of all instances awaiting responses in one batch */
+memcached_instance_st *memcached_io_ring_fill(memcached_st *);
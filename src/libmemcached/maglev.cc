@@ -0,0 +1,161 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#include "libmemcached/common.h"
+#include "p9y/gettimeofday.hpp"
+
+/* primes, each about twice the previous one */
+static const uint32_t maglev_table_sizes[] = {
+    MEMCACHED_MAGLEV_TABLE_SIZE, 131071, 262147, 524287, 1048573, 2097143, 4194301, 8388593,
+    16777213};
+
+static uint32_t maglev_table_size(uint32_t server_count) {
+  const size_t count = sizeof(maglev_table_sizes) / sizeof(*maglev_table_sizes);
+
+  for (size_t x = 0; x < count; ++x) {
+    if (maglev_table_sizes[x] / MEMCACHED_MAGLEV_SLOTS_PER_SERVER >= server_count) {
+      return maglev_table_sizes[x];
+    }
+  }
+
+  return maglev_table_sizes[count - 1];
+}
+
+struct maglev_permutation {
+  uint32_t offset;
+  uint32_t skip;
+  uint32_t next;
+  uint32_t index;
+};
+
+static void maglev_permutation_init(maglev_permutation &permutation,
+                                    const memcached_instance_st &instance, uint32_t size) {
+  char name[MEMCACHED_NI_MAXHOST + 1 + MEMCACHED_NI_MAXSERV + 1];
+  unsigned char results[16];
+
+  int name_length =
+      snprintf(name, sizeof(name), "%s:%u", instance._hostname, (uint32_t) instance.port());
+  if (name_length < 0 or size_t(name_length) >= sizeof(name)) {
+    name_length = int(sizeof(name) - 1);
+  }
+
+  libhashkit_md5_signature((unsigned char *) name, size_t(name_length), results);
+
+  uint32_t h1 = uint32_t(results[0]) | uint32_t(results[1]) << 8 | uint32_t(results[2]) << 16
+      | uint32_t(results[3]) << 24;
+  uint32_t h2 = uint32_t(results[4]) | uint32_t(results[5]) << 8 | uint32_t(results[6]) << 16
+      | uint32_t(results[7]) << 24;
+
+  permutation.offset = h1 % size;
+  permutation.skip = h2 % (size - 1) + 1;
+  permutation.next = 0;
+}
+
+memcached_return_t memcached_maglev_update(Memcached *ptr) {
+  struct timeval now;
+
+  if (gettimeofday(&now, NULL)) {
+    return memcached_set_errno(*ptr, errno, MEMCACHED_AT);
+  }
+
+  if (ptr->maglev == NULL) {
+    if ((ptr->maglev = libmemcached_xmalloc(ptr, memcached_maglev_st)) == NULL) {
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    ptr->maglev->size = 0;
+    ptr->maglev->slots = NULL;
+  }
+
+  memcached_instance_st *list = memcached_instance_list(ptr);
+  uint32_t server_count = memcached_server_count(ptr);
+  bool is_auto_ejecting = _is_auto_eject_host(ptr);
+
+  /* size by all servers, so that ejecting some does not reshuffle the table */
+  uint32_t size = maglev_table_size(server_count);
+
+  maglev_permutation *permutations =
+      libmemcached_xvalloc(ptr, server_count ? server_count : 1, maglev_permutation);
+  if (permutations == NULL) {
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  if (is_auto_ejecting) {
+    ptr->ketama.next_distribution_rebuild = 0;
+  }
+
+  uint32_t live_servers = 0;
+  for (uint32_t host_index = 0; host_index < server_count; ++host_index) {
+    if (is_auto_ejecting and list[host_index].next_retry > now.tv_sec) {
+      if (ptr->ketama.next_distribution_rebuild == 0
+          or list[host_index].next_retry < ptr->ketama.next_distribution_rebuild)
+      {
+        ptr->ketama.next_distribution_rebuild = list[host_index].next_retry;
+      }
+      continue;
+    }
+
+    maglev_permutation_init(permutations[live_servers], list[host_index], size);
+    permutations[live_servers++].index = host_index;
+  }
+
+  if (live_servers == 0) {
+    libmemcached_free(ptr, permutations);
+    ptr->maglev->size = 0;
+    return MEMCACHED_SUCCESS;
+  }
+
+  if (size != ptr->maglev->size or ptr->maglev->slots == NULL) {
+    uint32_t *slots = libmemcached_xrealloc(ptr, ptr->maglev->slots, size, uint32_t);
+    if (slots == NULL) {
+      libmemcached_free(ptr, permutations);
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    ptr->maglev->slots = slots;
+  }
+  ptr->maglev->size = size;
+
+  uint32_t *slots = ptr->maglev->slots;
+  for (uint32_t x = 0; x < size; ++x) {
+    slots[x] = UINT32_MAX;
+  }
+
+  /* the servers take turns claiming their next preferred slot still free */
+  for (uint32_t filled = 0;;) {
+    for (uint32_t x = 0; x < live_servers; ++x) {
+      maglev_permutation &permutation = permutations[x];
+      uint32_t slot;
+
+      do {
+        slot = uint32_t((permutation.offset + uint64_t(permutation.skip) * permutation.next++)
+                        % size);
+      } while (slots[slot] != UINT32_MAX);
+
+      slots[slot] = permutation.index;
+
+      if (++filled == size) {
+        libmemcached_free(ptr, permutations);
+        return MEMCACHED_SUCCESS;
+      }
+    }
+  }
+}
+
+void memcached_maglev_free(Memcached *ptr) {
+  if (ptr->maglev) {
+    libmemcached_free(ptr, ptr->maglev->slots);
+    libmemcached_free(ptr, ptr->maglev);
+    ptr->maglev = NULL;
+  }
+}
@@ -0,0 +1,46 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/*
+  Maglev lookup table, see MEMCACHED_DISTRIBUTION_MAGLEV.
+
+  Every live server claims slots of a prime sized table in the order of its own
+  permutation of the slots, taking turns, so a lookup is a single table read and
+  a change of the live servers reassigns few slots. The table has at least
+  MEMCACHED_MAGLEV_SLOTS_PER_SERVER slots per server.
+*/
+
+#define MEMCACHED_MAGLEV_TABLE_SIZE       65537
+#define MEMCACHED_MAGLEV_SLOTS_PER_SERVER 100
+
+struct memcached_maglev_st {
+  uint32_t size;
+  uint32_t *slots;
+};
+
+/* Rebuild the table from the live servers, called by run_distribution() */
+memcached_return_t memcached_maglev_update(memcached_st *);
+void memcached_maglev_free(memcached_st *);
+
+static inline uint32_t memcached_maglev_get(const memcached_st *ptr, uint32_t hash) {
+  if (ptr->maglev and ptr->maglev->size) {
+    return ptr->maglev->slots[hash % ptr->maglev->size];
+  }
+
+  /* no live servers */
+  return hash % memcached_server_count(ptr);
+}
@@ -41,6 +41,10 @@ static inline bool _memcached_init(Memcached *self) {
   self->flags.is_fetching_version = false;
 
   self->virtual_bucket = NULL;
+  self->rendezvous = NULL;
+  self->maglev = NULL;
+  self->io_ring = NULL;
+  self->io_epoll = -1;
 
   self->distribution = MEMCACHED_DISTRIBUTION_MODULA;
 
@@ -51,6 +55,7 @@ static inline bool _memcached_init(Memcached *self) {
   self->server_info.version = 0;
 
   self->ketama.continuum = NULL;
+  self->ketama.continuum_search = NULL;
   self->ketama.continuum_count = 0;
   self->ketama.continuum_points_counter = 0;
   self->ketama.next_distribution_rebuild = 0;
@@ -73,10 +78,23 @@ static inline bool _memcached_init(Memcached *self) {
   self->tcp_keepidle = 0;
 
   self->io_key_prefetch = 0;
+  self->io_sendmsg_threshold = MEMCACHED_DEFAULT_IO_SENDMSG_THRESHOLD;
+  self->io_zerocopy_threshold = 0;
+  self->io_buffer_min = MEMCACHED_DEFAULT_IO_BUFFER_MIN;
+  self->io_buffer_max = MEMCACHED_DEFAULT_IO_BUFFER_MAX;
+  self->encryption_ctr_flag = 0;
+  self->compression.flag = 0;
+  self->compression.threshold = MEMCACHED_DEFAULT_COMPRESSION_THRESHOLD;
+  self->compression.ratio = MEMCACHED_DEFAULT_COMPRESSION_RATIO;
+  self->compression.level = 0;
+  self->compression.algorithm = memcached_compression_default();
+  self->compression.context = NULL;
+  memcached_compression_stat_reset(self);
   self->poll_timeout = MEMCACHED_DEFAULT_TIMEOUT;
   self->connect_timeout = MEMCACHED_DEFAULT_CONNECT_TIMEOUT;
   self->retry_timeout = MEMCACHED_SERVER_FAILURE_RETRY_TIMEOUT;
   self->dead_timeout = MEMCACHED_SERVER_FAILURE_DEAD_TIMEOUT;
+  self->dns_ttl = 0;
 
   self->send_size = -1;
   self->recv_size = -1;
@@ -98,6 +116,7 @@ static inline bool _memcached_init(Memcached *self) {
   self->_namespace = NULL;
   self->configure.initial_pool_size = 1;
   self->configure.max_pool_size = 1;
+  self->configure.pool_thread_cache = false;
   self->configure.version = -1;
   self->configure.filename = NULL;
 
@@ -107,6 +126,7 @@ static inline bool _memcached_init(Memcached *self) {
 static void memcached_free_ex(Memcached *ptr, bool release_st) {
   /* If we have anything open, lets close it now */
   send_quit(ptr);
+  memcached_io_epoll_reset(ptr);
   memcached_instance_list_free(memcached_instance_list(ptr), memcached_instance_list_count(ptr));
   memcached_result_free(&ptr->result);
 
@@ -120,10 +140,17 @@ static void memcached_free_ex(Memcached *ptr, bool release_st) {
 
   libmemcached_free(ptr, ptr->ketama.continuum);
   ptr->ketama.continuum = NULL;
+  libmemcached_free(ptr, ptr->ketama.continuum_search);
+  ptr->ketama.continuum_search = NULL;
+  memcached_rendezvous_free(ptr);
+  memcached_maglev_free(ptr);
+  memcached_compression_free(ptr);
 
   memcached_array_free(ptr->_namespace);
   ptr->_namespace = NULL;
 
+  memcached_io_ring_free(ptr);
+
   memcached_error_free(*ptr);
 
   if (LIBMEMCACHED_WITH_SASL_SUPPORT and ptr->sasl.callbacks) {
@@ -236,8 +263,12 @@ void memcached_servers_reset(memcached_st *shell) {
   if (self) {
     libmemcached_free(self, self->ketama.continuum);
     self->ketama.continuum = NULL;
+    libmemcached_free(self, self->ketama.continuum_search);
+    self->ketama.continuum_search = NULL;
     self->ketama.continuum_count = 0;
     self->ketama.continuum_points_counter = 0;
+    memcached_rendezvous_free(self);
+    memcached_maglev_free(self);
 
     memcached_instance_list_free(memcached_instance_list(self), self->number_of_hosts);
     memcached_instance_set(self, NULL, 0);
@@ -287,6 +318,7 @@ memcached_st *memcached_clone(memcached_st *clone, const memcached_st *source) {
   new_clone->connect_timeout = source->connect_timeout;
   new_clone->retry_timeout = source->retry_timeout;
   new_clone->dead_timeout = source->dead_timeout;
+  new_clone->dns_ttl = source->dns_ttl;
   new_clone->distribution = source->distribution;
 
   if (hashkit_clone(&new_clone->hashkit, &source->hashkit) == NULL) {
@@ -311,6 +343,16 @@ memcached_st *memcached_clone(memcached_st *clone, const memcached_st *source) {
   new_clone->io_msg_watermark = source->io_msg_watermark;
   new_clone->io_bytes_watermark = source->io_bytes_watermark;
   new_clone->io_key_prefetch = source->io_key_prefetch;
+  new_clone->io_sendmsg_threshold = source->io_sendmsg_threshold;
+  new_clone->io_zerocopy_threshold = source->io_zerocopy_threshold;
+  new_clone->io_buffer_min = source->io_buffer_min;
+  new_clone->io_buffer_max = source->io_buffer_max;
+  new_clone->encryption_ctr_flag = source->encryption_ctr_flag;
+  new_clone->compression.flag = source->compression.flag;
+  new_clone->compression.threshold = source->compression.threshold;
+  new_clone->compression.ratio = source->compression.ratio;
+  new_clone->compression.level = source->compression.level;
+  new_clone->compression.algorithm = source->compression.algorithm;
   new_clone->number_of_replicas = source->number_of_replicas;
   new_clone->tcp_keepidle = source->tcp_keepidle;
 
@@ -337,6 +379,11 @@ memcached_st *memcached_clone(memcached_st *clone, const memcached_st *source) {
     return NULL;
   }
 
+  if (source->io_ring and memcached_failed(memcached_io_ring_init(new_clone))) {
+    memcached_free(new_clone);
+    return NULL;
+  }
+
   if (source->on_clone) {
     source->on_clone(new_clone, source);
   }
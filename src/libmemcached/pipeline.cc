@@ -0,0 +1,306 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#include "libmemcached/common.h"
+
+#include <algorithm>
+
+/*
+  memcached_purge() would discard the responses memcached_pipeline() reads itself; its window
+  bounds the responses queued by the servers instead.
+*/
+class NoPurge {
+public:
+  NoPurge(Memcached *memc)
+  : _memc(memc)
+  , _purging(memc->state.is_purging) {
+    _memc->state.is_purging = true;
+  }
+
+  ~NoPurge() {
+    _memc->state.is_purging = _purging;
+  }
+
+private:
+  Memcached *_memc;
+  bool _purging;
+};
+
+static memcached_return_t pipeline_status(const uint16_t status) {
+  switch (status) {
+  case PROTOCOL_BINARY_RESPONSE_SUCCESS:
+    return MEMCACHED_SUCCESS;
+
+  case PROTOCOL_BINARY_RESPONSE_KEY_ENOENT:
+    return MEMCACHED_NOTFOUND;
+
+  case PROTOCOL_BINARY_RESPONSE_KEY_EEXISTS:
+    return MEMCACHED_DATA_EXISTS;
+
+  case PROTOCOL_BINARY_RESPONSE_NOT_STORED:
+    return MEMCACHED_NOTSTORED;
+
+  case PROTOCOL_BINARY_RESPONSE_E2BIG:
+    return MEMCACHED_E2BIG;
+
+  case PROTOCOL_BINARY_RESPONSE_ENOMEM:
+    return MEMCACHED_MEMORY_ALLOCATION_FAILURE;
+
+  default:
+    break;
+  }
+
+  return MEMCACHED_UNKNOWN_READ_FAILURE;
+}
+
+/* Fails the first count requests of a window still awaiting a response of a server */
+static void pipeline_fail(const uint32_t server_key, const uint32_t *server_keys,
+                          memcached_return_t *rcs, const size_t count, memcached_return_t rc) {
+  for (size_t x = 0; x < count; ++x) {
+    if (server_keys[x] == server_key and rcs[x] == MEMCACHED_BUFFERED) {
+      rcs[x] = rc;
+    }
+  }
+}
+
+/*
+  Reads the responses of a server up to the NOOP terminating a window, identified by the position
+  of their key in the batch plus one as opaque.
+*/
+static memcached_return_t pipeline_binary_drain(memcached_instance_st *instance,
+                                                const uint8_t opcode, const uint32_t server_key,
+                                                const size_t base, const uint32_t *server_keys,
+                                                memcached_return_t *rcs, const size_t count) {
+  while (true) {
+    protocol_binary_response_header header;
+    memcached_return_t rc;
+
+    if (memcached_failed(rc = memcached_safe_read(instance, header.bytes, sizeof(header.bytes)))) {
+      return rc;
+    }
+    if (header.response.magic != PROTOCOL_BINARY_RES) {
+      return memcached_set_error(*instance, MEMCACHED_UNKNOWN_READ_FAILURE, MEMCACHED_AT);
+    }
+
+    /* discard values and error messages */
+    char hole[SMALL_STRING_LEN];
+    for (uint32_t bodylen = ntohl(header.response.bodylen); bodylen;) {
+      size_t nr = std::min(size_t(bodylen), sizeof(hole));
+      if (memcached_failed(rc = memcached_safe_read(instance, hole, nr))) {
+        return rc;
+      }
+      bodylen -= uint32_t(nr);
+    }
+
+    if (header.response.opcode == PROTOCOL_BINARY_CMD_NOOP) {
+      return MEMCACHED_SUCCESS;
+    }
+
+    uint32_t x = ntohl(header.response.opaque) - 1 - uint32_t(base);
+    if (header.response.opcode == opcode and x < count and server_keys[x] == server_key
+        and rcs[x] == MEMCACHED_BUFFERED)
+    {
+      rcs[x] = pipeline_status(ntohs(header.response.status));
+    }
+  }
+}
+
+memcached_return_t memcached_pipeline(Memcached *ptr, const char *group_key,
+                                      size_t group_key_length, const char *const *keys,
+                                      const size_t *key_length, size_t number_of_keys,
+                                      memcached_return_t *results, uint8_t opcode, bool reply,
+                                      memcached_pipeline_fn send, void *context) {
+  /* read any responses still pending, see mget_by_key_real() */
+  for (uint32_t x = 0; x < memcached_server_count(ptr); x++) {
+    memcached_instance_st *instance = memcached_instance_fetch(ptr, x);
+
+    if (instance->response_count()) {
+      char buffer[MEMCACHED_DEFAULT_COMMAND_SIZE];
+
+      if (ptr->flags.no_block || ptr->flags.buffer_requests) {
+        memcached_io_write(instance);
+      }
+
+      while (instance->response_count()) {
+        (void) memcached_response(instance, buffer, MEMCACHED_DEFAULT_COMMAND_SIZE, &ptr->result);
+      }
+    }
+  }
+
+  uint32_t master_server_key = 0;
+  bool is_group_key_set = false;
+  if (group_key and group_key_length) {
+    master_server_key =
+        memcached_generate_hash_with_redistribution(ptr, group_key, group_key_length);
+    is_group_key_set = true;
+  } else {
+    memcached_autoeject(ptr);
+  }
+
+  /* servers sent requests to in the current window, quiet ones do not count as responses */
+  const uint32_t server_count = memcached_server_count(ptr);
+  bool *sent_to = libmemcached_xcalloc(ptr, server_count, bool);
+  if (sent_to == NULL) {
+    return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+  }
+
+  /* the servers the senders replicate each key to, see memcached_send_binary() */
+  const uint32_t stride = ptr->number_of_replicas + 1;
+  uint32_t *replicas = NULL;
+  if (ptr->number_of_replicas) {
+    replicas = libmemcached_xvalloc(
+        ptr, (is_group_key_set ? 1 : MEMCACHED_PIPELINE_WINDOW) * stride, uint32_t);
+    if (replicas == NULL) {
+      libmemcached_free(ptr, sent_to);
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    if (is_group_key_set) {
+      memcached_generate_replicas_batch(ptr, &group_key, &group_key_length, 1, replicas, stride);
+    }
+  }
+
+  NoPurge no_purge(ptr);
+  const bool binary = memcached_is_binary(ptr);
+  bool failed = false;
+  uint32_t server_keys[MEMCACHED_PIPELINE_WINDOW];
+  memcached_return_t rcs[MEMCACHED_PIPELINE_WINDOW];
+
+  for (size_t base = 0; base < number_of_keys; base += MEMCACHED_PIPELINE_WINDOW) {
+    const size_t count = std::min(number_of_keys - base, size_t(MEMCACHED_PIPELINE_WINDOW));
+
+    std::fill(sent_to, sent_to + server_count, false);
+
+    if (is_group_key_set) {
+      std::fill(server_keys, server_keys + count, master_server_key);
+    } else {
+      for (size_t x = 0; x < count; x += MEMCACHED_HASH_BATCH) {
+        memcached_dispatch_hash_batch(ptr, keys + base + x, key_length + base + x,
+                                      std::min(count - x, size_t(MEMCACHED_HASH_BATCH)),
+                                      server_keys + x);
+      }
+      if (replicas) {
+        memcached_generate_replicas_batch(ptr, keys + base, key_length + base, count, replicas,
+                                          stride);
+      }
+    }
+
+    for (size_t x = 0; x < count; ++x) {
+      if (memcached_failed(rcs[x] = memcached_key_test(*ptr, keys + base + x,
+                                                       key_length + base + x, 1)))
+      {
+        continue;
+      }
+
+      memcached_instance_st *instance = memcached_instance_fetch(ptr, server_keys[x]);
+      rcs[x] = send(ptr, instance, server_keys[x], base + x, context);
+
+      /* replicas are sent quiet requests, too */
+      sent_to[server_keys[x]] = true;
+      if (replicas) {
+        const uint32_t *row = replicas + (is_group_key_set ? 0 : x * stride);
+        for (uint32_t r = 0; r < stride and row[r] < server_count; ++r) {
+          sent_to[row[r]] = true;
+        }
+      }
+
+      /* a failed write resets the connection, losing the requests sent before */
+      if (rcs[x] != MEMCACHED_BUFFERED and instance->fd == INVALID_SOCKET) {
+        pipeline_fail(server_keys[x], server_keys, rcs, x, rcs[x]);
+      }
+    }
+
+    /* flush the window, terminated by a NOOP per server with the binary protocol */
+    for (uint32_t s = 0; s < server_count; ++s) {
+      memcached_instance_st *instance = memcached_instance_fetch(ptr, s);
+
+      if (instance->fd == INVALID_SOCKET
+          or (sent_to[s] == false and instance->response_count() == 0
+              and instance->write_buffer_offset == 0))
+      {
+        continue;
+      }
+
+      bool sent;
+      if (binary and reply) {
+        protocol_binary_request_noop request = {};
+        initialize_binary_request(instance, request.message.header);
+        request.message.header.request.opcode = PROTOCOL_BINARY_CMD_NOOP;
+        request.message.header.request.datatype = PROTOCOL_BINARY_RAW_BYTES;
+
+        memcached_instance_response_reset(instance);
+        sent = memcached_io_write(instance, request.bytes, sizeof(request.bytes), true) != -1;
+        memcached_server_response_increment(instance);
+      } else {
+        sent = memcached_io_write(instance);
+      }
+
+      if (sent == false) {
+        memcached_io_reset(instance);
+        pipeline_fail(s, server_keys, rcs, count, MEMCACHED_WRITE_FAILURE);
+      }
+    }
+
+    if (reply and binary) {
+      for (uint32_t s = 0; s < server_count; ++s) {
+        memcached_instance_st *instance = memcached_instance_fetch(ptr, s);
+
+        if (instance->response_count()) {
+          memcached_instance_response_reset(instance);
+
+          memcached_return_t rc =
+              pipeline_binary_drain(instance, opcode, s, base, server_keys, rcs, count);
+          if (memcached_failed(rc)) {
+            if (instance->fd != INVALID_SOCKET) {
+              memcached_io_reset(instance);
+            }
+            pipeline_fail(s, server_keys, rcs, count, rc);
+          }
+        }
+      }
+    } else if (reply) {
+      for (size_t x = 0; x < count; ++x) {
+        if (rcs[x] == MEMCACHED_BUFFERED) {
+          memcached_instance_st *instance = memcached_instance_fetch(ptr, server_keys[x]);
+
+          rcs[x] = memcached_read_one_response(instance, NULL);
+          if (rcs[x] == MEMCACHED_STORED or rcs[x] == MEMCACHED_DELETED) {
+            rcs[x] = MEMCACHED_SUCCESS;
+          } else if (memcached_fatal(rcs[x])) {
+            if (instance->fd != INVALID_SOCKET) {
+              memcached_io_reset(instance);
+            }
+            pipeline_fail(server_keys[x], server_keys, rcs, count, rcs[x]);
+          }
+        }
+      }
+    }
+
+    for (size_t x = 0; x < count; ++x) {
+      /* quiet and noreply requests only respond on failure */
+      if (rcs[x] == MEMCACHED_BUFFERED) {
+        rcs[x] = MEMCACHED_SUCCESS;
+      }
+      if (results) {
+        results[base + x] = rcs[x];
+      }
+      failed = failed or memcached_failed(rcs[x]);
+    }
+  }
+
+  libmemcached_free(ptr, sent_to);
+  libmemcached_free(ptr, replicas);
+
+  return failed ? MEMCACHED_SOME_ERRORS : MEMCACHED_SUCCESS;
+}
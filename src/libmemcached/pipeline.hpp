@@ -0,0 +1,45 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/*
+  Pipelining of single key requests for arrays of keys, see memcached_mset().
+
+  The requests of a window of keys are sent to all of their servers before any
+  response is read, terminated by a NOOP per server with the binary protocol, so
+  that quiet requests need only respond on failure.
+*/
+
+/* The number of keys memcached_pipeline() sends before reading their responses */
+#define MEMCACHED_PIPELINE_WINDOW 512
+
+/*
+  Sends the request of the nth key to the instance of server_key, without flushing. Binary
+  requests carry n + 1 as opaque. Returns MEMCACHED_BUFFERED while a response is pending.
+*/
+typedef memcached_return_t (*memcached_pipeline_fn)(Memcached *, memcached_instance_st *,
+                                                    uint32_t server_key, size_t n, void *context);
+
+/*
+  Routes, tests and sends the keys with send, and stores the result of each key in results, if not
+  NULL. Binary responses of another opcode than opcode are discarded, none are read unless reply
+  is set. Returns MEMCACHED_SOME_ERRORS if any key failed.
+*/
+memcached_return_t memcached_pipeline(Memcached *, const char *group_key, size_t group_key_length,
+                                      const char *const *keys, const size_t *key_length,
+                                      size_t number_of_keys, memcached_return_t *results,
+                                      uint8_t opcode, bool reply, memcached_pipeline_fn send,
+                                      void *context);
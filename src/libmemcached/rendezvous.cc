@@ -0,0 +1,315 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#include "libmemcached/common.h"
+#include "p9y/gettimeofday.hpp"
+
+#include <cmath>
+
+struct memcached_rendezvous_node_st {
+  uint64_t seed;
+  double weight;
+  uint32_t index; // server key, or first node of a cluster
+  uint32_t count; // nodes of a cluster
+};
+
+struct memcached_rendezvous_st {
+  bool weighted;
+  bool clusters_weighted;
+  uint32_t node_count;
+  uint32_t node_size;
+  uint32_t cluster_count;
+  uint32_t cluster_size;
+  memcached_rendezvous_node_st *nodes;
+  memcached_rendezvous_node_st *clusters;
+};
+
+/* MurmurHash3's 64 bit finalizer */
+static inline uint64_t rendezvous_mix(uint64_t seed, uint32_t hash) {
+  uint64_t h = seed ^ (hash * 0x9E3779B97F4A7C15ULL);
+
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+
+  return h;
+}
+
+/*
+  With u uniform in (0, 1), -weight / ln(u) makes every node win with a probability
+  proportional to its weight. If all weights are equal, u alone ranks the same way.
+*/
+static inline double rendezvous_score(const memcached_rendezvous_node_st &node, uint32_t hash,
+                                      bool weighted) {
+  double u = (double(rendezvous_mix(node.seed, hash) >> 11) + 0.5) / 9007199254740992.0;
+
+  if (weighted) {
+    return node.weight / -::log(u);
+  }
+  return u;
+}
+
+/*
+  Find the node ranked next after the one at *position with *score, where nodes are
+  ranked by descending score and ascending position. Start with a score of HUGE_VAL.
+*/
+static uint32_t rendezvous_next(const memcached_rendezvous_node_st *nodes, uint32_t count,
+                                bool weighted, uint32_t hash, double *score, uint32_t *position) {
+  double best_score = -1;
+  uint32_t best = UINT32_MAX;
+
+  for (uint32_t x = 0; x < count; ++x) {
+    double node_score = rendezvous_score(nodes[x], hash, weighted);
+
+    if (node_score > *score or (node_score == *score and x <= *position)) {
+      continue; /* already ranked */
+    }
+    if (node_score > best_score) {
+      best_score = node_score;
+      best = x;
+    }
+  }
+
+  if (best != UINT32_MAX) {
+    *score = best_score;
+    *position = best;
+  }
+
+  return best;
+}
+
+static inline bool rendezvous_is_skeleton(const Memcached *ptr) {
+  return ptr->distribution == MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON;
+}
+
+static uint64_t rendezvous_server_seed(const memcached_instance_st &instance) {
+  char name[MEMCACHED_NI_MAXHOST + 1 + MEMCACHED_NI_MAXSERV + 1];
+  unsigned char results[16];
+  uint64_t seed = 0;
+
+  int name_length =
+      snprintf(name, sizeof(name), "%s:%u", instance._hostname, (uint32_t) instance.port());
+  if (name_length < 0 or size_t(name_length) >= sizeof(name)) {
+    name_length = int(sizeof(name) - 1);
+  }
+
+  libhashkit_md5_signature((unsigned char *) name, size_t(name_length), results);
+  for (uint32_t x = 0; x < 8; ++x) {
+    seed = (seed << 8) | results[x];
+  }
+
+  return seed;
+}
+
+/* Whether the server takes keys, else schedules the rebuild for when it is retried */
+static bool rendezvous_is_live(Memcached *ptr, const memcached_instance_st &instance,
+                               const struct timeval &now, bool is_auto_ejecting) {
+  if (is_auto_ejecting and instance.next_retry > now.tv_sec) {
+    if (ptr->ketama.next_distribution_rebuild == 0
+        or instance.next_retry < ptr->ketama.next_distribution_rebuild)
+    {
+      ptr->ketama.next_distribution_rebuild = instance.next_retry;
+    }
+    return false;
+  }
+
+  return true;
+}
+
+memcached_return_t memcached_rendezvous_update(Memcached *ptr) {
+  struct timeval now;
+
+  if (gettimeofday(&now, NULL)) {
+    return memcached_set_errno(*ptr, errno, MEMCACHED_AT);
+  }
+
+  if (ptr->rendezvous == NULL) {
+    if ((ptr->rendezvous = libmemcached_xmalloc(ptr, memcached_rendezvous_st)) == NULL) {
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    memset(ptr->rendezvous, 0, sizeof(*ptr->rendezvous));
+  }
+
+  memcached_rendezvous_st *rendezvous = ptr->rendezvous;
+  uint32_t server_count = memcached_server_count(ptr);
+  uint32_t cluster_count =
+      (server_count + MEMCACHED_RENDEZVOUS_FANOUT - 1) / MEMCACHED_RENDEZVOUS_FANOUT;
+
+  if (server_count > rendezvous->node_size) {
+    memcached_rendezvous_node_st *nodes = libmemcached_xrealloc(
+        ptr, rendezvous->nodes, server_count, memcached_rendezvous_node_st);
+    if (nodes == NULL) {
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    rendezvous->nodes = nodes;
+    rendezvous->node_size = server_count;
+  }
+  if (rendezvous_is_skeleton(ptr) and cluster_count > rendezvous->cluster_size) {
+    memcached_rendezvous_node_st *clusters = libmemcached_xrealloc(
+        ptr, rendezvous->clusters, cluster_count, memcached_rendezvous_node_st);
+    if (clusters == NULL) {
+      return memcached_set_error(*ptr, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    rendezvous->clusters = clusters;
+    rendezvous->cluster_size = cluster_count;
+  }
+
+  memcached_instance_st *list = memcached_instance_list(ptr);
+  bool is_auto_ejecting = _is_auto_eject_host(ptr);
+
+  if (is_auto_ejecting) {
+    ptr->ketama.next_distribution_rebuild = 0;
+  }
+
+  rendezvous->node_count = 0;
+  rendezvous->cluster_count = 0;
+  rendezvous->weighted = false;
+  rendezvous->clusters_weighted = false;
+
+  if (rendezvous_is_skeleton(ptr)) {
+    /*
+      Servers join a cluster by their name, and weigh it down even while ejected, so that
+      only the keys of a server which leaves, or is ejected, move.
+    */
+    for (uint32_t x = 0; x < cluster_count; ++x) {
+      memcached_rendezvous_node_st &cluster = rendezvous->clusters[x];
+      cluster.seed = rendezvous_mix(0, x);
+      cluster.weight = 0;
+      cluster.index = 0;
+      cluster.count = 0;
+    }
+    for (uint32_t host_index = 0; host_index < server_count; ++host_index) {
+      memcached_rendezvous_node_st &cluster = rendezvous->clusters[memcached_jump_consistent_hash(
+          rendezvous_server_seed(list[host_index]), cluster_count)];
+      cluster.weight += double(list[host_index].weight);
+      if (rendezvous_is_live(ptr, list[host_index], now, is_auto_ejecting)) {
+        cluster.count++;
+      }
+    }
+    /* the live servers of a cluster are stored one after another, in list order */
+    for (uint32_t x = 0, index = 0; x < cluster_count; ++x) {
+      rendezvous->clusters[x].index = index;
+      index += rendezvous->clusters[x].count;
+      rendezvous->clusters[x].count = 0;
+    }
+    rendezvous->cluster_count = cluster_count;
+  }
+
+  for (uint32_t host_index = 0; host_index < server_count; ++host_index) {
+    if (list[host_index].weight != list[0].weight) {
+      rendezvous->weighted = true;
+    }
+    if (rendezvous_is_live(ptr, list[host_index], now, is_auto_ejecting) == false) {
+      continue;
+    }
+
+    uint64_t seed = rendezvous_server_seed(list[host_index]);
+    uint32_t position = rendezvous->node_count;
+    if (rendezvous_is_skeleton(ptr)) {
+      memcached_rendezvous_node_st &cluster =
+          rendezvous->clusters[memcached_jump_consistent_hash(seed, cluster_count)];
+      position = cluster.index + cluster.count++;
+    }
+
+    memcached_rendezvous_node_st &node = rendezvous->nodes[position];
+    node.seed = seed;
+    node.weight = double(list[host_index].weight);
+    node.index = host_index;
+    node.count = 1;
+
+    rendezvous->node_count++;
+  }
+
+  for (uint32_t x = 1; x < rendezvous->cluster_count; ++x) {
+    if (rendezvous->clusters[x].weight != rendezvous->clusters[0].weight) {
+      rendezvous->clusters_weighted = true;
+    }
+  }
+
+  return MEMCACHED_SUCCESS;
+}
+
+void memcached_rendezvous_free(Memcached *ptr) {
+  if (ptr->rendezvous) {
+    libmemcached_free(ptr, ptr->rendezvous->nodes);
+    libmemcached_free(ptr, ptr->rendezvous->clusters);
+    libmemcached_free(ptr, ptr->rendezvous);
+    ptr->rendezvous = NULL;
+  }
+}
+
+uint32_t memcached_rendezvous_get(const Memcached *ptr, uint32_t hash) {
+  uint32_t server_key;
+
+  if (memcached_rendezvous_rank(ptr, hash, &server_key, 1)) {
+    return server_key;
+  }
+
+  /* no live servers */
+  return hash % memcached_server_count(ptr);
+}
+
+uint32_t memcached_rendezvous_rank(const Memcached *ptr, uint32_t hash, uint32_t *server_keys,
+                                   uint32_t count) {
+  const memcached_rendezvous_st *rendezvous = ptr->rendezvous;
+  uint32_t found = 0;
+
+  if (rendezvous == NULL) {
+    return 0;
+  }
+
+  if (rendezvous_is_skeleton(ptr)) {
+    double cluster_score = HUGE_VAL;
+    uint32_t cluster_position = 0;
+
+    while (found < count) {
+      uint32_t c = rendezvous_next(rendezvous->clusters, rendezvous->cluster_count,
+                                   rendezvous->clusters_weighted, hash, &cluster_score,
+                                   &cluster_position);
+      if (c == UINT32_MAX) {
+        break;
+      }
+
+      const memcached_rendezvous_node_st &cluster = rendezvous->clusters[c];
+      double score = HUGE_VAL;
+      uint32_t position = 0;
+
+      while (found < count) {
+        uint32_t n = rendezvous_next(rendezvous->nodes + cluster.index, cluster.count,
+                                     rendezvous->weighted, hash, &score, &position);
+        if (n == UINT32_MAX) {
+          break;
+        }
+        server_keys[found++] = rendezvous->nodes[cluster.index + n].index;
+      }
+    }
+  } else {
+    double score = HUGE_VAL;
+    uint32_t position = 0;
+
+    while (found < count) {
+      uint32_t n = rendezvous_next(rendezvous->nodes, rendezvous->node_count, rendezvous->weighted,
+                                   hash, &score, &position);
+      if (n == UINT32_MAX) {
+        break;
+      }
+      server_keys[found++] = rendezvous->nodes[n].index;
+    }
+  }
+
+  return found;
+}
@@ -0,0 +1,38 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/*
+  Weighted rendezvous (highest random weight) hashing, see
+  MEMCACHED_DISTRIBUTION_RENDEZVOUS and MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON.
+
+  The skeleton variant spreads the servers by their name over one cluster per
+  MEMCACHED_RENDEZVOUS_FANOUT servers with jump consistent hashing, and ranks the
+  clusters before ranking the servers within them.
+*/
+
+#define MEMCACHED_RENDEZVOUS_FANOUT 16
+
+/* Rebuild the table of live servers, called by run_distribution() */
+memcached_return_t memcached_rendezvous_update(memcached_st *);
+void memcached_rendezvous_free(memcached_st *);
+
+/* The server with the highest score for a key hash */
+uint32_t memcached_rendezvous_get(const memcached_st *, uint32_t hash);
+
+/* Up to count servers in descending order of their score, returns how many were stored */
+uint32_t memcached_rendezvous_rank(const memcached_st *, uint32_t hash, uint32_t *server_keys,
+                                   uint32_t count);
@@ -0,0 +1,259 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#include "libmemcached/common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+struct memcached_addrinfo_st {
+  std::atomic<uint32_t> refs;
+  struct addrinfo *info;
+};
+
+void memcached_addrinfo_release(memcached_addrinfo_st *self) {
+  if (self and self->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    freeaddrinfo(self->info);
+    delete self;
+  }
+}
+
+struct resolver_query_st {
+  std::string key;
+  std::string host;
+  char port[MEMCACHED_NI_MAXSERV];
+  struct addrinfo hints;
+};
+
+struct resolver_entry_st {
+  memcached_addrinfo_st *current;
+  time_t expires;
+  bool queued;
+  bool resolving;
+};
+
+/*
+  Background lookups are done one after another by a single thread, which is
+  started on demand and joined when the library is unloaded.
+*/
+struct resolver_cache_st {
+  std::mutex mutex;
+  std::condition_variable resolved;
+  std::condition_variable work;
+  std::unordered_map<std::string, resolver_entry_st> entries;
+  std::deque<std::pair<resolver_query_st, int32_t>> queue;
+  std::thread worker;
+  bool stopping = false;
+
+  ~resolver_cache_st();
+};
+
+/* set once the cache is gone, later lookups bypass it */
+static std::atomic<bool> resolver_shutdown{false};
+
+static resolver_cache_st &resolver_cache() {
+  static resolver_cache_st cache;
+  return cache;
+}
+
+resolver_cache_st::~resolver_cache_st() {
+  resolver_shutdown.store(true, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    work.notify_all();
+  }
+  if (worker.joinable()) {
+    worker.join();
+  }
+  for (auto &entry : entries) {
+    memcached_addrinfo_release(entry.second.current);
+  }
+}
+
+static void resolver_query(const memcached_instance_st *server, resolver_query_st &query) {
+  snprintf(query.port, sizeof(query.port), "%u", uint32_t(server->port()));
+
+  memset(&query.hints, 0, sizeof(query.hints));
+  query.hints.ai_family = AF_UNSPEC;
+  if (memcached_is_udp(server->root)) {
+    query.hints.ai_protocol = IPPROTO_UDP;
+    query.hints.ai_socktype = SOCK_DGRAM;
+  } else {
+    query.hints.ai_protocol = IPPROTO_TCP;
+    query.hints.ai_socktype = SOCK_STREAM;
+  }
+
+  const char *hostname = server->_hostname;
+  size_t host_len = strlen(hostname);
+  if (host_len > 2 and hostname[0] == '[' and hostname[host_len - 1] == ']') {
+    query.host.assign(hostname + 1, host_len - 2);
+  } else {
+    query.host.assign(hostname, host_len);
+  }
+
+  query.key.assign(query.hints.ai_socktype == SOCK_DGRAM ? "udp:" : "tcp:");
+  query.key.append(query.host).append("/").append(query.port);
+}
+
+static int resolver_lookup(const resolver_query_st &query, memcached_addrinfo_st *&result) {
+  struct addrinfo *info = NULL;
+  int errcode = getaddrinfo(query.host.c_str(), query.port, &query.hints, &info);
+
+  if (errcode == 0) {
+    if ((result = new (std::nothrow) memcached_addrinfo_st) == NULL) {
+      freeaddrinfo(info);
+      return EAI_MEMORY;
+    }
+    result->refs.store(1, std::memory_order_relaxed);
+    result->info = info;
+  }
+
+  return errcode;
+}
+
+/* Called with the lock held, the cache takes over the reference of result */
+static void resolver_publish(resolver_cache_st &cache, resolver_entry_st &entry,
+                             memcached_addrinfo_st *result, int32_t ttl) {
+  if (result) {
+    memcached_addrinfo_release(entry.current);
+    entry.current = result;
+  }
+  if (entry.current) {
+    /* a failed refresh keeps the old result, and is retried after another ttl */
+    entry.expires = time(NULL) + ttl;
+  }
+  /* else the first lookup failed, let the next connect report why */
+  entry.resolving = false;
+  cache.resolved.notify_all();
+}
+
+static void resolver_work(resolver_cache_st &cache) {
+  std::unique_lock<std::mutex> lock(cache.mutex);
+
+  while (true) {
+    while (cache.queue.empty() and cache.stopping == false) {
+      cache.work.wait(lock);
+    }
+    if (cache.stopping) {
+      return;
+    }
+
+    resolver_query_st query = std::move(cache.queue.front().first);
+    int32_t ttl = cache.queue.front().second;
+    cache.queue.pop_front();
+
+    resolver_entry_st &entry = cache.entries[query.key];
+    entry.queued = false;
+    /* a connect may have resolved it synchronously in the meantime */
+    if (entry.resolving or (entry.current and entry.expires > time(NULL))) {
+      continue;
+    }
+    entry.resolving = true;
+    lock.unlock();
+
+    memcached_addrinfo_st *result = NULL;
+    (void) resolver_lookup(query, result);
+
+    lock.lock();
+    resolver_publish(cache, cache.entries[query.key], result, ttl);
+  }
+}
+
+/* Called with the lock held */
+static void resolver_start(resolver_cache_st &cache, resolver_entry_st &entry,
+                           const resolver_query_st &query, int32_t ttl) {
+  if (entry.queued or entry.resolving or cache.stopping) {
+    return;
+  }
+
+  try {
+    if (cache.worker.joinable() == false) {
+      cache.worker = std::thread(resolver_work, std::ref(cache));
+    }
+    cache.queue.emplace_back(query, ttl);
+  } catch (...) {
+    /* connects will just resolve synchronously */
+    return;
+  }
+  entry.queued = true;
+  cache.work.notify_one();
+}
+
+int memcached_resolve(memcached_instance_st *server) {
+  resolver_query_st query;
+  resolver_query(server, query);
+
+  int32_t ttl = server->root ? server->root->dns_ttl : 0;
+  if (ttl <= 0 or resolver_shutdown.load(std::memory_order_acquire)) {
+    return getaddrinfo(query.host.c_str(), query.port, &query.hints, &server->address_info);
+  }
+
+  resolver_cache_st &cache = resolver_cache();
+  std::unique_lock<std::mutex> lock(cache.mutex);
+  resolver_entry_st &entry = cache.entries[query.key];
+
+  /* someone is resolving the server for the first time, there's no point in asking twice */
+  while (entry.current == NULL and entry.resolving) {
+    cache.resolved.wait(lock);
+  }
+
+  if (entry.current == NULL) {
+    entry.resolving = true;
+    lock.unlock();
+
+    memcached_addrinfo_st *result = NULL;
+    int errcode = resolver_lookup(query, result);
+
+    lock.lock();
+    if (errcode) {
+      entry.resolving = false;
+      cache.resolved.notify_all();
+      return errcode;
+    }
+    resolver_publish(cache, entry, result, ttl);
+  } else if (entry.expires <= time(NULL)) {
+    resolver_start(cache, entry, query, ttl);
+  }
+
+  entry.current->refs.fetch_add(1, std::memory_order_relaxed);
+  server->resolved = entry.current;
+  server->address_info = entry.current->info;
+
+  return 0;
+}
+
+void memcached_resolve_prefetch(memcached_instance_st *server) {
+  if (server->type == MEMCACHED_CONNECTION_UNIX_SOCKET or server->root == NULL
+      or server->root->dns_ttl <= 0 or resolver_shutdown.load(std::memory_order_acquire))
+  {
+    return;
+  }
+
+  resolver_query_st query;
+  resolver_query(server, query);
+
+  resolver_cache_st &cache = resolver_cache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  resolver_entry_st &entry = cache.entries[query.key];
+  if (entry.current == NULL) {
+    resolver_start(cache, entry, query, server->root->dns_ttl);
+  }
+}
@@ -0,0 +1,38 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#pragma once
+
+/*
+  Process wide cache of getaddrinfo() results, see MEMCACHED_BEHAVIOR_DNS_TTL.
+
+  A result is shared by all instances resolving the same server, clones and
+  pools included, and stays valid as long as any of them references it, even
+  after it was replaced by a refresh.
+*/
+
+struct memcached_addrinfo_st;
+
+/*
+  Resolve the address of the instance into its address_info, with the error
+  codes of getaddrinfo(). Expired cached results are still used while they are
+  refreshed in the background.
+*/
+int memcached_resolve(memcached_instance_st *);
+
+/* Start resolving the address of the instance in the background, unless it is cached */
+void memcached_resolve_prefetch(memcached_instance_st *);
+
+void memcached_addrinfo_release(memcached_addrinfo_st *);
@@ -16,8 +16,19 @@
 #include "libmemcached/common.h"
 #include "libmemcached/string.hpp"
 
+static void view_from_result(memcached_item_view_st *view, const memcached_result_st *result,
+                             const char *value, size_t value_length) {
+  view->key = result->item_key;
+  view->key_length = result->key_length;
+  view->value = value;
+  view->value_length = value_length;
+  view->flags = result->item_flags;
+  view->cas = result->item_cas;
+}
+
 static memcached_return_t textual_value_fetch(memcached_instance_st *instance, char *buffer,
-                                              memcached_result_st *result) {
+                                              memcached_result_st *result,
+                                              memcached_item_view_st *view) {
   char *next_ptr;
   ssize_t read_length = 0;
   size_t value_length;
@@ -101,6 +112,23 @@ static memcached_return_t textual_value_fetch(memcached_instance_st *instance, c
     goto read_error;
   }
 
+  /* Hand out the value right from the read buffer, unless it needs decrypting or decompressing */
+  if (view and memcached_is_encrypted(instance->root) == false
+      and memcached_is_compressed(instance->root, result->item_flags) == false)
+  {
+    const char *value_ptr;
+    memcached_return_t rrc = memcached_io_read_view(instance, value_length + 2, value_ptr);
+    if (memcached_failed(rrc) and rrc == MEMCACHED_IN_PROGRESS) {
+      memcached_quit_server(instance, true);
+      return memcached_set_error(*instance, MEMCACHED_IN_PROGRESS, MEMCACHED_AT);
+    } else if (memcached_failed(rrc)) {
+      return rrc;
+    }
+
+    view_from_result(view, result, value_ptr, value_length);
+    return MEMCACHED_SUCCESS;
+  }
+
   /* We add two bytes so that we can walk the \r\n */
   if (memcached_failed(memcached_string_check(&result->value, value_length + 2))) {
     return memcached_set_error(*instance, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
@@ -139,29 +167,34 @@ static memcached_return_t textual_value_fetch(memcached_instance_st *instance, c
     memcached_string_set_length(&result->value, value_length);
   }
 
+  /* the plain text is never longer than the cipher text, decrypt it in place */
   if (memcached_is_encrypted(instance->root) and memcached_result_length(result)) {
-    hashkit_string_st *destination;
+    hashkit_cipher_mode_t mode = HASHKIT_CIPHER_MODE_DEFAULT;
+    uint32_t ctr_flag = instance->root->encryption_ctr_flag;
+    char *value = memcached_string_value_mutable(&result->value);
+    size_t length = memcached_result_length(result);
+
+    if (ctr_flag and (result->item_flags & ctr_flag)) {
+      mode = HASHKIT_CIPHER_MODE_CTR;
+      result->item_flags &= ~ctr_flag;
+    }
 
-    if ((destination = hashkit_decrypt(&instance->root->hashkit, memcached_result_value(result),
-                                       memcached_result_length(result)))
-        == NULL)
-    {
+    if (hashkit_decrypt_buffer(&instance->root->hashkit, mode, value, length, value, &length)) {
+      value[length] = 0;
+      memcached_string_set_length(&result->value, length);
+    } else {
       rc = memcached_set_error(*instance->root, MEMCACHED_FAILURE, MEMCACHED_AT,
                                memcached_literal_param("hashkit_decrypt() failed"));
-    } else {
-      memcached_result_reset_value(result);
-      if (memcached_failed(memcached_result_set_value(result, hashkit_string_c_str(destination),
-                                                      hashkit_string_length(destination))))
-      {
-        rc = memcached_set_error(*instance->root, MEMCACHED_FAILURE, MEMCACHED_AT,
-                                 memcached_literal_param("hashkit_decrypt() failed"));
-      }
-    }
-
-    if (memcached_failed(rc)) {
       memcached_result_reset(result);
     }
-    hashkit_string_free(destination);
+  }
+
+  if (memcached_success(rc) and memcached_failed(rc = memcached_decompress(instance, result))) {
+    memcached_result_reset(result);
+  }
+
+  if (view and memcached_success(rc)) {
+    view_from_result(view, result, memcached_result_value(result), memcached_result_length(result));
   }
 
   return rc;
@@ -174,7 +207,8 @@ read_error:
 
 static memcached_return_t textual_read_one_response(memcached_instance_st *instance, char *buffer,
                                                     const size_t buffer_length,
-                                                    memcached_result_st *result) {
+                                                    memcached_result_st *result,
+                                                    memcached_item_view_st *view) {
   size_t total_read;
   memcached_return_t rc = memcached_io_readline(instance, buffer, buffer_length, total_read);
 
@@ -190,7 +224,7 @@ static memcached_return_t textual_read_one_response(memcached_instance_st *insta
     {
       /* We add back in one because we will need to search for END */
       memcached_server_response_increment(instance);
-      return textual_value_fetch(instance, buffer, result);
+      return textual_value_fetch(instance, buffer, result, view);
     }
     // VERSION
     else if (buffer[1] == 'E' and buffer[2] == 'R' and buffer[3] == 'S' and buffer[4] == 'I'
@@ -440,7 +474,8 @@ static memcached_return_t textual_read_one_response(memcached_instance_st *insta
 
 static memcached_return_t binary_read_one_response(memcached_instance_st *instance, char *buffer,
                                                    const size_t buffer_length,
-                                                   memcached_result_st *result) {
+                                                   memcached_result_st *result,
+                                                   memcached_item_view_st *view) {
   memcached_return_t rc;
   protocol_binary_response_header header;
 
@@ -514,6 +549,17 @@ static memcached_return_t binary_read_one_response(memcached_instance_st *instan
       }
 
       bodylen -= keylen;
+      if (view and memcached_is_compressed(instance->root, result->item_flags) == false) {
+        const char *vptr;
+        if (memcached_failed(rc = memcached_io_read_view(instance, bodylen, vptr))) {
+          WATCHPOINT_ERROR(rc);
+          return MEMCACHED_UNKNOWN_READ_FAILURE;
+        }
+
+        view_from_result(view, result, vptr, bodylen);
+        break;
+      }
+
       if (memcached_failed(memcached_string_check(&result->value, bodylen))) {
         return MEMCACHED_MEMORY_ALLOCATION_FAILURE;
       }
@@ -525,6 +571,15 @@ static memcached_return_t binary_read_one_response(memcached_instance_st *instan
       }
 
       memcached_string_set_length(&result->value, bodylen);
+
+      if (memcached_failed(rc = memcached_decompress(instance, result))) {
+        memcached_result_reset(result);
+        return rc;
+      }
+      if (view) {
+        view_from_result(view, result, memcached_result_value(result),
+                         memcached_result_length(result));
+      }
     } break;
 
     case PROTOCOL_BINARY_CMD_INCREMENT:
@@ -744,7 +799,8 @@ static memcached_return_t binary_read_one_response(memcached_instance_st *instan
 
 static memcached_return_t _read_one_response(memcached_instance_st *instance, char *buffer,
                                              const size_t buffer_length,
-                                             memcached_result_st *result) {
+                                             memcached_result_st *result,
+                                             memcached_item_view_st *view = NULL) {
   memcached_server_response_decrement(instance);
 
   if (result == NULL) {
@@ -755,10 +811,10 @@ static memcached_return_t _read_one_response(memcached_instance_st *instance, ch
   memcached_return_t rc;
   if (memcached_is_binary(instance->root)) {
     do {
-      rc = binary_read_one_response(instance, buffer, buffer_length, result);
+      rc = binary_read_one_response(instance, buffer, buffer_length, result, view);
     } while (rc == MEMCACHED_FETCH_NOTFINISHED);
   } else {
-    rc = textual_read_one_response(instance, buffer, buffer_length, result);
+    rc = textual_read_one_response(instance, buffer, buffer_length, result, view);
   }
 
   if (memcached_fatal(rc) && rc != MEMCACHED_TIMEOUT) {
@@ -787,7 +843,8 @@ memcached_return_t memcached_response(memcached_instance_st *instance,
 }
 
 memcached_return_t memcached_response(memcached_instance_st *instance, char *buffer,
-                                      size_t buffer_length, memcached_result_st *result) {
+                                      size_t buffer_length, memcached_result_st *result,
+                                      memcached_item_view_st *view) {
   if (memcached_is_udp(instance->root)) {
     return memcached_set_error(*instance, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT);
   }
@@ -830,5 +887,5 @@ memcached_return_t memcached_response(memcached_instance_st *instance, char *buf
     memcached_result_free(junked_result_ptr);
   }
 
-  return _read_one_response(instance, buffer, buffer_length, result);
+  return _read_one_response(instance, buffer, buffer_length, result, view);
 }
@@ -21,5 +21,7 @@ memcached_return_t memcached_read_one_response(memcached_instance_st *ptr,
 
 memcached_return_t memcached_response(memcached_instance_st *ptr, memcached_result_st *result);
 
+/* If view is given, values are not copied into the result but pointed to by the view */
 memcached_return_t memcached_response(memcached_instance_st *ptr, char *buffer,
-                                      size_t buffer_length, memcached_result_st *result);
+                                      size_t buffer_length, memcached_result_st *result,
+                                      memcached_item_view_st *view = NULL);
@@ -58,6 +58,75 @@ static inline bool can_by_encrypted(const memcached_storage_action_t verb) {
   return false;
 }
 
+/*
+  Compresses and encrypts a value as configured, into stack buffers or, if too large, single
+  allocations released with the object.
+*/
+class StorageValue {
+public:
+  StorageValue(Memcached *memc)
+  : _memc(memc)
+  , _compressed(NULL)
+  , _encrypted(NULL) {}
+
+  ~StorageValue() {
+    if (_encrypted != _encrypted_buffer) {
+      libmemcached_free(_memc, _encrypted);
+    }
+    if (_compressed != _compressed_buffer) {
+      libmemcached_free(_memc, _compressed);
+    }
+  }
+
+  memcached_return_t prepare(const memcached_storage_action_t verb, const char *&value,
+                             size_t &value_length, uint32_t &flags) {
+    /* appending to a compressed value would corrupt it */
+    if (memcached_is_compressing(_memc, value_length) and can_by_encrypted(verb)) {
+      size_t length = sizeof(_compressed_buffer);
+      if ((_compressed =
+               memcached_compress(_memc, value, value_length, _compressed_buffer, length)))
+      {
+        value = _compressed;
+        value_length = length;
+        flags |= _memc->compression.flag;
+      }
+    }
+
+    if (memcached_is_encrypted(_memc) == false) {
+      return MEMCACHED_SUCCESS;
+    }
+
+    hashkit_cipher_mode_t mode = HASHKIT_CIPHER_MODE_DEFAULT;
+    if (_memc->encryption_ctr_flag) {
+      mode = HASHKIT_CIPHER_MODE_CTR;
+      flags |= _memc->encryption_ctr_flag;
+    }
+
+    size_t length = hashkit_encrypt_length(&_memc->hashkit, mode, value_length);
+    _encrypted = _encrypted_buffer;
+    if (length > sizeof(_encrypted_buffer)
+        and (_encrypted = (char *) libmemcached_malloc(_memc, length)) == NULL) {
+      return memcached_set_error(*_memc, MEMCACHED_MEMORY_ALLOCATION_FAILURE, MEMCACHED_AT);
+    }
+    if (hashkit_encrypt_buffer(&_memc->hashkit, mode, value, value_length, _encrypted, &length)
+        == false) {
+      return memcached_set_error(*_memc, MEMCACHED_FAILURE, MEMCACHED_AT,
+                                 memcached_literal_param("hashkit_encrypt() failed"));
+    }
+    value = _encrypted;
+    value_length = length;
+
+    return MEMCACHED_SUCCESS;
+  }
+
+private:
+  Memcached *_memc;
+  char *_compressed;
+  char *_encrypted;
+  char _compressed_buffer[MEMCACHED_MAX_BUFFER];
+  char _encrypted_buffer[MEMCACHED_MAX_BUFFER];
+};
+
 static inline uint8_t get_com_code(const memcached_storage_action_t verb, const bool reply) {
   if (reply == false) {
     switch (verb) {
@@ -101,16 +170,21 @@ static inline uint8_t get_com_code(const memcached_storage_action_t verb, const
 }
 
 static memcached_return_t memcached_send_binary(Memcached *ptr, memcached_instance_st *server,
-                                                uint32_t server_key, const char *key,
-                                                const size_t key_length, const char *value,
-                                                const size_t value_length, const time_t expiration,
-                                                const uint32_t flags, const uint64_t cas,
+                                                const char *group_key, size_t group_key_length,
+                                                const char *key, const size_t key_length,
+                                                const char *value, const size_t value_length,
+                                                const time_t expiration, const uint32_t flags,
+                                                const uint64_t cas, const uint32_t opaque,
                                                 const bool flush, const bool reply,
                                                 memcached_storage_action_t verb) {
   protocol_binary_request_set request = {};
   size_t send_length = sizeof(request.bytes);
 
   initialize_binary_request(server, request.message.header);
+  if (opaque) {
+    /* identifies the response of a quiet request, see memcached_pipeline() */
+    request.message.header.request.opaque = htonl(opaque);
+  }
 
   request.message.header.request.opcode = get_com_code(verb, reply);
   request.message.header.request.keylen =
@@ -150,17 +224,20 @@ static memcached_return_t memcached_send_binary(Memcached *ptr, memcached_instan
     request.message.header.request.opcode = PROTOCOL_BINARY_CMD_SETQ;
     WATCHPOINT_STRING("replicating");
 
-    for (uint32_t x = 0; x < ptr->number_of_replicas; x++) {
-      ++server_key;
-      if (server_key == memcached_server_count(ptr)) {
-        server_key = 0;
-      }
+    /* replicas are best effort, like their sends below */
+    uint32_t *server_keys = libmemcached_xvalloc(ptr, ptr->number_of_replicas + 1, uint32_t);
+    if (server_keys) {
+      uint32_t count = memcached_generate_replicas_with_redistribution(
+          ptr, group_key, group_key_length, server_keys, ptr->number_of_replicas + 1);
 
-      memcached_instance_st *instance = memcached_instance_fetch(ptr, server_key);
+      for (uint32_t x = 1; x < count; x++) {
+        memcached_instance_st *instance = memcached_instance_fetch(ptr, server_keys[x]);
 
-      if (memcached_success(memcached_vdo(instance, vector, 5, false))) {
-        memcached_server_response_decrement(instance);
+        if (memcached_success(memcached_vdo(instance, vector, 5, false))) {
+          memcached_server_response_decrement(instance);
+        }
       }
+      libmemcached_free(ptr, server_keys);
     }
   }
 
@@ -268,7 +345,7 @@ memcached_send_ascii(Memcached *ptr, memcached_instance_st *instance, const char
 static inline memcached_return_t
 memcached_send(memcached_st *shell, const char *group_key, size_t group_key_length, const char *key,
                size_t key_length, const char *value, size_t value_length, const time_t expiration,
-               const uint32_t flags, const uint64_t cas, memcached_storage_action_t verb) {
+               uint32_t flags, const uint64_t cas, memcached_storage_action_t verb) {
   Memcached *ptr = memcached2Memcached(shell);
   memcached_return_t rc;
   if (memcached_failed(rc = initialize_query(ptr, true))) {
@@ -293,33 +370,114 @@ memcached_send(memcached_st *shell, const char *group_key, size_t group_key_leng
 
   bool reply = memcached_is_replying(ptr);
 
-  hashkit_string_st *destination = NULL;
+  if (memcached_is_encrypted(ptr) and can_by_encrypted(verb) == false) {
+    return memcached_set_error(
+        *ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
+        memcached_literal_param("Operation not allowed while encyrption is enabled"));
+  }
 
-  if (memcached_is_encrypted(ptr)) {
-    if (can_by_encrypted(verb) == false) {
-      return memcached_set_error(
-          *ptr, MEMCACHED_NOT_SUPPORTED, MEMCACHED_AT,
-          memcached_literal_param("Operation not allowed while encyrption is enabled"));
+  StorageValue storage(ptr);
+  rc = storage.prepare(verb, value, value_length, flags);
+
+  if (memcached_success(rc)) {
+    if (memcached_is_binary(ptr)) {
+      rc = memcached_send_binary(ptr, instance, group_key, group_key_length, key, key_length,
+                                 value, value_length, expiration, flags, cas, 0, flush, reply,
+                                 verb);
+    } else {
+      rc = memcached_send_ascii(ptr, instance, key, key_length, value, value_length, expiration,
+                                flags, cas, flush, reply, verb);
     }
+  }
 
-    if ((destination = hashkit_encrypt(&ptr->hashkit, value, value_length)) == NULL) {
-      return rc;
-    }
-    value = hashkit_string_c_str(destination);
-    value_length = hashkit_string_length(destination);
+  return rc;
+}
+
+struct memcached_mstore_st {
+  const char *group_key;
+  size_t group_key_length;
+  const char *const *keys;
+  const size_t *key_length;
+  const char *const *values;
+  const size_t *value_length;
+  const time_t *expiration;
+  const uint32_t *flags;
+  const uint64_t *cas;
+  memcached_storage_action_t verb;
+};
+
+static memcached_return_t mstore_send(Memcached *ptr, memcached_instance_st *instance, uint32_t,
+                                      size_t n, void *context) {
+  memcached_mstore_st *mstore = static_cast<memcached_mstore_st *>(context);
+  const char *key = mstore->keys[n];
+  size_t key_length = mstore->key_length[n];
+  const char *value = mstore->values[n];
+  size_t value_length = mstore->value_length[n];
+  time_t expiration = mstore->expiration ? mstore->expiration[n] : 0;
+  uint32_t flags = mstore->flags ? mstore->flags[n] : 0;
+  uint64_t cas = mstore->verb == CAS_OP ? mstore->cas[n] : 0;
+
+  StorageValue storage(ptr);
+  memcached_return_t rc;
+  if (memcached_failed(rc = storage.prepare(mstore->verb, value, value_length, flags))) {
+    return rc;
   }
 
   if (memcached_is_binary(ptr)) {
-    rc = memcached_send_binary(ptr, instance, server_key, key, key_length, value, value_length,
-                               expiration, flags, cas, flush, reply, verb);
-  } else {
-    rc = memcached_send_ascii(ptr, instance, key, key_length, value, value_length, expiration,
-                              flags, cas, flush, reply, verb);
+    return memcached_send_binary(
+        ptr, instance, mstore->group_key_length ? mstore->group_key : key,
+        mstore->group_key_length ? mstore->group_key_length : key_length, key, key_length, value,
+        value_length, expiration, flags, cas, uint32_t(n + 1), false, false, mstore->verb);
   }
 
-  hashkit_string_free(destination);
+  return memcached_send_ascii(ptr, instance, key, key_length, value, value_length, expiration,
+                              flags, cas, false, memcached_is_replying(ptr), mstore->verb);
+}
 
-  return rc;
+static memcached_return_t
+memcached_mstore(memcached_st *shell, const char *group_key, size_t group_key_length,
+                 const char *const *keys, const size_t *key_length, const char *const *values,
+                 const size_t *value_length, const time_t *expiration, const uint32_t *flags,
+                 const uint64_t *cas, size_t number_of_keys, memcached_return_t *results,
+                 memcached_storage_action_t verb) {
+  Memcached *ptr = memcached2Memcached(shell);
+  memcached_return_t rc;
+  if (memcached_failed(rc = initialize_query(ptr, true))) {
+    return rc;
+  }
+
+  if (number_of_keys == 0 or keys == NULL or key_length == NULL or values == NULL
+      or value_length == NULL or (verb == CAS_OP and cas == NULL))
+  {
+    return memcached_set_error(*ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT);
+  }
+
+  /* there are no responses to pipeline over UDP */
+  if (memcached_is_udp(ptr)) {
+    bool failed = false;
+
+    for (size_t x = 0; x < number_of_keys; ++x) {
+      rc = memcached_send(ptr, group_key_length ? group_key : keys[x],
+                          group_key_length ? group_key_length : key_length[x], keys[x],
+                          key_length[x], values[x], value_length[x],
+                          expiration ? expiration[x] : 0, flags ? flags[x] : 0,
+                          cas ? cas[x] : 0, verb);
+      if (results) {
+        results[x] = rc;
+      }
+      failed = failed or memcached_failed(rc);
+    }
+
+    return failed ? MEMCACHED_SOME_ERRORS : MEMCACHED_SUCCESS;
+  }
+
+  memcached_mstore_st mstore = {group_key, group_key_length, keys, key_length, values,
+                                value_length, expiration, flags, cas, verb};
+
+  return memcached_pipeline(ptr, group_key, group_key_length, keys, key_length, number_of_keys,
+                            results, get_com_code(verb, false),
+                            memcached_is_binary(ptr) or memcached_is_replying(ptr), mstore_send,
+                            &mstore);
 }
 
 memcached_return_t memcached_set(memcached_st *ptr, const char *key, size_t key_length,
@@ -444,3 +602,80 @@ memcached_return_t memcached_cas_by_key(memcached_st *ptr, const char *group_key
   return memcached_send(ptr, group_key, group_key_length, key, key_length, value, value_length,
                         expiration, flags, cas, CAS_OP);
 }
+
+memcached_return_t memcached_mset(memcached_st *ptr, const char *const *keys,
+                                  const size_t *key_length, const char *const *values,
+                                  const size_t *value_length, const time_t *expiration,
+                                  const uint32_t *flags, size_t number_of_keys,
+                                  memcached_return_t *results) {
+  return memcached_mstore(ptr, NULL, 0, keys, key_length, values, value_length, expiration, flags,
+                          NULL, number_of_keys, results, SET_OP);
+}
+
+memcached_return_t memcached_madd(memcached_st *ptr, const char *const *keys,
+                                  const size_t *key_length, const char *const *values,
+                                  const size_t *value_length, const time_t *expiration,
+                                  const uint32_t *flags, size_t number_of_keys,
+                                  memcached_return_t *results) {
+  return memcached_mstore(ptr, NULL, 0, keys, key_length, values, value_length, expiration, flags,
+                          NULL, number_of_keys, results, ADD_OP);
+}
+
+memcached_return_t memcached_mreplace(memcached_st *ptr, const char *const *keys,
+                                      const size_t *key_length, const char *const *values,
+                                      const size_t *value_length, const time_t *expiration,
+                                      const uint32_t *flags, size_t number_of_keys,
+                                      memcached_return_t *results) {
+  return memcached_mstore(ptr, NULL, 0, keys, key_length, values, value_length, expiration, flags,
+                          NULL, number_of_keys, results, REPLACE_OP);
+}
+
+memcached_return_t memcached_mcas(memcached_st *ptr, const char *const *keys,
+                                  const size_t *key_length, const char *const *values,
+                                  const size_t *value_length, const time_t *expiration,
+                                  const uint32_t *flags, const uint64_t *cas,
+                                  size_t number_of_keys, memcached_return_t *results) {
+  return memcached_mstore(ptr, NULL, 0, keys, key_length, values, value_length, expiration, flags,
+                          cas, number_of_keys, results, CAS_OP);
+}
+
+memcached_return_t memcached_mset_by_key(memcached_st *ptr, const char *group_key,
+                                         size_t group_key_length, const char *const *keys,
+                                         const size_t *key_length, const char *const *values,
+                                         const size_t *value_length, const time_t *expiration,
+                                         const uint32_t *flags, size_t number_of_keys,
+                                         memcached_return_t *results) {
+  return memcached_mstore(ptr, group_key, group_key_length, keys, key_length, values,
+                          value_length, expiration, flags, NULL, number_of_keys, results, SET_OP);
+}
+
+memcached_return_t memcached_madd_by_key(memcached_st *ptr, const char *group_key,
+                                         size_t group_key_length, const char *const *keys,
+                                         const size_t *key_length, const char *const *values,
+                                         const size_t *value_length, const time_t *expiration,
+                                         const uint32_t *flags, size_t number_of_keys,
+                                         memcached_return_t *results) {
+  return memcached_mstore(ptr, group_key, group_key_length, keys, key_length, values,
+                          value_length, expiration, flags, NULL, number_of_keys, results, ADD_OP);
+}
+
+memcached_return_t memcached_mreplace_by_key(memcached_st *ptr, const char *group_key,
+                                             size_t group_key_length, const char *const *keys,
+                                             const size_t *key_length, const char *const *values,
+                                             const size_t *value_length, const time_t *expiration,
+                                             const uint32_t *flags, size_t number_of_keys,
+                                             memcached_return_t *results) {
+  return memcached_mstore(ptr, group_key, group_key_length, keys, key_length, values,
+                          value_length, expiration, flags, NULL, number_of_keys, results,
+                          REPLACE_OP);
+}
+
+memcached_return_t memcached_mcas_by_key(memcached_st *ptr, const char *group_key,
+                                         size_t group_key_length, const char *const *keys,
+                                         const size_t *key_length, const char *const *values,
+                                         const size_t *value_length, const time_t *expiration,
+                                         const uint32_t *flags, const uint64_t *cas,
+                                         size_t number_of_keys, memcached_return_t *results) {
+  return memcached_mstore(ptr, group_key, group_key_length, keys, key_length, values,
+                          value_length, expiration, flags, cas, number_of_keys, results, CAS_OP);
+}
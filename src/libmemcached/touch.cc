@@ -16,7 +16,8 @@
 #include "libmemcached/common.h"
 
 static memcached_return_t ascii_touch(memcached_instance_st *instance, const char *key,
-                                      size_t key_length, time_t expiration) {
+                                      size_t key_length, time_t expiration,
+                                      const bool flush = true) {
   char expiration_buffer[MEMCACHED_MAXIMUM_INTEGER_DISPLAY_LENGTH + 1];
   int expiration_buffer_length = snprintf(expiration_buffer, sizeof(expiration_buffer), " %llu",
                                           (unsigned long long) expiration);
@@ -37,7 +38,7 @@ static memcached_return_t ascii_touch(memcached_instance_st *instance, const cha
                                         {memcached_literal_param("\r\n")}};
 
   memcached_return_t rc;
-  if (memcached_failed(rc = memcached_vdo(instance, vector, 6, true))) {
+  if (memcached_failed(rc = memcached_vdo(instance, vector, 6, flush))) {
     return memcached_set_error(*instance, MEMCACHED_WRITE_FAILURE, MEMCACHED_AT);
   }
 
@@ -45,10 +46,15 @@ static memcached_return_t ascii_touch(memcached_instance_st *instance, const cha
 }
 
 static memcached_return_t binary_touch(memcached_instance_st *instance, const char *key,
-                                       size_t key_length, time_t expiration) {
+                                       size_t key_length, time_t expiration,
+                                       const bool flush = true, const uint32_t opaque = 0) {
   protocol_binary_request_touch request = {}; //{.bytes= {0}};
 
   initialize_binary_request(instance, request.message.header);
+  if (opaque) {
+    /* identifies the response within a pipeline, see memcached_pipeline() */
+    request.message.header.request.opaque = htonl(opaque);
+  }
 
   request.message.header.request.opcode = PROTOCOL_BINARY_CMD_TOUCH;
   request.message.header.request.extlen = 4;
@@ -67,7 +73,7 @@ static memcached_return_t binary_touch(memcached_instance_st *instance, const ch
                                         {key, key_length}};
 
   memcached_return_t rc;
-  if (memcached_failed(rc = memcached_vdo(instance, vector, 4, true))) {
+  if (memcached_failed(rc = memcached_vdo(instance, vector, 4, flush))) {
     return memcached_set_error(*instance, MEMCACHED_WRITE_FAILURE, MEMCACHED_AT);
   }
 
@@ -120,3 +126,78 @@ memcached_return_t memcached_touch_by_key(memcached_st *shell, const char *group
   return memcached_set_error(*instance, rc, MEMCACHED_AT,
                              memcached_literal_param("Error occcured while reading response"));
 }
+
+struct memcached_mtouch_st {
+  const char *const *keys;
+  const size_t *key_length;
+  time_t expiration;
+};
+
+static memcached_return_t mtouch_send(Memcached *ptr, memcached_instance_st *instance, uint32_t,
+                                      size_t n, void *context) {
+  memcached_mtouch_st *mtouch = static_cast<memcached_mtouch_st *>(context);
+  memcached_return_t rc;
+
+  /* there is no quiet touch, every response is read */
+  if (memcached_is_binary(ptr)) {
+    rc = binary_touch(instance, mtouch->keys[n], mtouch->key_length[n], mtouch->expiration, false,
+                      uint32_t(n + 1));
+  } else {
+    rc = ascii_touch(instance, mtouch->keys[n], mtouch->key_length[n], mtouch->expiration, false);
+  }
+
+  if (memcached_failed(rc)) {
+    return rc;
+  }
+
+  /* touch has no noreply form here, its response is read regardless */
+  if (memcached_is_replying(ptr) == false) {
+    memcached_server_response_increment(instance);
+  }
+
+  return MEMCACHED_BUFFERED;
+}
+
+memcached_return_t memcached_mtouch(memcached_st *ptr, const char *const *keys,
+                                    const size_t *key_length, size_t number_of_keys,
+                                    time_t expiration, memcached_return_t *results) {
+  return memcached_mtouch_by_key(ptr, NULL, 0, keys, key_length, number_of_keys, expiration,
+                                 results);
+}
+
+memcached_return_t memcached_mtouch_by_key(memcached_st *shell, const char *group_key,
+                                           size_t group_key_length, const char *const *keys,
+                                           const size_t *key_length, size_t number_of_keys,
+                                           time_t expiration, memcached_return_t *results) {
+  Memcached *ptr = memcached2Memcached(shell);
+
+  memcached_return_t rc;
+  if (memcached_failed(rc = initialize_query(ptr, true))) {
+    return rc;
+  }
+
+  if (number_of_keys == 0 or keys == NULL or key_length == NULL) {
+    return memcached_set_error(*ptr, MEMCACHED_INVALID_ARGUMENTS, MEMCACHED_AT);
+  }
+
+  /* there are no responses to pipeline over UDP */
+  if (memcached_is_udp(ptr)) {
+    bool failed = false;
+
+    for (size_t x = 0; x < number_of_keys; ++x) {
+      rc = memcached_touch_by_key(ptr, group_key_length ? group_key : keys[x],
+                                  group_key_length ? group_key_length : key_length[x], keys[x],
+                                  key_length[x], expiration);
+      if (results) {
+        results[x] = rc;
+      }
+      failed = failed or memcached_failed(rc);
+    }
+
+    return failed ? MEMCACHED_SOME_ERRORS : MEMCACHED_SUCCESS;
+  }
+
+  memcached_mtouch_st mtouch = {keys, key_length, expiration};
+  return memcached_pipeline(ptr, group_key, group_key_length, keys, key_length, number_of_keys,
+                            results, PROTOCOL_BINARY_CMD_TOUCH, true, mtouch_send, &mtouch);
+}
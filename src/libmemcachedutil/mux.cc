@@ -0,0 +1,472 @@
+/*
+    +--------------------------------------------------------------------+
+    | libmemcached-awesome - C/C++ Client Library for memcached          |
+    +--------------------------------------------------------------------+
+    | Redistribution and use in source and binary forms, with or without |
+    | modification, are permitted under the terms of the BSD license.    |
+    | You should have received a copy of the license in a bundled file   |
+    | named LICENSE; in case you did not receive a copy you can review   |
+    | the terms online at: https://opensource.org/licenses/BSD-3-Clause  |
+    +--------------------------------------------------------------------+
+    | Copyright (c) 2006-2014 Brian Aker   https://datadifferential.com/ |
+    | Copyright (c) 2020-2021 Michael Wallner        https://awesome.co/ |
+    +--------------------------------------------------------------------+
+*/
+
+#include "libmemcachedutil/common.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include "p9y/poll.hpp"
+
+enum memcached_mux_command_t { MUX_GET, MUX_SET, MUX_DELETE };
+
+enum memcached_mux_request_state_t { MUX_PENDING, MUX_DONE, MUX_ABANDONED };
+
+/*
+  A request of a calling thread, waiting for the I/O thread to complete it. If
+  the caller times out, it abandons the request and the I/O thread frees it.
+*/
+struct memcached_mux_request_st {
+  memcached_mux_request_st *next;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  memcached_mux_request_state_t state;
+  memcached_mux_command_t command;
+  const char *key;
+  size_t key_length;
+  const char *value;
+  size_t value_length;
+  time_t expiration;
+  uint32_t flags;
+  memcached_return_t rc;
+  char *result;
+  size_t result_length;
+  uint32_t result_flags;
+
+  memcached_mux_request_st(memcached_mux_command_t command_arg, const char *key_arg,
+                           size_t key_length_arg)
+  : next(NULL)
+  , state(MUX_PENDING)
+  , command(command_arg)
+  , key(key_arg)
+  , key_length(key_length_arg)
+  , value(NULL)
+  , value_length(0)
+  , expiration(0)
+  , flags(0)
+  , rc(MEMCACHED_FAILURE)
+  , result(NULL)
+  , result_length(0)
+  , result_flags(0) {
+    pthread_mutex_init(&mutex, NULL);
+    pthread_cond_init(&cond, NULL);
+  }
+
+  ~memcached_mux_request_st() {
+    free(result);
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&cond);
+  }
+};
+
+struct memcached_mux_st {
+  /* only ever used by the I/O thread */
+  memcached_st *memc;
+  pthread_t thread;
+  bool _has_thread;
+  /* requests submitted by the calling threads, newest first */
+  std::atomic<memcached_mux_request_st *> submitted;
+  std::atomic<bool> shutdown;
+  int wakeup[2];
+  int32_t timeout;
+
+  memcached_mux_st()
+  : memc(NULL)
+  , _has_thread(false)
+  , submitted(NULL)
+  , shutdown(false)
+  , timeout(-1) {
+    wakeup[0] = wakeup[1] = -1;
+  }
+
+  ~memcached_mux_st() {
+    if (_has_thread) {
+      shutdown.store(true, std::memory_order_release);
+      wake();
+
+      int error;
+      if ((error = pthread_join(thread, NULL))) {
+        assert_vmsg(error, "pthread_join() %s", strerror(error));
+      }
+    }
+
+    /* submitted after the I/O thread went away */
+    fail(submitted.exchange(NULL, std::memory_order_acquire), MEMCACHED_CONNECTION_FAILURE);
+
+    if (wakeup[0] != -1) {
+      close(wakeup[0]);
+      close(wakeup[1]);
+    }
+    memcached_free(memc);
+  }
+
+  bool init(const memcached_st *master);
+
+  void wake() {
+    static const char byte = 0;
+    ssize_t written;
+    do {
+      written = write(wakeup[1], &byte, 1);
+    } while (written == -1 and errno == EINTR);
+  }
+
+  void push(memcached_mux_request_st *request) {
+    memcached_mux_request_st *head = submitted.load(std::memory_order_relaxed);
+    do {
+      request->next = head;
+    } while (not submitted.compare_exchange_weak(head, request, std::memory_order_release,
+                                                 std::memory_order_relaxed));
+
+    /* the I/O thread empties the pipe before it takes the requests */
+    if (head == NULL) {
+      wake();
+    }
+  }
+
+  bool wait(memcached_mux_request_st *request);
+
+  void submit();
+  void fail(memcached_mux_request_st *requests, memcached_return_t rc);
+  void run();
+};
+
+/* Completes a request on the I/O thread, or frees it if its caller gave up */
+static void mux_complete(const memcached_st *, memcached_return_t rc,
+                         const memcached_item_view_st *item, void *context) {
+  memcached_mux_request_st *request = static_cast<memcached_mux_request_st *>(context);
+
+  pthread_mutex_lock(&request->mutex);
+  if (request->state == MUX_ABANDONED) {
+    pthread_mutex_unlock(&request->mutex);
+    delete request;
+    return;
+  }
+
+  if (item) {
+    if ((request->result = static_cast<char *>(malloc(item->value_length + 1)))) {
+      memcpy(request->result, item->value, item->value_length);
+      request->result[item->value_length] = 0;
+      request->result_length = item->value_length;
+      request->result_flags = item->flags;
+    } else {
+      rc = MEMCACHED_MEMORY_ALLOCATION_FAILURE;
+    }
+  }
+  request->rc = rc;
+  request->state = MUX_DONE;
+  pthread_cond_signal(&request->cond);
+  pthread_mutex_unlock(&request->mutex);
+}
+
+void memcached_mux_st::fail(memcached_mux_request_st *requests, memcached_return_t rc) {
+  while (requests) {
+    memcached_mux_request_st *request = requests;
+    requests = requests->next;
+    mux_complete(memc, rc, NULL, request);
+  }
+}
+
+/* Hands the submitted requests over to the asynchronous API, oldest first */
+void memcached_mux_st::submit() {
+  char buffer[64];
+  while (read(wakeup[0], buffer, sizeof(buffer)) > 0) {
+  }
+
+  memcached_mux_request_st *requests = submitted.exchange(NULL, std::memory_order_acquire);
+  memcached_mux_request_st *ordered = NULL;
+  while (requests) {
+    memcached_mux_request_st *request = requests;
+    requests = requests->next;
+    request->next = ordered;
+    ordered = request;
+  }
+
+  while (ordered) {
+    memcached_mux_request_st *request = ordered;
+    ordered = ordered->next;
+
+    /* the key and value belong to the caller, which must not give up meanwhile */
+    pthread_mutex_lock(&request->mutex);
+    if (request->state == MUX_ABANDONED) {
+      pthread_mutex_unlock(&request->mutex);
+      delete request;
+      continue;
+    }
+
+    memcached_return_t rc;
+    switch (request->command) {
+    case MUX_GET:
+      rc = memcached_async_get(memc, request->key, request->key_length, mux_complete, request,
+                               NULL);
+      break;
+    case MUX_SET:
+      rc = memcached_async_set(memc, request->key, request->key_length, request->value,
+                               request->value_length, request->expiration, request->flags,
+                               mux_complete, request, NULL);
+      break;
+    case MUX_DELETE:
+    default:
+      rc = memcached_async_delete(memc, request->key, request->key_length, mux_complete, request,
+                                  NULL);
+      break;
+    }
+    pthread_mutex_unlock(&request->mutex);
+
+    if (memcached_failed(rc)) {
+      mux_complete(memc, rc, NULL, request);
+    }
+  }
+}
+
+void memcached_mux_st::run() {
+  std::vector<memcached_async_fd_st> fds;
+  std::vector<struct pollfd> pfds;
+
+  while (true) {
+    submit();
+    if (shutdown.load(std::memory_order_acquire)) {
+      break;
+    }
+
+    uint32_t count = memcached_async_fds(memc, NULL, 0);
+    fds.resize(count);
+
+    /* failed requests may have changed the picture meanwhile */
+    uint32_t filled = memcached_async_fds(memc, fds.data(), count);
+    if (filled < count) {
+      count = filled;
+    }
+
+    pfds.resize(count + 1);
+    for (uint32_t x = 0; x < count; ++x) {
+      pfds[x].fd = fds[x].fd;
+      pfds[x].events = fds[x].events;
+      pfds[x].revents = 0;
+    }
+    pfds[count].fd = wakeup[0];
+    pfds[count].events = POLLIN;
+    pfds[count].revents = 0;
+
+    /* wakes up regularly, so that memcached_async_fds() fails overdue requests */
+    if (poll(pfds.data(), count + 1, count ? timeout : -1) == -1) {
+      continue;
+    }
+
+    for (uint32_t x = 0; x < count; ++x) {
+      if (pfds[x].revents) {
+        (void) memcached_async_process(memc, pfds[x].fd, pfds[x].revents);
+      }
+    }
+  }
+
+  /* fails the requests still awaiting their response */
+  memcached_free(memc);
+  memc = NULL;
+}
+
+static void *mux_thread(void *arg) {
+  static_cast<memcached_mux_st *>(arg)->run();
+  return NULL;
+}
+
+bool memcached_mux_st::init(const memcached_st *master) {
+  if ((memc = memcached_clone(NULL, master)) == NULL) {
+    return false;
+  }
+  if (memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_USE_UDP)) {
+    return false;
+  }
+  if (memcached_failed(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_BINARY_PROTOCOL, 1))) {
+    return false;
+  }
+  timeout = master->poll_timeout;
+
+  if (pipe(wakeup) == -1) {
+    wakeup[0] = wakeup[1] = -1;
+    return false;
+  }
+  for (int x = 0; x < 2; ++x) {
+    fcntl(wakeup[x], F_SETFL, fcntl(wakeup[x], F_GETFL) | O_NONBLOCK);
+    fcntl(wakeup[x], F_SETFD, FD_CLOEXEC);
+  }
+
+  if (pthread_create(&thread, NULL, mux_thread, this)) {
+    return false;
+  }
+  _has_thread = true;
+
+  return true;
+}
+
+/* Submits the request and waits for its completion; false if the caller gave up on it */
+bool memcached_mux_st::wait(memcached_mux_request_st *request) {
+  struct timespec deadline;
+  if (timeout >= 0) {
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (timeout % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+  }
+
+  push(request);
+
+  pthread_mutex_lock(&request->mutex);
+  while (request->state == MUX_PENDING) {
+    if (timeout < 0) {
+      pthread_cond_wait(&request->cond, &request->mutex);
+    } else if (pthread_cond_timedwait(&request->cond, &request->mutex, &deadline) == ETIMEDOUT) {
+      break;
+    }
+  }
+
+  if (request->state == MUX_PENDING) {
+    /* the response may still arrive, the I/O thread frees the request then */
+    request->state = MUX_ABANDONED;
+    pthread_mutex_unlock(&request->mutex);
+    return false;
+  }
+  pthread_mutex_unlock(&request->mutex);
+
+  return true;
+}
+
+memcached_mux_st *memcached_mux_create(const memcached_st *master) {
+  if (master == NULL) {
+    return NULL;
+  }
+
+  memcached_mux_st *mux = new (std::nothrow) memcached_mux_st;
+  if (mux and mux->init(master) == false) {
+    delete mux;
+    return NULL;
+  }
+
+  return mux;
+}
+
+memcached_mux_st *memcached_mux(const char *option_string, size_t option_string_length) {
+  memcached_st *memc = memcached(option_string, option_string_length);
+
+  if (memc == NULL) {
+    return NULL;
+  }
+
+  memcached_mux_st *mux = memcached_mux_create(memc);
+  memcached_free(memc);
+
+  return mux;
+}
+
+void memcached_mux_destroy(memcached_mux_st *mux) {
+  delete mux;
+}
+
+char *memcached_mux_get(memcached_mux_st *mux, const char *key, size_t key_length,
+                        size_t *value_length, uint32_t *flags, memcached_return_t *error) {
+  memcached_return_t unused;
+  if (error == NULL) {
+    error = &unused;
+  }
+
+  if (mux == NULL) {
+    *error = MEMCACHED_INVALID_ARGUMENTS;
+    return NULL;
+  }
+
+  memcached_mux_request_st *request =
+      new (std::nothrow) memcached_mux_request_st(MUX_GET, key, key_length);
+  if (request == NULL) {
+    *error = MEMCACHED_MEMORY_ALLOCATION_FAILURE;
+    return NULL;
+  }
+
+  if (mux->wait(request) == false) {
+    *error = MEMCACHED_TIMEOUT;
+    return NULL;
+  }
+
+  *error = request->rc;
+  char *value = request->result;
+  if (value_length) {
+    *value_length = request->result_length;
+  }
+  if (flags) {
+    *flags = request->result_flags;
+  }
+  request->result = NULL;
+  delete request;
+
+  return value;
+}
+
+memcached_return_t memcached_mux_set(memcached_mux_st *mux, const char *key, size_t key_length,
+                                     const char *value, size_t value_length, time_t expiration,
+                                     uint32_t flags) {
+  if (mux == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  memcached_mux_request_st *request =
+      new (std::nothrow) memcached_mux_request_st(MUX_SET, key, key_length);
+  if (request == NULL) {
+    return MEMCACHED_MEMORY_ALLOCATION_FAILURE;
+  }
+  request->value = value;
+  request->value_length = value_length;
+  request->expiration = expiration;
+  request->flags = flags;
+
+  if (mux->wait(request) == false) {
+    return MEMCACHED_TIMEOUT;
+  }
+
+  memcached_return_t rc = request->rc;
+  delete request;
+
+  return rc;
+}
+
+memcached_return_t memcached_mux_delete(memcached_mux_st *mux, const char *key,
+                                        size_t key_length) {
+  if (mux == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  memcached_mux_request_st *request =
+      new (std::nothrow) memcached_mux_request_st(MUX_DELETE, key, key_length);
+  if (request == NULL) {
+    return MEMCACHED_MEMORY_ALLOCATION_FAILURE;
+  }
+
+  if (mux->wait(request) == false) {
+    return MEMCACHED_TIMEOUT;
+  }
+
+  memcached_return_t rc = request->rc;
+  delete request;
+
+  return rc;
+}
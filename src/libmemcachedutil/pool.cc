@@ -20,8 +20,137 @@
 #include <cstring>
 #include <ctime>
 #include <pthread.h>
+#include <atomic>
 #include <memory>
 
+/* The maximum number of slots caching released memcached_st per thread */
+#define MEMCACHED_POOL_THREAD_CACHE_SIZE 64
+
+/* The number of recent changes a stale memcached_st can catch up on without a clone */
+#define MEMCACHED_POOL_CHANGES 32
+
+/* A behavior or server list change of the master, replayed on the stale objects */
+struct memcached_pool_change_st {
+  int32_t version;
+  bool servers;
+  memcached_behavior_t flag;
+  uint64_t data;
+};
+
+/*
+  A released memcached_st kept for the next fetch of the thread(s) hashing to
+  the slot, padded to a cache line of its own.
+*/
+struct memcached_pool_cache_st {
+  std::atomic<memcached_st *> memc;
+  char padding[64 - sizeof(std::atomic<memcached_st *>)];
+};
+
+/*
+  Bounded lock-free multi-producer/multi-consumer queue of idle memcached_st,
+  after Dmitry Vyukov. Its capacity is at least the size of the pool, so a
+  push always finds a cell.
+*/
+class memcached_pool_queue_st {
+public:
+  memcached_pool_queue_st()
+  : _cells(NULL)
+  , _mask(0)
+  , _head(0)
+  , _tail(0) {}
+
+  ~memcached_pool_queue_st() {
+    delete[] _cells;
+  }
+
+  bool init(uint32_t size) {
+    size_t capacity = 1;
+    while (capacity < size) {
+      capacity <<= 1;
+    }
+
+    if ((_cells = new (std::nothrow) cell[capacity]) == NULL) {
+      return false;
+    }
+    for (size_t x = 0; x < capacity; ++x) {
+      _cells[x].sequence.store(x, std::memory_order_relaxed);
+      _cells[x].memc = NULL;
+    }
+    _mask = capacity - 1;
+
+    return true;
+  }
+
+  void push(memcached_st *memc) {
+    cell *c;
+    size_t pos = _tail.load(std::memory_order_relaxed);
+
+    while (true) {
+      c = &_cells[pos & _mask];
+      intptr_t dif = intptr_t(c->sequence.load(std::memory_order_acquire)) - intptr_t(pos);
+
+      if (dif == 0) {
+        if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else {
+        /* dif < 0 only while a pop of the previous round is completing */
+        pos = _tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    c->memc = memc;
+    c->sequence.store(pos + 1, std::memory_order_release);
+  }
+
+  memcached_st *pop() {
+    cell *c;
+    size_t pos = _head.load(std::memory_order_relaxed);
+
+    while (true) {
+      c = &_cells[pos & _mask];
+      intptr_t dif = intptr_t(c->sequence.load(std::memory_order_acquire)) - intptr_t(pos + 1);
+
+      if (dif == 0) {
+        if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return NULL;
+      } else {
+        pos = _head.load(std::memory_order_relaxed);
+      }
+    }
+
+    memcached_st *memc = c->memc;
+    c->sequence.store(pos + _mask + 1, std::memory_order_release);
+
+    return memc;
+  }
+
+private:
+  struct cell {
+    std::atomic<size_t> sequence;
+    memcached_st *memc;
+  };
+
+  cell *_cells;
+  size_t _mask;
+  char _pad0[64];
+  std::atomic<size_t> _head;
+  char _pad1[64];
+  std::atomic<size_t> _tail;
+  char _pad2[64];
+};
+
+/* A small number identifying the calling thread, hashing it to a cache slot */
+static inline uint32_t pool_thread_index() {
+  static std::atomic<uint32_t> threads(0);
+  static thread_local uint32_t index = threads.fetch_add(1, std::memory_order_relaxed);
+
+  return index;
+}
+
 struct memcached_pool_st {
   pthread_mutex_t mutex;
   pthread_cond_t cond;
@@ -32,6 +161,13 @@ struct memcached_pool_st {
   uint32_t current_size;
   bool _owns_master;
   struct timespec _timeout;
+  /* with --POOL-THREAD-CACHE, idle objects live in cache and idle instead of server_pool */
+  memcached_pool_cache_st *cache;
+  uint32_t cache_mask;
+  memcached_pool_queue_st idle;
+  std::atomic<uint32_t> waiters;
+  std::atomic<int32_t> _version;
+  memcached_pool_change_st changes[MEMCACHED_POOL_CHANGES];
 
   memcached_pool_st(memcached_st *master_arg, size_t max_arg)
   : master(master_arg)
@@ -39,11 +175,16 @@ struct memcached_pool_st {
   , firstfree(-1)
   , size(uint32_t(max_arg))
   , current_size(0)
-  , _owns_master(false) {
+  , _owns_master(false)
+  , cache(NULL)
+  , cache_mask(0)
+  , waiters(0)
+  , _version(master_arg->configure.version) {
     pthread_mutex_init(&mutex, NULL);
     pthread_cond_init(&cond, NULL);
     _timeout.tv_sec = 5;
     _timeout.tv_nsec = 0;
+    memset(changes, 0, sizeof(changes));
   }
 
   const struct timespec &timeout() const {
@@ -57,11 +198,28 @@ struct memcached_pool_st {
 
   bool init(uint32_t initial);
 
+  memcached_pool_cache_st &thread_cache() {
+    return cache[pool_thread_index() & cache_mask];
+  }
+
+  memcached_st *pop_idle();
+  void push_idle(memcached_st *);
+  memcached_st *refresh(memcached_st *);
+  memcached_st *renew(memcached_st *);
+  bool update(memcached_st *);
+
   ~memcached_pool_st() {
     for (int x = 0; x <= firstfree; ++x) {
       memcached_free(server_pool[x]);
       server_pool[x] = NULL;
     }
+    if (cache) {
+      memcached_st *memc;
+      while ((memc = pop_idle())) {
+        memcached_free(memc);
+      }
+      delete[] cache;
+    }
 
     int error;
     if ((error = pthread_mutex_destroy(&mutex))) {
@@ -79,7 +237,17 @@ struct memcached_pool_st {
   }
 
   void increment_version() {
-    ++master->configure.version;
+    _version.store(++master->configure.version, std::memory_order_relaxed);
+  }
+
+  void log_change(bool servers, memcached_behavior_t flag, uint64_t data) {
+    increment_version();
+
+    memcached_pool_change_st &change = changes[uint32_t(version()) % MEMCACHED_POOL_CHANGES];
+    change.version = version();
+    change.servers = servers;
+    change.flag = flag;
+    change.data = data;
   }
 
   bool compare_version(const memcached_st *arg) const {
@@ -87,10 +255,113 @@ struct memcached_pool_st {
   }
 
   int32_t version() const {
-    return master->configure.version;
+    return _version.load(std::memory_order_relaxed);
   }
 };
 
+/* Takes an idle object of any thread, the calling thread's cached one first */
+memcached_st *memcached_pool_st::pop_idle() {
+  memcached_st *memc;
+  if ((memc = idle.pop())) {
+    return memc;
+  }
+
+  for (uint32_t x = 0; x <= cache_mask; ++x) {
+    memcached_pool_cache_st &slot = cache[x];
+    if (slot.memc.load(std::memory_order_relaxed)
+        and (memc = slot.memc.exchange(NULL, std::memory_order_acquire)))
+    {
+      return memc;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+  Replays the changes of the master the object missed, in place, so that it keeps its
+  connections to unchanged servers. Fails if the changes are not logged anymore, or one
+  of them cannot be applied. Called with the mutex held.
+*/
+bool memcached_pool_st::update(memcached_st *memc) {
+  uint32_t missed = uint32_t(version()) - uint32_t(memc->configure.version);
+  if (missed > MEMCACHED_POOL_CHANGES) {
+    return false;
+  }
+
+  for (uint32_t v = uint32_t(memc->configure.version) + 1; missed; --missed, ++v) {
+    const memcached_pool_change_st &change = changes[v % MEMCACHED_POOL_CHANGES];
+    if (uint32_t(change.version) != v) {
+      return false;
+    }
+
+    memcached_return_t rc;
+    if (change.servers) {
+      rc = memcached_servers_update(memc, master);
+    } else {
+      rc = memcached_behavior_set(memc, change.flag, change.data);
+    }
+    if (memcached_failed(rc)) {
+      return false;
+    }
+    memc->configure.version = int32_t(v);
+  }
+
+  return true;
+}
+
+/*
+  Someone updated the behavior or the servers of the master, so we update the object in
+  place, or clone a new memcached_st with the new settings. If we fail to clone, we keep
+  the old one around. Called with the mutex held.
+*/
+memcached_st *memcached_pool_st::renew(memcached_st *memc) {
+  if (compare_version(memc) or update(memc)) {
+    return memc;
+  }
+
+  memcached_st *clone;
+  if ((clone = memcached_clone(NULL, master))) {
+    memcached_free(memc);
+    memc = clone;
+  }
+
+  return memc;
+}
+
+memcached_st *memcached_pool_st::refresh(memcached_st *memc) {
+  if (compare_version(memc)) {
+    return memc;
+  }
+
+  int error;
+  if ((error = pthread_mutex_lock(&mutex))) {
+    return memc;
+  }
+
+  memc = renew(memc);
+
+  if ((error = pthread_mutex_unlock(&mutex))) {
+    assert_vmsg(error, "pthread_mutex_unlock() %s", strerror(error));
+  }
+
+  return memc;
+}
+
+void memcached_pool_st::push_idle(memcached_st *memc) {
+  memcached_pool_cache_st &slot = thread_cache();
+
+  /* threads sharing a slot swap their objects, the loser goes to the queue */
+  if (waiters.load(std::memory_order_relaxed) == 0
+      and slot.memc.load(std::memory_order_relaxed) == NULL)
+  {
+    memc = slot.memc.exchange(memc, std::memory_order_acq_rel);
+  }
+  if (memc) {
+    idle.push(memc);
+  }
+}
+
 /**
  * Grow the connection pool by creating a connection structure and clone the
  * original memcached handle.
@@ -103,16 +374,37 @@ static bool grow_pool(memcached_pool_st *pool) {
     return false;
   }
 
-  pool->server_pool[++pool->firstfree] = obj;
-  pool->current_size++;
+  /* before publishing it, a lock-free fetch() may take it right away */
   obj->configure.version = pool->version();
 
+  if (pool->cache) {
+    pool->idle.push(obj);
+  } else {
+    pool->server_pool[++pool->firstfree] = obj;
+  }
+  pool->current_size++;
+
   return true;
 }
 
 bool memcached_pool_st::init(uint32_t initial) {
-  server_pool = new (std::nothrow) memcached_st *[size];
-  if (server_pool == NULL) {
+  if (master->configure.pool_thread_cache) {
+    cache_mask = 1;
+    while (cache_mask < size and cache_mask < MEMCACHED_POOL_THREAD_CACHE_SIZE) {
+      cache_mask <<= 1;
+    }
+    if ((cache = new (std::nothrow) memcached_pool_cache_st[cache_mask]) == NULL) {
+      return false;
+    }
+    for (uint32_t x = 0; x < cache_mask; ++x) {
+      cache[x].memc.store(NULL, std::memory_order_relaxed);
+    }
+    --cache_mask;
+
+    if (idle.init(size) == false) {
+      return false;
+    }
+  } else if ((server_pool = new (std::nothrow) memcached_st *[size]) == NULL) {
     return false;
   }
 
@@ -197,20 +489,57 @@ memcached_st *memcached_pool_st::fetch(memcached_return_t &rc) {
   return fetch(relative_time, rc);
 }
 
+/* Counts the threads waiting for an idle object under the mutex, see release() */
+class PoolWaiter {
+public:
+  PoolWaiter(memcached_pool_st *pool)
+  : _pool(pool->cache ? pool : NULL) {
+    if (_pool) {
+      _pool->waiters.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  ~PoolWaiter() {
+    if (_pool) {
+      _pool->waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+private:
+  memcached_pool_st *_pool;
+};
+
 memcached_st *memcached_pool_st::fetch(const struct timespec &relative_time,
                                        memcached_return_t &rc) {
   rc = MEMCACHED_SUCCESS;
 
+  /* the calling thread's cached object, or any queued one, without locking */
+  if (cache) {
+    memcached_pool_cache_st &slot = thread_cache();
+    memcached_st *ret = NULL;
+
+    if (slot.memc.load(std::memory_order_relaxed)) {
+      ret = slot.memc.exchange(NULL, std::memory_order_acquire);
+    }
+    if (ret or (ret = idle.pop())) {
+      return refresh(ret);
+    }
+  }
+
   int error;
   if ((error = pthread_mutex_lock(&mutex))) {
     rc = MEMCACHED_IN_PROGRESS;
     return NULL;
   }
 
+  PoolWaiter waiter(this);
   memcached_st *ret = NULL;
   do {
     if (firstfree > -1) {
       ret = server_pool[firstfree--];
+    } else if (cache and (ret = pop_idle())) {
+      /* queued meanwhile or cached by another thread */
     } else if (current_size == size) {
       if (relative_time.tv_sec == 0 and relative_time.tv_nsec == 0) {
         error = pthread_mutex_unlock(&mutex);
@@ -253,7 +582,7 @@ memcached_st *memcached_pool_st::fetch(const struct timespec &relative_time,
     assert_vmsg(error, "pthread_mutex_unlock() %s", strerror(error));
   }
 
-  return ret;
+  return cache ? refresh(ret) : ret;
 }
 
 bool memcached_pool_st::release(memcached_st *released, memcached_return_t &rc) {
@@ -264,24 +593,33 @@ bool memcached_pool_st::release(memcached_st *released, memcached_return_t &rc)
   }
 
   int error;
+  if (cache) {
+    push_idle(refresh(released));
+
+    /* pairs with PoolWaiter, either a waiter finds the object or we find the waiter */
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed)) {
+      if ((error = pthread_mutex_lock(&mutex))) {
+        rc = MEMCACHED_IN_PROGRESS;
+        return false;
+      }
+      if ((error = pthread_cond_broadcast(&cond))) {
+        assert_vmsg(error, "pthread_cond_broadcast() %s", strerror(error));
+      }
+      if ((error = pthread_mutex_unlock(&mutex))) {
+        assert_vmsg(error, "pthread_mutex_unlock() %s", strerror(error));
+      }
+    }
+
+    return true;
+  }
+
   if ((error = pthread_mutex_lock(&mutex))) {
     rc = MEMCACHED_IN_PROGRESS;
     return false;
   }
 
-  /*
-    Someone updated the behavior on the object, so we clone a new memcached_st with the new
-    settings. If we fail to clone, we keep the old one around.
-  */
-  if (compare_version(released) == false) {
-    memcached_st *memc;
-    if ((memc = memcached_clone(NULL, master))) {
-      memcached_free(released);
-      released = memc;
-    }
-  }
-
-  server_pool[++firstfree] = released;
+  server_pool[++firstfree] = renew(released);
 
   if (firstfree == 0 and current_size == size) {
     /* we might have people waiting for a connection.. wake them up :-) */
@@ -350,6 +688,32 @@ memcached_return_t memcached_pool_push(memcached_pool_st *pool, memcached_st *re
   return memcached_pool_release(pool, released);
 }
 
+/* Brings the idle objects up to date with the master, called with the mutex held */
+static void update_idle(memcached_pool_st *pool) {
+  /* take the idle clones out of the thread caches and the queue */
+  memcached_st **server_pool = pool->server_pool;
+  int firstfree = pool->firstfree;
+  if (pool->cache) {
+    server_pool = new (std::nothrow) memcached_st *[pool->size + 1];
+    for (firstfree = -1; server_pool and (server_pool[firstfree + 1] = pool->pop_idle());) {
+      ++firstfree;
+    }
+  }
+
+  /* update the clones */
+  for (int xx = 0; xx <= firstfree; ++xx) {
+    server_pool[xx] = pool->renew(server_pool[xx]);
+  }
+
+  /* without memory, the clones are refreshed when fetched */
+  if (pool->cache and server_pool) {
+    for (int xx = 0; xx <= firstfree; ++xx) {
+      pool->idle.push(server_pool[xx]);
+    }
+    delete[] server_pool;
+  }
+}
+
 memcached_return_t memcached_pool_behavior_set(memcached_pool_st *pool, memcached_behavior_t flag,
                                                uint64_t data) {
   if (pool == NULL) {
@@ -370,29 +734,49 @@ memcached_return_t memcached_pool_behavior_set(memcached_pool_st *pool, memcache
     return rc;
   }
 
-  pool->increment_version();
-  /* update the clones */
-  for (int xx = 0; xx <= pool->firstfree; ++xx) {
-    if (memcached_success(memcached_behavior_set(pool->server_pool[xx], flag, data))) {
-      pool->server_pool[xx]->configure.version = pool->version();
-    } else {
-      memcached_st *memc;
-      if ((memc = memcached_clone(NULL, pool->master))) {
-        memcached_free(pool->server_pool[xx]);
-        pool->server_pool[xx] = memc;
-        /* I'm not sure what to do in this case.. this would happen
-          if we fail to push the server list inside the client..
-          I should add a testcase for this, but I believe the following
-          would work, except that you would add a hole in the pool list..
-          in theory you could end up with an empty pool....
-        */
-      }
-    }
+  pool->log_change(false, flag, data);
+  update_idle(pool);
+
+  if ((error = pthread_mutex_unlock(&pool->mutex))) {
+    assert_vmsg(error, "pthread_mutex_unlock() %s", strerror(error));
+  }
+
+  return rc;
+}
+
+memcached_return_t memcached_pool_servers_set(memcached_pool_st *pool,
+                                              const memcached_server_list_st servers) {
+  if (pool == NULL or servers == NULL) {
+    return MEMCACHED_INVALID_ARGUMENTS;
+  }
+
+  /* the new list, so that the master is left unchanged on failure */
+  memcached_st *source = memcached_create(NULL);
+  if (source == NULL) {
+    return MEMCACHED_MEMORY_ALLOCATION_FAILURE;
+  }
+  memcached_return_t rc = memcached_server_push(source, servers);
+  if (memcached_failed(rc)) {
+    memcached_free(source);
+    return rc;
+  }
+
+  int error;
+  if ((error = pthread_mutex_lock(&pool->mutex))) {
+    memcached_free(source);
+    return MEMCACHED_IN_PROGRESS;
+  }
+
+  /* update the master, and the clones with it */
+  if (memcached_success(rc = memcached_servers_update(pool->master, source))) {
+    pool->log_change(true, MEMCACHED_BEHAVIOR_MAX, 0);
+    update_idle(pool);
   }
 
   if ((error = pthread_mutex_unlock(&pool->mutex))) {
     assert_vmsg(error, "pthread_mutex_unlock() %s", strerror(error));
   }
+  memcached_free(source);
 
   return rc;
 }
@@ -110,4 +110,16 @@ static const uint32_t output[][sizeof(input) / sizeof(*input)] = {
 #else
     {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
 #endif
+
+    // xxh3
+    {3474950656U, 3000374375U, 574189493U,  549264011U,  1625257112U, 1753333296U, 2597739649U,
+     2029491924U, 1486619790U, 468642544U,  2199318854U, 1571892260U, 2927675166U, 1855447207U,
+     2046325741U, 2011337361U, 118527975U,  1338212001U, 32100224U,   1431756618U, 844296548U,
+     969576427U,  2696123247U, 2637934996U, 2685403122U, 1099936613U},
+
+    // wyhash
+    {2915601413U, 1340873932U, 2226975950U, 89366774U,   2183393621U, 2014649578U, 4252474569U,
+     1932125915U, 1626040622U, 4286905748U, 2386125208U, 2895259125U, 652941246U,  3515621851U,
+     296207198U,  3597148232U, 572408847U,  1892430675U, 2599335598U, 821912781U,  1028260022U,
+     2324054193U, 3926161315U, 2153622222U, 1543391131U, 3729106289U},
 };
@@ -144,11 +144,19 @@ static test_case behavior_tests[] = {
      MEMCACHED_HASH_JENKINS},
     {S("--DISTRIBUTION=random"), MEMCACHED_BEHAVIOR_DISTRIBUTION, MEMCACHED_DISTRIBUTION_RANDOM},
     {S("--DISTRIBUTION=modula"), MEMCACHED_BEHAVIOR_DISTRIBUTION, MEMCACHED_DISTRIBUTION_MODULA},
+    {S("--DISTRIBUTION=jump"), MEMCACHED_BEHAVIOR_DISTRIBUTION, MEMCACHED_DISTRIBUTION_JUMP},
+    {S("--DISTRIBUTION=rendezvous"), MEMCACHED_BEHAVIOR_DISTRIBUTION,
+     MEMCACHED_DISTRIBUTION_RENDEZVOUS},
+    {S("--DISTRIBUTION=rendezvous_skeleton"), MEMCACHED_BEHAVIOR_DISTRIBUTION,
+     MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON},
+    {S("--DISTRIBUTION=maglev"), MEMCACHED_BEHAVIOR_DISTRIBUTION, MEMCACHED_DISTRIBUTION_MAGLEV},
     {S("--HASH=CRC"), MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_CRC},
     {S("--HASH=FNV1A_32"), MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_FNV1A_32},
     {S("--HASH=FNV1_32"), MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_FNV1_32},
     {S("--HASH=JENKINS"), MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_JENKINS},
     {S("--HASH=MD5"), MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_MD5},
+    {S("--HASH=XXH3"), MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_XXH3},
+    {S("--HASH=WYHASH"), MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_WYHASH},
 
 };
 
@@ -68,6 +68,116 @@ TEST_CASE("hashkit") {
     }
   }
 
+  SECTION("can digest batch") {
+    vector<size_t> lengths;
+    for (auto i : input) {
+      lengths.push_back(strlen(i));
+    }
+
+    for (int f = HASHKIT_HASH_DEFAULT; f < HASHKIT_HASH_MAX; ++f) {
+      auto h = static_cast<hashkit_hash_algorithm_t>(f);
+
+      if (h == HASHKIT_HASH_CUSTOM or !libhashkit_has_algorithm(h)) {
+        continue;
+      }
+
+      INFO("hash: " << libhashkit_string_hash(h));
+      REQUIRE(HASHKIT_SUCCESS == hashkit_set_function(&st, h));
+
+      uint32_t hashes[sizeof(input) / sizeof(input[0])];
+      REQUIRE(hashkit_digest_batch(&st, nullptr, 0, input, lengths.data(), lengths.size(), hashes));
+      for (auto n = 0U; n < lengths.size(); ++n) {
+        CHECK(output[f][n] == hashes[n]);
+      }
+
+      REQUIRE(hashkit_digest_batch(&st, S("prefix:"), input, lengths.data(), lengths.size(), hashes));
+      for (auto n = 0U; n < lengths.size(); ++n) {
+        string key = "prefix:" + string(input[n]);
+        CHECK(hashkit_digest(&st, key.data(), key.size()) == hashes[n]);
+      }
+    }
+  }
+
+  SECTION("can md5 sign batch") {
+    vector<string> keys;
+    vector<const unsigned char *> ptrs;
+    vector<size_t> lengths;
+    for (auto n = 0U; n < 21; ++n) {
+      keys.push_back(random_ascii_string(n * 13));
+    }
+    for (auto &key : keys) {
+      ptrs.push_back(reinterpret_cast<const unsigned char *>(key.data()));
+      lengths.push_back(key.size());
+    }
+
+    for (auto prefix : {string{}, string{"prefix:"}, random_ascii_string(100)}) {
+      vector<unsigned char> results(16 * keys.size());
+      libhashkit_md5_signature_batch(reinterpret_cast<const unsigned char *>(prefix.data()),
+                                     prefix.size(), ptrs.data(), lengths.data(), keys.size(),
+                                     results.data());
+      for (auto n = 0U; n < keys.size(); ++n) {
+        string message = prefix + keys[n];
+        unsigned char result[16];
+        libhashkit_md5_signature(reinterpret_cast<const unsigned char *>(message.data()),
+                                 message.size(), result);
+        CHECK(0 == memcmp(result, &results[16 * n], 16));
+      }
+    }
+  }
+
+  SECTION("can encrypt buffer") {
+    REQUIRE(hashkit_key(&st, S("the encoding key")));
+
+    for (auto length : {0U, 1U, 15U, 16U, 17U, 100U, 5000U}) {
+      auto value = random_ascii_string(length);
+      INFO("length: " << length);
+
+      for (auto mode : {HASHKIT_CIPHER_MODE_DEFAULT, HASHKIT_CIPHER_MODE_CTR}) {
+        INFO("mode: " << mode);
+
+        vector<char> encrypted(hashkit_encrypt_length(&st, mode, length));
+        size_t encrypted_length = encrypted.size();
+        REQUIRE(hashkit_encrypt_buffer(&st, mode, value.data(), value.size(), encrypted.data(),
+                                       &encrypted_length));
+        REQUIRE(encrypted_length == encrypted.size());
+
+        vector<char> decrypted(encrypted_length);
+        size_t decrypted_length = decrypted.size();
+        REQUIRE(hashkit_decrypt_buffer(&st, mode, encrypted.data(), encrypted_length,
+                                       decrypted.data(), &decrypted_length));
+        REQUIRE(value == string(decrypted.data(), decrypted_length));
+
+        decrypted_length = encrypted_length;
+        REQUIRE(hashkit_decrypt_buffer(&st, mode, encrypted.data(), encrypted_length,
+                                       encrypted.data(), &decrypted_length));
+        REQUIRE(value == string(encrypted.data(), decrypted_length));
+
+        size_t too_short = hashkit_encrypt_length(&st, mode, length) - 1;
+        REQUIRE_FALSE(hashkit_encrypt_buffer(&st, mode, value.data(), value.size(),
+                                             encrypted.data(), &too_short));
+      }
+
+      vector<char> first(hashkit_encrypt_length(&st, HASHKIT_CIPHER_MODE_CTR, length)),
+          second(first.size());
+      size_t first_length = first.size(), second_length = second.size();
+      REQUIRE(hashkit_encrypt_buffer(&st, HASHKIT_CIPHER_MODE_CTR, value.data(), value.size(),
+                                     first.data(), &first_length));
+      REQUIRE(hashkit_encrypt_buffer(&st, HASHKIT_CIPHER_MODE_CTR, value.data(), value.size(),
+                                     second.data(), &second_length));
+      REQUIRE(first != second);
+
+      auto encrypted = hashkit_encrypt(&st, value.data(), value.size());
+      REQUIRE(encrypted);
+      vector<char> buffer(hashkit_encrypt_length(&st, HASHKIT_CIPHER_MODE_DEFAULT, length));
+      size_t buffer_length = buffer.size();
+      REQUIRE(hashkit_encrypt_buffer(&st, HASHKIT_CIPHER_MODE_DEFAULT, value.data(), value.size(),
+                                     buffer.data(), &buffer_length));
+      REQUIRE(string(hashkit_string_c_str(encrypted), hashkit_string_length(encrypted))
+              == string(buffer.data(), buffer_length));
+      hashkit_string_free(encrypted);
+    }
+  }
+
   SECTION("is comparable") {
     REQUIRE(*heap == stack);
     REQUIRE(hashkit_compare(&st, hp));
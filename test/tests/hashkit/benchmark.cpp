@@ -0,0 +1,48 @@
+#include "test/lib/common.hpp"
+
+#include "libhashkit-1.0/hashkit.h"
+
+// not matched by the TEST_SPEC of ctest, run with: runtests 'bench/*'
+TEST_CASE("bench/hashkit") {
+  auto length = GENERATE(as<size_t>{}, 8, 40, 100, 200);
+  vector<string> keys;
+  vector<const char *> ptrs;
+  vector<size_t> lengths;
+  vector<uint32_t> hashes(1000);
+  hashkit_st hashkit;
+
+  REQUIRE(hashkit_create(&hashkit));
+
+  for (auto i = 0; i < 1000; ++i) {
+    keys.emplace_back(random_ascii_string(length));
+  }
+  for (const auto &key : keys) {
+    ptrs.push_back(key.data());
+    lengths.push_back(key.size());
+  }
+
+  for (int f = HASHKIT_HASH_DEFAULT; f < HASHKIT_HASH_MAX; ++f) {
+    auto h = static_cast<hashkit_hash_algorithm_t>(f);
+
+    if (h == HASHKIT_HASH_CUSTOM or !libhashkit_has_algorithm(h)) {
+      continue;
+    }
+
+    REQUIRE(HASHKIT_SUCCESS == hashkit_set_function(&hashkit, h));
+
+    BENCHMARK(libhashkit_string_hash(h) + string("/") + to_string(length)) {
+      uint32_t sum = 0;
+      for (const auto &key : keys) {
+        sum += hashkit_digest(&hashkit, key.data(), key.size());
+      }
+      return sum;
+    };
+
+    BENCHMARK(libhashkit_string_hash(h) + string("/batch/") + to_string(length)) {
+      return hashkit_digest_batch(&hashkit, nullptr, 0, ptrs.data(), lengths.data(), ptrs.size(),
+                                  hashes.data());
+    };
+  }
+
+  hashkit_free(&hashkit);
+}
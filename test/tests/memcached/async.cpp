@@ -0,0 +1,166 @@
+#include "test/lib/common.hpp"
+#include "test/lib/MemcachedCluster.hpp"
+
+#include <poll.h>
+#include <csignal>
+
+struct async_results {
+  size_t succeeded = 0;
+  size_t not_found = 0;
+  size_t failed = 0;
+  map<string, string> values;
+};
+
+static void async_cb(const memcached_st *, memcached_return_t rc,
+                     const memcached_item_view_st *item, void *ctx) {
+  auto results = static_cast<async_results *>(ctx);
+  if (rc == MEMCACHED_SUCCESS) {
+    ++results->succeeded;
+    if (item) {
+      results->values.emplace(string{item->key, item->key_length},
+                              string{item->value, item->value_length});
+    }
+  } else if (rc == MEMCACHED_NOTFOUND) {
+    ++results->not_found;
+  } else {
+    ++results->failed;
+  }
+}
+
+static void async_quit_cb(const memcached_st *memc, memcached_return_t rc,
+                          const memcached_item_view_st *item, void *ctx) {
+  auto results = static_cast<async_results *>(ctx);
+  if (results->succeeded + results->failed == 0) {
+    memcached_quit(const_cast<memcached_st *>(memc));
+  }
+  async_cb(memc, rc, item, ctx);
+}
+
+TEST_CASE("memcached_async") {
+  auto test = MemcachedCluster::network();
+  auto memc = &test.memc;
+
+  SECTION("needs binary protocol") {
+    test.enableBinaryProto(false);
+    REQUIRE_RC(MEMCACHED_NOT_SUPPORTED,
+               memcached_async_get(memc, S(__func__), async_cb, nullptr, nullptr));
+  }
+
+  SECTION("times out") {
+    async_results results;
+
+    test.enableBinaryProto(true);
+    REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_POLL_TIMEOUT, 100));
+    REQUIRE_SUCCESS(memcached_async_get(memc, S(__func__), async_cb, &results, nullptr));
+    for (auto &server : test.cluster.getServers()) {
+      REQUIRE(0 == kill(server.getPid(), SIGSTOP));
+    }
+
+    for (auto i = 0; i < 10 and memcached_async_pending(memc); ++i) {
+      memcached_async_poll(memc, 100);
+    }
+    for (auto &server : test.cluster.getServers()) {
+      REQUIRE(0 == kill(server.getPid(), SIGCONT));
+    }
+    REQUIRE(memcached_async_pending(memc) == 0);
+    REQUIRE(results.failed == 1);
+  }
+
+  SECTION("callback closes the connection") {
+    constexpr auto NUM_KEYS = 100;
+    async_results results;
+
+    test.enableBinaryProto(true);
+    for (auto i = 0; i < NUM_KEYS; ++i) {
+      auto key = "async" + to_string(i);
+      REQUIRE_SUCCESS(memcached_async_set(memc, key.c_str(), key.length(), S("value"), 0, 0,
+                                          async_quit_cb, &results, nullptr));
+    }
+
+    for (auto i = 0; i < 10 and memcached_async_pending(memc); ++i) {
+      memcached_async_poll(memc, 1000);
+    }
+    REQUIRE(memcached_async_pending(memc) == 0);
+    // the responses read along with the first one are dropped with the connection
+    REQUIRE(results.succeeded == 1);
+    REQUIRE(results.failed == NUM_KEYS - 1);
+  }
+
+  SECTION("requests") {
+    constexpr auto NUM_KEYS = 500;
+    async_results results;
+
+    test.enableBinaryProto(true);
+
+    for (auto i = 0; i < NUM_KEYS; ++i) {
+      auto key = "async" + to_string(i);
+      auto value = random_ascii_string(i % 100 ? 64 : 3 * MEMCACHED_MAX_BUFFER);
+      REQUIRE_SUCCESS(memcached_async_set(memc, key.c_str(), key.length(), value.c_str(),
+                                          value.length(), 0, 0, async_cb, &results, nullptr));
+      results.values[key] = value;
+    }
+    REQUIRE(memcached_async_pending(memc) == NUM_KEYS);
+
+    while (memcached_async_pending(memc)) {
+      REQUIRE_SUCCESS(memcached_async_poll(memc, 1000));
+    }
+    REQUIRE(results.succeeded == NUM_KEYS);
+    REQUIRE(results.failed == 0);
+
+    SECTION("get") {
+      async_results fetched;
+      uint64_t cancelled;
+
+      for (auto i = 0; i < NUM_KEYS + 10; ++i) {
+        auto key = "async" + to_string(i);
+        REQUIRE_SUCCESS(memcached_async_get(memc, key.c_str(), key.length(), async_cb, &fetched,
+                                            i ? nullptr : &cancelled));
+      }
+      REQUIRE_SUCCESS(memcached_async_cancel(memc, cancelled));
+
+      // drive it like an external event loop would
+      while (memcached_async_pending(memc)) {
+        vector<memcached_async_fd_st> fds(memcached_async_fds(memc, nullptr, 0));
+        REQUIRE(fds.size());
+        REQUIRE(fds.size() == memcached_async_fds(memc, fds.data(), fds.size()));
+
+        vector<pollfd> pfds;
+        for (auto &fd : fds) {
+          pfds.push_back(pollfd{fd.fd, fd.events, 0});
+        }
+        REQUIRE(0 < poll(pfds.data(), pfds.size(), 1000));
+        for (auto &pfd : pfds) {
+          if (pfd.revents) {
+            REQUIRE_SUCCESS(memcached_async_process(memc, pfd.fd, pfd.revents));
+          }
+        }
+      }
+
+      REQUIRE_RC(MEMCACHED_NOTFOUND, memcached_async_cancel(memc, cancelled));
+      REQUIRE(fetched.failed == 0);
+      REQUIRE(fetched.not_found == 10);
+      REQUIRE(fetched.succeeded == NUM_KEYS - 1);
+      for (auto &kv : fetched.values) {
+        REQUIRE(kv.second == results.values[kv.first]);
+      }
+    }
+
+    SECTION("delete") {
+      async_results deleted;
+
+      for (auto i = 0; i < NUM_KEYS; ++i) {
+        auto key = "async" + to_string(i);
+        REQUIRE_SUCCESS(memcached_async_delete(memc, key.c_str(), key.length(), async_cb,
+                                               &deleted, nullptr));
+      }
+      while (memcached_async_pending(memc)) {
+        REQUIRE_SUCCESS(memcached_async_poll(memc, 1000));
+      }
+      REQUIRE(deleted.succeeded == NUM_KEYS);
+
+      memcached_return_t rc;
+      REQUIRE_FALSE(memcached_get(memc, S("async0"), nullptr, nullptr, &rc));
+      REQUIRE_RC(MEMCACHED_NOTFOUND, rc);
+    }
+  }
+}
@@ -2,6 +2,8 @@
 #include "test/lib/MemcachedCluster.hpp"
 #include "test/fixtures/callbacks.hpp"
 
+#include "libmemcached/instance.hpp"
+
 TEST_CASE("memcached_behavior") {
   auto test = MemcachedCluster::network();
   auto memc = &test.memc;
@@ -34,4 +36,166 @@ TEST_CASE("memcached_behavior") {
     REQUIRE(counter == NUM_KEYS);
     REQUIRE(q_id == memcached_query_id(memc));
   }
+  SECTION("IO_URING") {
+    auto binary = GENERATE(0, 1);
+    constexpr int NUM_KEYS = 512;
+
+    auto rc = memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_URING, 1);
+    if (!memcached_success(rc)) {
+      WARN("io_uring not available: " << memcached_last_error_message(memc));
+      REQUIRE_FALSE(memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_URING));
+      return;
+    }
+    REQUIRE(memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_URING));
+    test.enableBinaryProto(binary);
+
+    array<string, NUM_KEYS> str;
+    array<char *, NUM_KEYS> chr;
+    array<size_t, NUM_KEYS> len;
+
+    for (auto i = 0; i < NUM_KEYS; ++i) {
+      str[i] = "io_uring:" + to_string(i);
+      chr[i] = str[i].data();
+      len[i] = str[i].length();
+      REQUIRE_SUCCESS(memcached_set(memc, chr[i], len[i], chr[i], len[i], 0, 0));
+    }
+
+    size_t counter = 0;
+    memcached_execute_fn cb[] = {&callback_counter};
+    REQUIRE_SUCCESS(memcached_mget(memc, chr.data(), len.data(), NUM_KEYS));
+    REQUIRE_SUCCESS(memcached_fetch_execute(memc, cb, &counter, 1));
+    REQUIRE(counter == NUM_KEYS);
+
+    REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_URING, 0));
+    REQUIRE_FALSE(memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_URING));
+  }
+  SECTION("IO_SENDMSG_THRESHOLD") {
+    auto binary = GENERATE(0, 1);
+    auto threshold = GENERATE(as<uint64_t>{}, 0, 1024, MEMCACHED_DEFAULT_IO_SENDMSG_THRESHOLD);
+
+    test.enableBinaryProto(binary);
+    REQUIRE(uint64_t(MEMCACHED_DEFAULT_IO_SENDMSG_THRESHOLD) == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_SENDMSG_THRESHOLD));
+    REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_SENDMSG_THRESHOLD, threshold));
+    REQUIRE(threshold == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_SENDMSG_THRESHOLD));
+
+    SECTION("IO_ZEROCOPY_THRESHOLD") {
+      auto rc = memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_ZEROCOPY_THRESHOLD, 64 * 1024);
+      if (rc == MEMCACHED_NOT_SUPPORTED) {
+        WARN("MSG_ZEROCOPY not available");
+      } else {
+        REQUIRE_SUCCESS(rc);
+        REQUIRE(uint64_t(64 * 1024) == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_ZEROCOPY_THRESHOLD));
+      }
+    }
+
+    string value(512 * 1024, 'v');
+    for (auto i = 0u; i < value.size(); i += 7) {
+      value[i] = char('a' + i % 26);
+    }
+
+    REQUIRE_SUCCESS(memcached_set(memc, S("sendmsg"), value.data(), value.size(), 0, 0));
+    REQUIRE_SUCCESS(memcached_set(memc, S("small"), S("value"), 0, 0));
+
+    size_t len;
+    uint32_t flags;
+    memcached_return_t rc;
+    Malloced got(memcached_get(memc, S("sendmsg"), &len, &flags, &rc));
+    REQUIRE_SUCCESS(rc);
+    REQUIRE(len == value.size());
+    REQUIRE(string(*got, len) == value);
+
+    Malloced small(memcached_get(memc, S("small"), &len, &flags, &rc));
+    REQUIRE_SUCCESS(rc);
+    REQUIRE(string(*small, len) == "value");
+  }
+  SECTION("IO_BUFFER_MIN/MAX") {
+    auto binary = GENERATE(0, 1);
+    auto sizes = GENERATE(as<pair<uint64_t, uint64_t>>{}, make_pair(256, 256),
+                          make_pair(256, 1024 * 1024), make_pair(64 * 1024, 64 * 1024));
+    constexpr int NUM_KEYS = 256;
+
+    test.enableBinaryProto(binary);
+    REQUIRE(uint64_t(MEMCACHED_DEFAULT_IO_BUFFER_MIN) == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MIN));
+    REQUIRE(uint64_t(MEMCACHED_DEFAULT_IO_BUFFER_MAX) == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MAX));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MIN, 0));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MIN, MEMCACHED_DEFAULT_IO_BUFFER_MAX + 1));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MAX, MEMCACHED_DEFAULT_IO_BUFFER_MIN - 1));
+
+    memcached_quit(memc);
+    if (sizes.first < MEMCACHED_DEFAULT_IO_BUFFER_MIN) {
+      REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MIN, sizes.first));
+      REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MAX, sizes.second));
+    } else {
+      REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MAX, sizes.second));
+      REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MIN, sizes.first));
+    }
+    REQUIRE(sizes.first == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MIN));
+    REQUIRE(sizes.second == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_BUFFER_MAX));
+
+    array<string, NUM_KEYS> str;
+    array<char *, NUM_KEYS> chr;
+    array<size_t, NUM_KEYS> len;
+
+    for (auto i = 0; i < NUM_KEYS; ++i) {
+      str[i] = "io_buffer:" + to_string(i);
+      chr[i] = str[i].data();
+      len[i] = str[i].length();
+      string value(i % 16 ? i * 17 : 100 * 1024 + i, char('a' + i % 26));
+      REQUIRE_SUCCESS(memcached_set(memc, chr[i], len[i], value.data(), value.size(), 0, 0));
+    }
+
+    for (auto round = 0; round < 3; ++round) {
+      REQUIRE_SUCCESS(memcached_mget(memc, chr.data(), len.data(), NUM_KEYS));
+
+      size_t counter = 0;
+      memcached_result_st *result;
+      memcached_return_t rc;
+      while ((result = memcached_fetch_result(memc, nullptr, &rc))) {
+        REQUIRE_SUCCESS(rc);
+        auto i = stoi(string(memcached_result_key_value(result) + 10,
+                             memcached_result_key_length(result) - 10));
+        REQUIRE(memcached_result_length(result) == size_t(i % 16 ? i * 17 : 100 * 1024 + i));
+        REQUIRE(memcached_result_value(result)[0] == char('a' + i % 26));
+        memcached_result_free(result);
+        ++counter;
+      }
+      REQUIRE_RC(MEMCACHED_END, rc);
+      REQUIRE(counter == NUM_KEYS);
+    }
+  }
+  SECTION("DNS_TTL") {
+    REQUIRE(0 == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_DNS_TTL));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS,
+               memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_DNS_TTL, uint64_t(INT32_MAX) + 1));
+
+    auto addrinfo_of = [](memcached_st *ptr) {
+      REQUIRE(MEMCACHED_SUCCESS == memcached_set(ptr, S("dns_ttl"), S("dns_ttl"), 0, 0));
+      auto instance = memcached_server_instance_by_position(ptr, 0);
+      REQUIRE(instance->address_info);
+      return instance->address_info;
+    };
+
+    SECTION("disabled") {
+      MemcachedPtr clone1{memcached_clone(nullptr, memc)}, clone2{memcached_clone(nullptr, memc)};
+
+      REQUIRE(addrinfo_of(*clone1) != addrinfo_of(*clone2));
+    }
+    SECTION("enabled") {
+      REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_DNS_TTL, 60));
+      REQUIRE(60 == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_DNS_TTL));
+
+      MemcachedPtr clone1{memcached_clone(nullptr, memc)};
+      REQUIRE(60 == memcached_behavior_get(*clone1, MEMCACHED_BEHAVIOR_DNS_TTL));
+      auto shared = addrinfo_of(*clone1);
+      REQUIRE(memcached_server_instance_by_position(*clone1, 0)->resolved);
+
+      // clones and reconnects reuse the cached result instead of resolving again
+      for (auto i = 0; i < 4; ++i) {
+        MemcachedPtr clone2{memcached_clone(nullptr, memc)};
+        REQUIRE(shared == addrinfo_of(*clone2));
+        memcached_quit(*clone2);
+        REQUIRE(shared == addrinfo_of(*clone2));
+      }
+    }
+  }
 }
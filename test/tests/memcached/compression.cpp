@@ -0,0 +1,193 @@
+#include "test/lib/common.hpp"
+#include "test/lib/MemcachedCluster.hpp"
+
+#define COMPRESSION_FLAG (1 << 12)
+
+static string json_value(size_t length) {
+  string json{"["};
+  while (json.length() < length) {
+    json += R"({"id": )" + to_string(json.length()) + R"(, "name": "some name", "tags": ["a", "b"]},)";
+  }
+  json.resize(length);
+  return json;
+}
+
+struct async_item {
+  memcached_return_t rc;
+  string value;
+  uint32_t flags;
+};
+
+static void async_cb(const memcached_st *, memcached_return_t rc,
+                     const memcached_item_view_st *item, void *ctx) {
+  auto fetched = static_cast<vector<async_item> *>(ctx);
+  if (item) {
+    fetched->push_back({rc, string{item->value, item->value_length}, item->flags});
+  } else {
+    fetched->push_back({rc, string{}, 0});
+  }
+}
+
+TEST_CASE("memcached_compression") {
+  auto test = MemcachedCluster::network();
+  auto memc = &test.memc;
+  auto binary = GENERATE(0, 1);
+  MemcachedPtr raw(memcached_clone(nullptr, memc));
+
+  test.enableBinaryProto(binary);
+  INFO("binary: " << binary);
+
+  auto algorithm = static_cast<memcached_compression_t>(
+      GENERATE(range(int(MEMCACHED_COMPRESSION_LZ4), int(MEMCACHED_COMPRESSION_MAX))));
+  INFO("compression: " << libmemcached_string_compression(algorithm));
+
+  if (!libmemcached_has_compression(algorithm)) {
+    WARN("compression not enabled: " << libmemcached_string_compression(algorithm));
+    REQUIRE_RC(MEMCACHED_NOT_SUPPORTED,
+               memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION, algorithm));
+    return;
+  }
+
+  REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION, algorithm));
+  REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION_FLAG, COMPRESSION_FLAG));
+  REQUIRE(COMPRESSION_FLAG == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_COMPRESSION_FLAG));
+
+  SECTION("compresses values above the threshold") {
+    for (auto length : {100, 2000, 20000, 200000}) {
+      auto key = "key" + to_string(length);
+      auto value = json_value(length);
+      INFO("length: " << length);
+
+      REQUIRE_SUCCESS(memcached_set(memc, key.c_str(), key.length(), value.c_str(), value.length(), 0, 1));
+
+      uint32_t flags;
+      size_t stored_length;
+      memcached_return_t rc;
+      Malloced stored(memcached_get(memc, key.c_str(), key.length(), &stored_length, &flags, &rc));
+      REQUIRE_SUCCESS(rc);
+      REQUIRE(flags == 1);
+      REQUIRE(value == string(*stored, stored_length));
+
+      Malloced compressed(memcached_get(*raw, key.c_str(), key.length(), &stored_length, &flags, &rc));
+      REQUIRE_SUCCESS(rc);
+      if (length < MEMCACHED_DEFAULT_COMPRESSION_THRESHOLD) {
+        REQUIRE(flags == 1);
+        REQUIRE(stored_length == value.length());
+      } else {
+        REQUIRE(flags == (1 | COMPRESSION_FLAG));
+        REQUIRE(stored_length < value.length() / 2);
+      }
+    }
+
+    memcached_compression_stat_st stat;
+    REQUIRE_SUCCESS(memcached_compression_stat(memc, &stat));
+    REQUIRE(stat.compressed == 3);
+    REQUIRE(stat.compressed_bytes == 222000);
+    REQUIRE(stat.compressed_size < stat.compressed_bytes / 2);
+    REQUIRE(stat.decompressed == 3);
+    REQUIRE(stat.decompressed_bytes == 222000);
+    REQUIRE(stat.failed == 0);
+  }
+
+  SECTION("stores values not reaching the ratio uncompressed") {
+    auto value = random_ascii_string(5000);
+    REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION_RATIO, 10));
+    REQUIRE_SUCCESS(memcached_set(memc, S(__func__), value.c_str(), value.length(), 0, 0));
+
+    uint32_t flags;
+    size_t stored_length;
+    memcached_return_t rc;
+    Malloced stored(memcached_get(*raw, S(__func__), &stored_length, &flags, &rc));
+    REQUIRE_SUCCESS(rc);
+    REQUIRE(flags == 0);
+    REQUIRE(value == string(*stored, stored_length));
+
+    memcached_compression_stat_st stat;
+    REQUIRE_SUCCESS(memcached_compression_stat(memc, &stat));
+    REQUIRE(stat.compressed == 0);
+    REQUIRE(stat.not_compressed == 1);
+  }
+
+  SECTION("compresses encrypted values") {
+    if (binary) {
+      SUCCEED("values are not decrypted with the binary protocol");
+      return;
+    }
+
+    auto value = json_value(20000);
+    REQUIRE_SUCCESS(memcached_set_encoding_key(memc, S(__func__)));
+    REQUIRE_SUCCESS(memcached_set(memc, S(__func__), value.c_str(), value.length(), 0, 0));
+
+    uint32_t flags;
+    size_t stored_length;
+    memcached_return_t rc;
+    Malloced stored(memcached_get(memc, S(__func__), &stored_length, &flags, &rc));
+    REQUIRE_SUCCESS(rc);
+    REQUIRE(flags == 0);
+    REQUIRE(value == string(*stored, stored_length));
+  }
+
+  SECTION("decompresses values of asynchronous gets") {
+    if (!binary) {
+      SUCCEED("the asynchronous API needs the binary protocol");
+      return;
+    }
+
+    auto value = json_value(20000);
+    string corrupt{char(algorithm), '\xff', '\xff', '\xff', '\xff'};
+    REQUIRE_SUCCESS(memcached_set(memc, S("small"), S("small value"), 0, 1));
+    REQUIRE_SUCCESS(memcached_set(memc, S("large"), value.c_str(), value.length(), 0, 1));
+    REQUIRE_SUCCESS(memcached_set(*raw, S("corrupt"), corrupt.c_str(), corrupt.length(), 0, COMPRESSION_FLAG));
+
+    vector<async_item> fetched;
+    for (auto key : {"small", "large", "corrupt"}) {
+      REQUIRE_SUCCESS(memcached_async_get(memc, key, strlen(key), async_cb, &fetched, nullptr));
+      while (memcached_async_pending(memc)) {
+        REQUIRE_SUCCESS(memcached_async_poll(memc, 1000));
+      }
+    }
+
+    REQUIRE(fetched.size() == 3);
+    REQUIRE_SUCCESS(fetched[0].rc);
+    REQUIRE(fetched[0].value == "small value");
+    REQUIRE(fetched[0].flags == 1);
+    REQUIRE_SUCCESS(fetched[1].rc);
+    REQUIRE(fetched[1].value == value);
+    REQUIRE(fetched[1].flags == 1);
+    REQUIRE(memcached_failed(fetched[2].rc));
+  }
+
+  SECTION("rejects corrupt lengths") {
+    // header claiming a 4GB value
+    string value{char(algorithm), '\xff', '\xff', '\xff', '\xff'};
+    value += "not compressed at all";
+    REQUIRE_SUCCESS(memcached_set(*raw, S(__func__), value.c_str(), value.length(), 0, COMPRESSION_FLAG));
+
+    size_t stored_length;
+    uint32_t flags;
+    memcached_return_t rc;
+    Malloced stored(memcached_get(memc, S(__func__), &stored_length, &flags, &rc));
+    REQUIRE(memcached_failed(rc));
+    REQUIRE_FALSE(*stored);
+
+    memcached_compression_stat_st stat;
+    REQUIRE_SUCCESS(memcached_compression_stat(memc, &stat));
+    REQUIRE(stat.failed == 1);
+    REQUIRE(stat.decompressed == 0);
+  }
+
+  SECTION("validates behaviors") {
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION_FLAG, 3));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION, MEMCACHED_COMPRESSION_MAX));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION_RATIO, 0));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION_RATIO, 101));
+
+    REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION_LEVEL, uint64_t(-3)));
+    REQUIRE(int64_t(-3) == int64_t(memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_COMPRESSION_LEVEL)));
+
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG, COMPRESSION_FLAG));
+    REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION_FLAG, 0));
+    REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG, COMPRESSION_FLAG));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_COMPRESSION_FLAG, COMPRESSION_FLAG));
+  }
+}
@@ -0,0 +1,95 @@
+#include "test/lib/common.hpp"
+#include "test/lib/MemcachedCluster.hpp"
+
+#if __cpp_impl_coroutine
+#  include "libmemcached-1.0/coroutine.hpp"
+
+using memcache::AsyncMemcache;
+
+struct detached_task {
+  struct promise_type {
+    detached_task get_return_object() { return {}; }
+    suspend_never initial_suspend() noexcept { return {}; }
+    suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { terminate(); }
+  };
+};
+
+static detached_task store(AsyncMemcache &client, string key, string value, size_t &stored) {
+  if (MEMCACHED_SUCCESS == co_await client.set(key, value)) {
+    ++stored;
+  }
+}
+
+static detached_task fetch(AsyncMemcache &client, vector<string> keys,
+                           vector<AsyncMemcache::Item> &items, bool &done) {
+  items = co_await client.mget(keys);
+  done = true;
+}
+
+static detached_task store_and_fetch(AsyncMemcache &client, string key, string &value) {
+  co_await client.set(key, key);
+  auto item = co_await client.get(key);
+  value.assign(item.value.begin(), item.value.end());
+  co_await client.remove(key);
+}
+
+TEST_CASE("memcached_coroutine") {
+  auto test = MemcachedCluster::network();
+  test.enableBinaryProto(true);
+  AsyncMemcache client{&test.memc};
+
+  constexpr auto NUM_KEYS = 200;
+  vector<string> keys;
+  map<string, string> values;
+  size_t stored = 0;
+
+  for (auto i = 0; i < NUM_KEYS; ++i) {
+    keys.emplace_back("coroutine" + to_string(i));
+    values[keys.back()] = random_ascii_string(i % 50 ? 32 : 2 * MEMCACHED_MAX_BUFFER);
+    store(client, keys.back(), values[keys.back()], stored);
+  }
+  REQUIRE(client.pending() == NUM_KEYS);
+  while (client.pending()) {
+    REQUIRE_SUCCESS(client.poll(1000));
+  }
+  REQUIRE(stored == NUM_KEYS);
+
+  SECTION("mget") {
+    vector<AsyncMemcache::Item> items;
+    bool done = false;
+
+    keys.emplace_back("coroutine-missing");
+    fetch(client, keys, items, done);
+    while (client.pending()) {
+      REQUIRE_SUCCESS(client.poll(1000));
+    }
+
+    REQUIRE(done);
+    REQUIRE(items.size() == keys.size());
+    for (auto i = 0; i < NUM_KEYS; ++i) {
+      REQUIRE_SUCCESS(items[i].rc);
+      REQUIRE(values[keys[i]] == string(items[i].value.begin(), items[i].value.end()));
+    }
+    REQUIRE_RC(MEMCACHED_NOTFOUND, items.back().rc);
+  }
+
+  SECTION("executor") {
+    vector<coroutine_handle<>> runnable;
+    string value;
+
+    client.setExecutor([&runnable](coroutine_handle<> handle) { runnable.push_back(handle); });
+    store_and_fetch(client, "coroutine-executor", value);
+
+    while (client.pending()) {
+      REQUIRE(client.fds().size());
+      REQUIRE_SUCCESS(client.poll(1000));
+      for (auto handle : exchange(runnable, {})) {
+        handle.resume();
+      }
+    }
+    REQUIRE(value == "coroutine-executor");
+  }
+}
+#endif
@@ -0,0 +1,315 @@
+#include "test/lib/common.hpp"
+#include "test/fixtures/hashes.hpp"
+
+#include "libmemcached/instance.hpp"
+
+#include <array>
+#include <ctime>
+
+static constexpr const uint32_t jump_md5_hosts[] = {2U, 0U, 1U, 0U, 1U, 4U, 2U, 2U, 2U, 2U, 2U, 0U, 4U, 3U, 4U, 0U, 0U, 1U, 2U, 2U, 0U, 4U, 0U, 0U, 3U, 4U};
+static constexpr const uint32_t jump_crc_hosts[] = {0U, 1U, 4U, 1U, 4U, 1U, 3U, 0U, 4U, 0U, 1U, 0U, 3U, 2U, 1U, 2U, 4U, 0U, 3U, 4U, 1U, 1U, 2U, 0U, 4U, 4U};
+static constexpr const uint32_t *jump_hosts[] = {nullptr, jump_md5_hosts, jump_crc_hosts};
+
+static vector<uint32_t> distribute(memcached_st *memc, size_t num_keys) {
+  vector<uint32_t> servers;
+
+  servers.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    auto key = "distribution:" + to_string(i);
+    servers.push_back(memcached_generate_hash(memc, key.data(), key.length()));
+  }
+
+  return servers;
+}
+
+static void add_servers(memcached_st *memc, uint32_t from, uint32_t to) {
+  for (auto i = from; i < to; ++i) {
+    auto host = "10.0.1." + to_string(i + 1);
+    REQUIRE(MEMCACHED_SUCCESS == memcached_server_add(memc, host.c_str(), 11211));
+  }
+}
+
+TEST_CASE("memcached_distribution_jump") {
+  MemcachedPtr memc;
+
+  REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, MEMCACHED_DISTRIBUTION_JUMP));
+  REQUIRE(MEMCACHED_DISTRIBUTION_JUMP == memcached_behavior_get_distribution(*memc));
+  REQUIRE(uint64_t(MEMCACHED_DISTRIBUTION_JUMP) == memcached_behavior_get(*memc, MEMCACHED_BEHAVIOR_DISTRIBUTION));
+  REQUIRE_FALSE(memcached_behavior_get(*memc, MEMCACHED_BEHAVIOR_KETAMA));
+  REQUIRE("MEMCACHED_DISTRIBUTION_JUMP"s == libmemcached_string_distribution(MEMCACHED_DISTRIBUTION_JUMP));
+
+  SECTION("generate hash") {
+    auto hash = GENERATE(as<memcached_hash_t>{}, MEMCACHED_HASH_MD5, MEMCACHED_HASH_CRC);
+
+    INFO("hash: " << libmemcached_string_hash(hash));
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_key_hash(*memc, hash));
+    add_servers(*memc, 0, 5);
+
+    auto n = 0;
+    for (auto i : input) {
+      CHECK(jump_hosts[hash][n] == memcached_generate_hash(*memc, S(i)));
+      ++n;
+    }
+  }
+
+  SECTION("balance") {
+    constexpr size_t NUM_KEYS = 100000;
+    constexpr uint32_t NUM_SERVERS = 10;
+
+    add_servers(*memc, 0, NUM_SERVERS);
+
+    array<size_t, NUM_SERVERS> load{};
+    for (auto server : distribute(*memc, NUM_KEYS)) {
+      REQUIRE(server < NUM_SERVERS);
+      ++load[server];
+    }
+    for (auto keys : load) {
+      REQUIRE(keys > NUM_KEYS / NUM_SERVERS * 9 / 10);
+      REQUIRE(keys < NUM_KEYS / NUM_SERVERS * 11 / 10);
+    }
+  }
+
+  SECTION("consistency") {
+    constexpr size_t NUM_KEYS = 20000;
+
+    add_servers(*memc, 0, 8);
+    auto before = distribute(*memc, NUM_KEYS);
+
+    add_servers(*memc, 8, 9);
+    auto after = distribute(*memc, NUM_KEYS);
+
+    size_t moved = 0;
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+      if (before[i] != after[i]) {
+        // keys only ever move to the new server
+        REQUIRE(after[i] == 8);
+        ++moved;
+      }
+    }
+    // about 1/9th of the keys
+    REQUIRE(moved > NUM_KEYS / 9 * 8 / 10);
+    REQUIRE(moved < NUM_KEYS / 9 * 12 / 10);
+  }
+}
+
+static void add_weighted_servers(memcached_st *memc, uint32_t from, uint32_t to, uint32_t weight) {
+  for (auto i = from; i < to; ++i) {
+    auto host = "10.0.1." + to_string(i + 1);
+    REQUIRE(MEMCACHED_SUCCESS == memcached_server_add_with_weight(memc, host.c_str(), 11211, weight));
+  }
+}
+
+TEST_CASE("memcached_distribution_rendezvous") {
+  auto distribution = GENERATE(as<memcached_server_distribution_t>{},
+                               MEMCACHED_DISTRIBUTION_RENDEZVOUS,
+                               MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON);
+  MemcachedPtr memc;
+
+  INFO("distribution: " << libmemcached_string_distribution(distribution));
+  REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, distribution));
+  REQUIRE(distribution == memcached_behavior_get_distribution(*memc));
+  REQUIRE_FALSE(memcached_behavior_get(*memc, MEMCACHED_BEHAVIOR_KETAMA));
+
+  SECTION("balance") {
+    constexpr size_t NUM_KEYS = 100000;
+    constexpr uint32_t NUM_SERVERS = 40;
+
+    add_servers(*memc, 0, NUM_SERVERS);
+
+    array<size_t, NUM_SERVERS> load{};
+    for (auto server : distribute(*memc, NUM_KEYS)) {
+      REQUIRE(server < NUM_SERVERS);
+      ++load[server];
+    }
+    for (auto keys : load) {
+      REQUIRE(keys > NUM_KEYS / NUM_SERVERS * 8 / 10);
+      REQUIRE(keys < NUM_KEYS / NUM_SERVERS * 12 / 10);
+    }
+  }
+
+  SECTION("weights") {
+    constexpr size_t NUM_KEYS = 100000;
+
+    add_weighted_servers(*memc, 0, 4, 1);
+    add_weighted_servers(*memc, 4, 8, 3);
+
+    array<size_t, 8> load{};
+    for (auto server : distribute(*memc, NUM_KEYS)) {
+      ++load[server];
+    }
+    for (uint32_t s = 0; s < 8; ++s) {
+      auto expected = NUM_KEYS * (s < 4 ? 1 : 3) / 16;
+      REQUIRE(load[s] > expected * 9 / 10);
+      REQUIRE(load[s] < expected * 11 / 10);
+    }
+  }
+
+  SECTION("consistency") {
+    constexpr size_t NUM_KEYS = 20000;
+
+    add_servers(*memc, 0, 20);
+    auto before = distribute(*memc, NUM_KEYS);
+
+    add_servers(*memc, 20, 21);
+    auto after = distribute(*memc, NUM_KEYS);
+
+    size_t moved = 0;
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+      if (before[i] != after[i]) {
+        if (distribution == MEMCACHED_DISTRIBUTION_RENDEZVOUS) {
+          // keys only ever move to the new server
+          REQUIRE(after[i] == 20);
+        }
+        ++moved;
+      }
+    }
+    REQUIRE(moved > 0);
+    REQUIRE(moved < NUM_KEYS / 21 * 2);
+  }
+
+  SECTION("removal") {
+    constexpr size_t NUM_KEYS = 20000;
+    constexpr uint32_t NUM_SERVERS = 40, REMOVED = 7;
+    MemcachedPtr without;
+
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*without, distribution));
+    add_servers(*memc, 0, NUM_SERVERS);
+    add_servers(*without, 0, REMOVED);
+    add_servers(*without, REMOVED + 1, NUM_SERVERS);
+
+    auto before = distribute(*memc, NUM_KEYS);
+    auto after = distribute(*without, NUM_KEYS);
+
+    size_t moved = 0;
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+      // the servers following the removed one moved up in the list
+      auto server = after[i] < REMOVED ? after[i] : after[i] + 1;
+      if (before[i] != REMOVED && before[i] != server) {
+        ++moved;
+      }
+    }
+    if (distribution == MEMCACHED_DISTRIBUTION_RENDEZVOUS) {
+      REQUIRE(moved == 0);
+    } else {
+      // its cluster lost weight, too
+      REQUIRE(moved < NUM_KEYS / NUM_SERVERS);
+    }
+  }
+
+  SECTION("auto eject") {
+    constexpr size_t NUM_KEYS = 20000;
+    constexpr uint32_t NUM_SERVERS = 40;
+
+    add_servers(*memc, 0, NUM_SERVERS);
+    auto before = distribute(*memc, NUM_KEYS);
+
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set(*memc, MEMCACHED_BEHAVIOR_AUTO_EJECT_HOSTS, 1));
+    auto instance = const_cast<memcached_instance_st *>(memcached_server_instance_by_position(*memc, 3));
+    instance->next_retry = time(nullptr) + 60;
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, distribution));
+    auto after = distribute(*memc, NUM_KEYS);
+
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+      // only the keys of the ejected server move
+      REQUIRE(after[i] != 3);
+      if (before[i] != 3) {
+        REQUIRE(before[i] == after[i]);
+      }
+    }
+  }
+
+  SECTION("replicas") {
+    add_servers(*memc, 0, 20);
+
+    for (auto i : input) {
+      array<uint32_t, 4> server_keys{};
+
+      REQUIRE(4 == memcached_generate_hash_replicas(*memc, S(i), server_keys.data(), 4));
+      REQUIRE(server_keys[0] == memcached_generate_hash(*memc, S(i)));
+      for (auto s = 0; s < 4; ++s) {
+        REQUIRE(server_keys[s] < 20);
+        for (auto t = 0; t < s; ++t) {
+          REQUIRE(server_keys[s] != server_keys[t]);
+        }
+      }
+    }
+
+    array<uint32_t, 32> server_keys{};
+    REQUIRE(20 == memcached_generate_hash_replicas(*memc, S("key"), server_keys.data(), 32));
+  }
+}
+
+TEST_CASE("memcached_generate_hash_replicas") {
+  MemcachedPtr memc;
+  array<uint32_t, 4> server_keys{};
+
+  REQUIRE(0 == memcached_generate_hash_replicas(*memc, S("key"), server_keys.data(), 4));
+
+  add_servers(*memc, 0, 3);
+  REQUIRE(3 == memcached_generate_hash_replicas(*memc, S("key"), server_keys.data(), 4));
+  auto primary = memcached_generate_hash(*memc, S("key"));
+  for (auto s = 0U; s < 3; ++s) {
+    REQUIRE(server_keys[s] == (primary + s) % 3);
+  }
+}
+
+TEST_CASE("memcached_distribution_maglev") {
+  constexpr size_t NUM_KEYS = 20000;
+  constexpr uint32_t NUM_SERVERS = 20;
+  MemcachedPtr memc;
+
+  REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, MEMCACHED_DISTRIBUTION_MAGLEV));
+  REQUIRE(MEMCACHED_DISTRIBUTION_MAGLEV == memcached_behavior_get_distribution(*memc));
+  REQUIRE_FALSE(memcached_behavior_get(*memc, MEMCACHED_BEHAVIOR_KETAMA));
+  REQUIRE("MEMCACHED_DISTRIBUTION_MAGLEV"s == libmemcached_string_distribution(MEMCACHED_DISTRIBUTION_MAGLEV));
+
+  add_servers(*memc, 0, NUM_SERVERS);
+  auto before = distribute(*memc, NUM_KEYS);
+
+  SECTION("balance") {
+    array<size_t, NUM_SERVERS> load{};
+    for (auto server : before) {
+      REQUIRE(server < NUM_SERVERS);
+      ++load[server];
+    }
+    for (auto keys : load) {
+      REQUIRE(keys > NUM_KEYS / NUM_SERVERS * 8 / 10);
+      REQUIRE(keys < NUM_KEYS / NUM_SERVERS * 12 / 10);
+    }
+  }
+
+  SECTION("consistency") {
+    add_servers(*memc, NUM_SERVERS, NUM_SERVERS + 1);
+    auto after = distribute(*memc, NUM_KEYS);
+
+    size_t moved = 0, moved_elsewhere = 0;
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+      if (before[i] != after[i]) {
+        ++moved;
+        if (after[i] != NUM_SERVERS) {
+          ++moved_elsewhere;
+        }
+      }
+    }
+    REQUIRE(moved > 0);
+    REQUIRE(moved < NUM_KEYS / (NUM_SERVERS + 1) * 13 / 10);
+    REQUIRE(moved_elsewhere < moved / 10);
+  }
+
+  SECTION("auto eject") {
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set(*memc, MEMCACHED_BEHAVIOR_AUTO_EJECT_HOSTS, 1));
+    auto instance = const_cast<memcached_instance_st *>(memcached_server_instance_by_position(*memc, 3));
+    instance->next_retry = time(nullptr) + 60;
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, MEMCACHED_DISTRIBUTION_MAGLEV));
+    auto after = distribute(*memc, NUM_KEYS);
+
+    size_t moved = 0;
+    for (size_t i = 0; i < NUM_KEYS; ++i) {
+      REQUIRE(after[i] != 3);
+      if (before[i] != after[i] && before[i] != 3) {
+        ++moved;
+      }
+    }
+    REQUIRE(moved < NUM_KEYS / NUM_SERVERS / 10);
+  }
+}
@@ -75,6 +75,33 @@ TEST_CASE("memcached_encoding_key") {
         }
       }
 
+      SECTION("encrypts in CTR mode") {
+        REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG, 3));
+        REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG, 1 << 15));
+        REQUIRE(uint64_t(1 << 15) == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_ENCRYPTION_CTR_FLAG));
+
+        REQUIRE_SUCCESS(memcached_set(memc, TEST_KEY, INITIAL_VAL, 0, 1));
+
+        uint32_t flags;
+        memcached_return_t rc;
+        size_t length, initial_length = strlen("initial value, which is longer than AES_BLOCK_SIZE");
+        Malloced value(memcached_get(memc, TEST_KEY, &length, &flags, &rc));
+        REQUIRE_SUCCESS(rc);
+        REQUIRE(flags == 1);
+        check(memc, copy.memc, INITIAL_VAL);
+
+        Malloced raw_value(memcached_get(copy.memc, TEST_KEY, &length, &flags, &rc));
+        REQUIRE_SUCCESS(rc);
+        REQUIRE(flags == (1 | 1 << 15));
+        REQUIRE(length == 16 + initial_length);
+
+        SECTION("cloned gets encoded value") {
+          MemcachedPtr dupe(memcached_clone(nullptr, memc));
+
+          check(dupe.memc, copy.memc, INITIAL_VAL);
+        }
+      }
+
       SECTION("unsupported") {
         REQUIRE_RC(MEMCACHED_NOT_SUPPORTED, memcached_increment(memc, TEST_KEY, 0, nullptr));
         REQUIRE_RC(MEMCACHED_NOT_SUPPORTED, memcached_decrement(memc, TEST_KEY, 0, nullptr));
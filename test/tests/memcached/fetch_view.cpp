@@ -0,0 +1,84 @@
+#include "test/lib/common.hpp"
+#include "test/lib/MemcachedCluster.hpp"
+
+struct fetched_item {
+  string value;
+  uint32_t flags;
+  uint64_t cas;
+};
+
+static memcached_return_t view_cb(const memcached_st *, const memcached_item_view_st *item,
+                                  void *ctx) {
+  auto fetched = static_cast<map<string, fetched_item> *>(ctx);
+  fetched->emplace(string{item->key, item->key_length},
+                   fetched_item{string{item->value, item->value_length}, item->flags, item->cas});
+  return MEMCACHED_SUCCESS;
+}
+
+TEST_CASE("memcached_fetch_view") {
+  auto test = MemcachedCluster::network();
+  auto memc = &test.memc;
+  auto binary = GENERATE(0, 1);
+
+  test.enableBinaryProto(binary);
+  REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_SUPPORT_CAS, true));
+
+  INFO("binary: " << binary);
+
+  constexpr auto NUM_KEYS = 64;
+  vector<string> str;
+  vector<const char *> chr;
+  vector<size_t> len;
+  map<string, string> stored;
+
+  for (auto i = 0; i < NUM_KEYS; ++i) {
+    str.emplace_back(random_ascii_string(12) + to_string(i));
+  }
+  for (auto i = 0; i < NUM_KEYS; ++i) {
+    chr.push_back(str[i].c_str());
+    len.push_back(str[i].length());
+    if (i % 4) {
+      // every 8th value does not fit into the read buffer
+      auto value = random_ascii_string(i % 8 ? 100 + i : 3 * MEMCACHED_MAX_BUFFER + i);
+      REQUIRE_SUCCESS(memcached_set(memc, chr[i], len[i], value.c_str(), value.length(), 0, i));
+      stored[str[i]] = value;
+    }
+  }
+
+  SECTION("matches memcached_fetch_result") {
+    map<string, fetched_item> viewed;
+    REQUIRE_SUCCESS(memcached_mget(memc, chr.data(), len.data(), NUM_KEYS));
+    REQUIRE_SUCCESS(memcached_fetch_view(memc, view_cb, &viewed));
+    REQUIRE(viewed.size() == stored.size());
+
+    REQUIRE_SUCCESS(memcached_mget(memc, chr.data(), len.data(), NUM_KEYS));
+    memcached_return_t rc;
+    memcached_result_st result_buffer, *result = memcached_result_create(memc, &result_buffer);
+    size_t count = 0;
+    while (memcached_fetch_result(memc, result, &rc)) {
+      REQUIRE_SUCCESS(rc);
+      string key{memcached_result_key_value(result), memcached_result_key_length(result)};
+      auto found = viewed.find(key);
+      REQUIRE(found != viewed.end());
+      REQUIRE(found->second.value == stored[key]);
+      REQUIRE(found->second.value
+              == string(memcached_result_value(result), memcached_result_length(result)));
+      REQUIRE(found->second.flags == memcached_result_flags(result));
+      REQUIRE(found->second.cas == memcached_result_cas(result));
+      ++count;
+    }
+    memcached_result_free(result);
+    REQUIRE(count == stored.size());
+  }
+
+  SECTION("not found") {
+    map<string, fetched_item> viewed;
+    REQUIRE_SUCCESS(memcached_mget(memc, chr.data(), len.data(), 1));
+    REQUIRE_RC(MEMCACHED_NOTFOUND, memcached_fetch_view(memc, view_cb, &viewed));
+    REQUIRE(viewed.empty());
+  }
+
+  SECTION("invalid arguments") {
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS, memcached_fetch_view(memc, nullptr, nullptr));
+  }
+}
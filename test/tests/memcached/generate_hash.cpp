@@ -32,6 +32,42 @@ TEST_CASE("memcached_generate_hash") {
     }
   }
 
+  SECTION("generate hash batch") {
+    auto hash = GENERATE(as<memcached_hash_t>{}, MEMCACHED_HASH_DEFAULT, MEMCACHED_HASH_MD5, MEMCACHED_HASH_CRC, MEMCACHED_HASH_FNV1A_32, MEMCACHED_HASH_MURMUR3);
+    auto distribution = GENERATE(as<memcached_server_distribution_t>{}, MEMCACHED_DISTRIBUTION_MODULA, MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA);
+
+    INFO("hash: " << libmemcached_string_hash(hash));
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_key_hash(*memc, hash));
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, distribution));
+
+    vector<string> keys;
+    for (auto i = 0; i < 3; ++i) {
+      for (auto k : input) {
+        keys.emplace_back(string(k) + string(i, '_'));
+      }
+    }
+    vector<const char *> key_ptrs;
+    vector<size_t> key_lengths;
+    for (auto &k : keys) {
+      key_ptrs.push_back(k.data());
+      key_lengths.push_back(k.size());
+    }
+
+    auto check = [&]() {
+      vector<uint32_t> server_keys(keys.size());
+      REQUIRE(MEMCACHED_SUCCESS == memcached_generate_hash_batch(*memc, key_ptrs.data(), key_lengths.data(), keys.size(), server_keys.data()));
+      for (auto n = 0U; n < keys.size(); ++n) {
+        CHECK(memcached_generate_hash(*memc, keys[n].data(), keys[n].size()) == server_keys[n]);
+      }
+    };
+
+    check();
+
+    REQUIRE(MEMCACHED_SUCCESS == memcached_callback_set(*memc, MEMCACHED_CALLBACK_NAMESPACE, "ns:"));
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set(*memc, MEMCACHED_BEHAVIOR_HASH_WITH_PREFIX_KEY, 1));
+    check();
+  }
+
   SECTION("generate hash") {
     auto hash = GENERATE(as<memcached_hash_t>{}, MEMCACHED_HASH_MD5, MEMCACHED_HASH_CRC);
 
@@ -196,3 +196,90 @@ TEST_CASE("memcached_ketama_compat") {
     memcached_server_list_free(server_pool);
   }
 }
+
+TEST_CASE("memcached_ketama_search") {
+  auto distribution = GENERATE(as<memcached_server_distribution_t>{},
+                               MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA,
+                               MEMCACHED_DISTRIBUTION_CONSISTENT_WEIGHTED,
+                               MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA_SPY);
+  MemcachedPtr memc;
+
+  INFO("distribution: " << libmemcached_string_distribution(distribution));
+  REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, distribution));
+
+  memcached_server_st *server_pool = memcached_servers_parse(
+      "10.0.1.1:11211 600,10.0.1.2:11211 300,10.0.1.3:11211 200,10.0.1.4:11211 350,10.0.1.5:11211 1000,10.0.1.6:11211 800,10.0.1.7:11211 950,10.0.1.8:11211 100"
+  );
+  REQUIRE(MEMCACHED_SUCCESS == memcached_server_push(*memc, server_pool));
+  memcached_server_list_free(server_pool);
+
+  auto begin = memc->ketama.continuum, end = begin + memc->ketama.continuum_points_counter;
+  auto binary_search = [begin, end](uint32_t hash) {
+    auto point = lower_bound(begin, end, hash, [](const memcached_continuum_item_st &item, uint32_t value) {
+      return item.value < value;
+    });
+    return point == end ? begin->index : point->index;
+  };
+
+  /* the Eytzinger layout has to pick the same server as a binary search of the continuum */
+  for (auto point = begin; point < end; ++point) {
+    for (auto hash : {point->value - 1, point->value, point->value + 1}) {
+      REQUIRE(binary_search(hash) == memcached_continuum_search(memc->ketama.continuum_search, hash));
+    }
+  }
+  for (uint64_t hash = 0; hash <= UINT32_MAX; hash += 0x10001) {
+    REQUIRE(binary_search(uint32_t(hash)) == memcached_continuum_search(memc->ketama.continuum_search, uint32_t(hash)));
+  }
+}
+
+TEST_CASE("memcached_ketama_incremental") {
+  auto distribution = GENERATE(as<memcached_server_distribution_t>{},
+                               MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA,
+                               MEMCACHED_DISTRIBUTION_CONSISTENT_WEIGHTED,
+                               MEMCACHED_DISTRIBUTION_CONSISTENT_KETAMA_SPY);
+  const char *servers =
+      "10.0.1.1:11211 600,10.0.1.2:11211 300,10.0.1.3:11211 200,10.0.1.4:11211 350,10.0.1.5:11211 1000,10.0.1.6:11211 800,10.0.1.7:11211 950,10.0.1.8:11211 100";
+  MemcachedPtr memc, fresh;
+
+  INFO("distribution: " << libmemcached_string_distribution(distribution));
+  REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, distribution));
+  REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*fresh, distribution));
+
+  memcached_server_st *server_pool = memcached_servers_parse(servers);
+  REQUIRE(MEMCACHED_SUCCESS == memcached_server_push(*memc, server_pool));
+  memcached_server_list_free(server_pool);
+
+  /* the continuum built from the cached points has to match one built from scratch */
+  auto require_fresh_continuum = [&]() {
+    REQUIRE(memc->ketama.continuum_points_counter == fresh->ketama.continuum_points_counter);
+    for (uint32_t i = 0; i < memc->ketama.continuum_points_counter; ++i) {
+      REQUIRE(memc->ketama.continuum[i].value == fresh->ketama.continuum[i].value);
+      REQUIRE(memc->ketama.continuum[i].index == fresh->ketama.continuum[i].index);
+    }
+  };
+
+  SECTION("add server") {
+    REQUIRE(MEMCACHED_SUCCESS == memcached_server_add_with_weight(*memc, "10.0.1.9", 11212, 400));
+
+    server_pool = memcached_servers_parse(servers);
+    server_pool = memcached_server_list_append_with_weight(server_pool, "10.0.1.9", 11212, 400, nullptr);
+    REQUIRE(MEMCACHED_SUCCESS == memcached_server_push(*fresh, server_pool));
+    memcached_server_list_free(server_pool);
+
+    require_fresh_continuum();
+  }
+
+  SECTION("change hash") {
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set(*memc, MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_CRC));
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set(*fresh, MEMCACHED_BEHAVIOR_HASH, MEMCACHED_HASH_CRC));
+
+    server_pool = memcached_servers_parse(servers);
+    REQUIRE(MEMCACHED_SUCCESS == memcached_server_push(*fresh, server_pool));
+    memcached_server_list_free(server_pool);
+
+    /* rebuilds the continuum */
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*memc, distribution));
+    REQUIRE(MEMCACHED_SUCCESS == memcached_behavior_set_distribution(*fresh, distribution));
+    require_fresh_continuum();
+  }
+}
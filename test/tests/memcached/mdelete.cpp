@@ -0,0 +1,109 @@
+#include "test/lib/common.hpp"
+#include "test/lib/MemcachedCluster.hpp"
+
+constexpr static const size_t num_keys = 2000;
+
+TEST_CASE("memcached_mdelete") {
+  auto test{MemcachedCluster::mixed()};
+  auto memc = &test.memc;
+  auto binary = GENERATE(0, 1);
+
+  test.enableBinaryProto(binary);
+  INFO("binary: " << binary);
+
+  vector<string> keys;
+  vector<const char *> key_ptrs;
+  vector<size_t> key_lengths;
+  vector<memcached_return_t> results(num_keys);
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys.push_back("mdelete" + to_string(i));
+  }
+  for (auto &key : keys) {
+    key_ptrs.push_back(key.c_str());
+    key_lengths.push_back(key.length());
+  }
+  for (size_t i = 0; i < num_keys; i += 2) {
+    REQUIRE_SUCCESS(memcached_set(memc, key_ptrs[i], key_lengths[i], S("value"), 0, 0));
+  }
+
+  SECTION("touches") {
+    REQUIRE_RC(MEMCACHED_SOME_ERRORS, memcached_mtouch(memc, key_ptrs.data(), key_lengths.data(),
+                                                       num_keys, 60, results.data()));
+    for (size_t i = 0; i < num_keys; ++i) {
+      REQUIRE_RC(i % 2 ? MEMCACHED_NOTFOUND : MEMCACHED_SUCCESS, results[i]);
+    }
+
+    REQUIRE_SUCCESS(memcached_mtouch(memc, key_ptrs.data(), key_lengths.data(), 1,
+                                     time(nullptr) - 2, nullptr));
+    memcached_return_t rc;
+    Malloced val(memcached_get(memc, key_ptrs[0], key_lengths[0], nullptr, nullptr, &rc));
+    REQUIRE_RC(MEMCACHED_NOTFOUND, rc);
+  }
+
+  SECTION("deletes") {
+    REQUIRE_RC(MEMCACHED_SOME_ERRORS, memcached_mdelete(memc, key_ptrs.data(), key_lengths.data(),
+                                                        num_keys, results.data()));
+    for (size_t i = 0; i < num_keys; ++i) {
+      REQUIRE_RC(i % 2 ? MEMCACHED_NOTFOUND : MEMCACHED_SUCCESS, results[i]);
+    }
+
+    for (size_t i = 0; i < num_keys; i += 17) {
+      memcached_return_t rc;
+      Malloced val(memcached_get(memc, key_ptrs[i], key_lengths[i], nullptr, nullptr, &rc));
+      REQUIRE_RC(MEMCACHED_NOTFOUND, rc);
+    }
+  }
+
+  SECTION("deletes by group key") {
+    REQUIRE_SUCCESS(memcached_set_by_key(memc, S("group"), key_ptrs[1], key_lengths[1], S("value"), 0, 0));
+    REQUIRE_SUCCESS(memcached_mdelete_by_key(memc, S("group"), key_ptrs.data() + 1,
+                                             key_lengths.data() + 1, 1, nullptr));
+    REQUIRE_RC(MEMCACHED_NOTFOUND, memcached_touch_by_key(memc, S("group"), key_ptrs[1], key_lengths[1], 60));
+  }
+
+  SECTION("rejects invalid arguments") {
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS,
+               memcached_mdelete(memc, key_ptrs.data(), key_lengths.data(), 0, nullptr));
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS,
+               memcached_mtouch(memc, nullptr, key_lengths.data(), num_keys, 0, nullptr));
+  }
+}
+
+TEST_CASE("memcached_mdelete_replicas") {
+  auto test{MemcachedCluster::network()};
+  auto memc = &test.memc;
+
+  test.enableBinaryProto();
+  REQUIRE_SUCCESS(memcached_behavior_set_distribution(memc, MEMCACHED_DISTRIBUTION_RENDEZVOUS));
+  REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_NUMBER_OF_REPLICAS, 1));
+
+  vector<string> keys;
+  vector<const char *> key_ptrs;
+  vector<size_t> key_lengths;
+  vector<memcached_return_t> results(num_keys);
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys.push_back("mdelete" + to_string(i));
+  }
+  for (auto &key : keys) {
+    key_ptrs.push_back(key.c_str());
+    key_lengths.push_back(key.length());
+  }
+  for (size_t i = 0; i < num_keys; i += 2) {
+    REQUIRE_SUCCESS(memcached_set(memc, key_ptrs[i], key_lengths[i], S("value"), 0, 0));
+  }
+
+  // the replicas answer the quiet deletes of missing keys, which must all be read
+  REQUIRE_RC(MEMCACHED_SOME_ERRORS, memcached_mdelete(memc, key_ptrs.data(), key_lengths.data(),
+                                                      num_keys, results.data()));
+  for (size_t i = 0; i < num_keys; ++i) {
+    REQUIRE_RC(i % 2 ? MEMCACHED_NOTFOUND : MEMCACHED_SUCCESS, results[i]);
+  }
+
+  for (size_t i = 0; i < num_keys; i += 17) {
+    memcached_return_t rc;
+    Malloced val(memcached_get(memc, key_ptrs[i], key_lengths[i], nullptr, nullptr, &rc));
+    REQUIRE_RC(MEMCACHED_NOTFOUND, rc);
+  }
+}
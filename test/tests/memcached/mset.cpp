@@ -0,0 +1,143 @@
+#include "test/lib/common.hpp"
+#include "test/lib/MemcachedCluster.hpp"
+
+constexpr static const size_t num_keys = 2000;
+
+TEST_CASE("memcached_mset") {
+  auto test{MemcachedCluster::mixed()};
+  auto memc = &test.memc;
+  auto binary = GENERATE(0, 1);
+
+  test.enableBinaryProto(binary);
+  INFO("binary: " << binary);
+
+  vector<string> keys, values;
+  vector<const char *> key_ptrs, value_ptrs;
+  vector<size_t> key_lengths, value_lengths;
+  vector<uint32_t> flags;
+  vector<memcached_return_t> results(num_keys);
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys.push_back("mset" + to_string(i));
+    values.push_back(random_ascii_string(i % 100 ? 1 + i % 500 : 20000));
+  }
+  for (size_t i = 0; i < num_keys; ++i) {
+    key_ptrs.push_back(keys[i].c_str());
+    key_lengths.push_back(keys[i].length());
+    value_ptrs.push_back(values[i].c_str());
+    value_lengths.push_back(values[i].length());
+    flags.push_back(uint32_t(i));
+  }
+
+  REQUIRE_SUCCESS(memcached_mset(memc, key_ptrs.data(), key_lengths.data(), value_ptrs.data(),
+                                 value_lengths.data(), nullptr, flags.data(), num_keys,
+                                 results.data()));
+  for (auto rc : results) {
+    REQUIRE_SUCCESS(rc);
+  }
+
+  for (size_t i = 0; i < num_keys; i += 17) {
+    size_t len;
+    uint32_t flg;
+    memcached_return_t rc;
+    Malloced val(memcached_get(memc, key_ptrs[i], key_lengths[i], &len, &flg, &rc));
+
+    REQUIRE_SUCCESS(rc);
+    REQUIRE(flg == i);
+    REQUIRE(values[i] == string(*val, len));
+  }
+
+  SECTION("reports per key results") {
+    vector<string> mixed;
+    vector<const char *> mixed_ptrs;
+    vector<size_t> mixed_lengths;
+    for (size_t i = 0; i < num_keys; ++i) {
+      mixed.push_back(i % 2 ? keys[i] : "missing" + to_string(i));
+    }
+    for (auto &key : mixed) {
+      mixed_ptrs.push_back(key.c_str());
+      mixed_lengths.push_back(key.length());
+    }
+
+    REQUIRE_RC(MEMCACHED_SOME_ERRORS,
+               memcached_madd(memc, mixed_ptrs.data(), mixed_lengths.data(), value_ptrs.data(),
+                              value_lengths.data(), nullptr, nullptr, num_keys, results.data()));
+    for (size_t i = 0; i < num_keys; ++i) {
+      REQUIRE_RC(i % 2 ? MEMCACHED_NOTSTORED : MEMCACHED_SUCCESS, results[i]);
+    }
+
+    test.flush();
+
+    REQUIRE_SUCCESS(memcached_mset(memc, key_ptrs.data(), key_lengths.data(), value_ptrs.data(),
+                                   value_lengths.data(), nullptr, nullptr, num_keys / 2,
+                                   nullptr));
+    REQUIRE_RC(MEMCACHED_SOME_ERRORS,
+               memcached_mreplace(memc, mixed_ptrs.data(), mixed_lengths.data(),
+                                  value_ptrs.data(), value_lengths.data(), nullptr, nullptr,
+                                  num_keys, results.data()));
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (i % 2 and i < num_keys / 2) {
+        REQUIRE_SUCCESS(results[i]);
+      } else {
+        REQUIRE_RC(binary ? MEMCACHED_NOTFOUND : MEMCACHED_NOTSTORED, results[i]);
+      }
+    }
+  }
+
+  SECTION("compares and swaps") {
+    vector<uint64_t> cas(num_keys);
+
+    REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_SUPPORT_CAS, true));
+    REQUIRE_SUCCESS(memcached_mget(memc, key_ptrs.data(), key_lengths.data(), num_keys));
+
+    memcached_result_st *result;
+    memcached_return_t rc;
+    while ((result = memcached_fetch_result(memc, nullptr, &rc))) {
+      auto i = stoul(string(memcached_result_key_value(result), memcached_result_key_length(result)).substr(4));
+      cas[i] = memcached_result_cas(result) + (i % 3 ? 0 : 1);
+      memcached_result_free(result);
+    }
+
+    REQUIRE_RC(MEMCACHED_SOME_ERRORS,
+               memcached_mcas(memc, key_ptrs.data(), key_lengths.data(), value_ptrs.data(),
+                              value_lengths.data(), nullptr, nullptr, cas.data(), num_keys,
+                              results.data()));
+    for (size_t i = 0; i < num_keys; ++i) {
+      REQUIRE_RC(i % 3 ? MEMCACHED_SUCCESS : MEMCACHED_DATA_EXISTS, results[i]);
+    }
+  }
+
+  SECTION("stores by group key") {
+    REQUIRE_SUCCESS(memcached_mset_by_key(memc, S("group"), key_ptrs.data(), key_lengths.data(),
+                                          value_ptrs.data(), value_lengths.data(), nullptr,
+                                          nullptr, num_keys, results.data()));
+
+    size_t len;
+    uint32_t flg;
+    memcached_return_t rc;
+    Malloced val(memcached_get_by_key(memc, S("group"), key_ptrs[42], key_lengths[42], &len, &flg, &rc));
+    REQUIRE_SUCCESS(rc);
+    REQUIRE(values[42] == string(*val, len));
+  }
+
+  SECTION("rejects invalid keys") {
+    keys[7] = string(MEMCACHED_MAX_KEY, 'k');
+    key_ptrs[7] = keys[7].c_str();
+    key_lengths[7] = keys[7].length();
+
+    REQUIRE_RC(MEMCACHED_SOME_ERRORS,
+               memcached_mset(memc, key_ptrs.data(), key_lengths.data(), value_ptrs.data(),
+                              value_lengths.data(), nullptr, nullptr, num_keys, results.data()));
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (i == 7) {
+        REQUIRE(memcached_failed(results[i]));
+      } else {
+        REQUIRE_SUCCESS(results[i]);
+      }
+    }
+
+    REQUIRE_RC(MEMCACHED_INVALID_ARGUMENTS,
+               memcached_mset(memc, key_ptrs.data(), key_lengths.data(), value_ptrs.data(),
+                              value_lengths.data(), nullptr, nullptr, 0, nullptr));
+  }
+}
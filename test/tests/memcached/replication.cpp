@@ -112,3 +112,46 @@ TEST_CASE("memcached_replication") {
 #endif
   }
 }
+
+TEST_CASE("memcached_replication_rendezvous") {
+  auto distribution = GENERATE(as<memcached_server_distribution_t>{},
+                               MEMCACHED_DISTRIBUTION_RENDEZVOUS,
+                               MEMCACHED_DISTRIBUTION_RENDEZVOUS_SKELETON);
+  MemcachedCluster test = MemcachedCluster::network();
+  auto memc = &test.memc;
+
+  INFO("distribution: " << libmemcached_string_distribution(distribution));
+  test.enableBinaryProto();
+  REQUIRE_SUCCESS(memcached_behavior_set_distribution(memc, distribution));
+  REQUIRE_SUCCESS(memcached_behavior_set(memc, MEMCACHED_BEHAVIOR_NUMBER_OF_REPLICAS, 1));
+
+  auto get_from = [&test, memc](uint32_t server_key, const string &key) {
+    auto ins = memcached_server_instance_by_position(memc, server_key);
+    MemcachedPtr single;
+    memcached_return_t rc;
+
+    REQUIRE_SUCCESS(memcached_server_add(*single, "localhost", ins->port()));
+    Malloced val(memcached_get(*single, key.c_str(), key.length(), nullptr, nullptr, &rc));
+    return rc;
+  };
+
+  for (auto i = 0; i < 20; ++i) {
+    auto key = "replica" + to_string(i);
+    array<uint32_t, 2> server_keys{};
+
+    REQUIRE(2 == memcached_generate_hash_replicas(memc, key.c_str(), key.length(),
+                                                  server_keys.data(), server_keys.size()));
+
+    REQUIRE_SUCCESS(memcached_set(memc, key.c_str(), key.length(), key.c_str(), key.length(), 0, 0));
+    memcached_quit(memc);
+    for (auto server_key : server_keys) {
+      REQUIRE_SUCCESS(get_from(server_key, key));
+    }
+
+    REQUIRE_SUCCESS(memcached_delete(memc, key.c_str(), key.length(), 0));
+    memcached_quit(memc);
+    for (auto server_key : server_keys) {
+      REQUIRE_RC(MEMCACHED_NOTFOUND, get_from(server_key, key));
+    }
+  }
+}
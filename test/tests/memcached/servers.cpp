@@ -121,3 +121,30 @@ TEST_CASE("memcached_servers") {
     REQUIRE_FALSE(memcached_server_count(*memc));
   }
 }
+
+TEST_CASE("memcached_connect_all") {
+  auto test = MemcachedCluster::mixed();
+  auto memc = &test.memc;
+
+  REQUIRE_SUCCESS(memcached_connect_all(memc));
+  REQUIRE_FALSE(memcached_server_get_last_disconnect(memc));
+  REQUIRE_SUCCESS(memcached_set(memc, S(__func__), S(__func__), 0, 0));
+  REQUIRE_SUCCESS(memcached_connect_all(memc));
+
+  SECTION("unreachable server") {
+    auto port = random_port();
+
+    REQUIRE_SUCCESS(memcached_server_add(memc, "localhost", port));
+    REQUIRE_RC(MEMCACHED_SOME_ERRORS, memcached_connect_all(memc));
+
+    auto dead = memcached_server_get_last_disconnect(memc);
+    REQUIRE(dead);
+    REQUIRE(port == memcached_server_port(dead));
+  }
+
+  SECTION("no servers") {
+    MemcachedPtr empty;
+
+    REQUIRE(MEMCACHED_NO_SERVERS == memcached_connect_all(*empty));
+  }
+}
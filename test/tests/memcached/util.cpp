@@ -84,6 +84,36 @@ TEST_CASE("memcached_util") {
       REQUIRE(nullptr == memcached_pool_destroy(pool));
     }
 
+    SECTION("update in place") {
+      auto cache = GENERATE(as<string>{}, "", " --POOL-THREAD-CACHE");
+      auto conf = "--SERVER=host10.example.com --SERVER=host11.example.com --POOL-MIN=1 --POOL-MAX=1" + cache;
+      auto pool = memcached_pool(conf.c_str(), conf.length());
+      REQUIRE(pool);
+
+      memcached_return_t rc;
+      auto memc = memcached_pool_fetch(pool, nullptr, &rc);
+      REQUIRE(MEMCACHED_SUCCESS == rc);
+      REQUIRE(memc);
+
+      REQUIRE(MEMCACHED_SUCCESS == memcached_pool_behavior_set(pool, MEMCACHED_BEHAVIOR_IO_MSG_WATERMARK, 9999));
+      auto servers = memcached_servers_parse("host11.example.com, host12.example.com:11212");
+      REQUIRE(servers);
+      REQUIRE(MEMCACHED_SUCCESS == memcached_pool_servers_set(pool, servers));
+      memcached_server_list_free(servers);
+      REQUIRE(MEMCACHED_INVALID_ARGUMENTS == memcached_pool_servers_set(pool, nullptr));
+
+      REQUIRE(MEMCACHED_SUCCESS == memcached_pool_release(pool, memc));
+      REQUIRE(memc == memcached_pool_fetch(pool, nullptr, &rc));
+      REQUIRE(MEMCACHED_SUCCESS == rc);
+      REQUIRE(9999 == memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_IO_MSG_WATERMARK));
+      REQUIRE(2 == memcached_server_count(memc));
+      REQUIRE(string{"host11.example.com"} == memcached_server_name(memcached_server_instance_by_position(memc, 0)));
+      REQUIRE(11212 == memcached_server_port(memcached_server_instance_by_position(memc, 1)));
+
+      REQUIRE(MEMCACHED_SUCCESS == memcached_pool_release(pool, memc));
+      REQUIRE(nullptr == memcached_pool_destroy(pool));
+    }
+
     SECTION("basic") {
       auto test = MemcachedCluster::mixed();
       auto memc = &test.memc;
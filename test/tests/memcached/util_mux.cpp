@@ -0,0 +1,57 @@
+#include "test/lib/common.hpp"
+#include "test/lib/MemcachedCluster.hpp"
+
+#include "libmemcachedutil-1.0/mux.h"
+#include <atomic>
+
+TEST_CASE("memcached_util_mux") {
+  auto test = MemcachedCluster::network();
+  auto mux = memcached_mux_create(&test.memc);
+  REQUIRE(mux);
+
+  SECTION("requests of many threads") {
+    constexpr auto NUM_THREADS = 8;
+    constexpr auto NUM_KEYS = 200;
+    atomic<size_t> failed{0};
+    vector<thread> threads;
+
+    for (auto t = 0; t < NUM_THREADS; ++t) {
+      threads.emplace_back([&, t] {
+        for (auto i = 0; i < NUM_KEYS; ++i) {
+          auto key = "mux" + to_string(t) + "_" + to_string(i);
+          auto value = random_ascii_string(i % 50 ? 64 : 3 * MEMCACHED_MAX_BUFFER);
+
+          if (MEMCACHED_SUCCESS != memcached_mux_set(mux, key.c_str(), key.length(), value.c_str(), value.length(), 0, t)) {
+            ++failed;
+            continue;
+          }
+
+          size_t len;
+          uint32_t flags;
+          memcached_return_t rc;
+          Malloced got(memcached_mux_get(mux, key.c_str(), key.length(), &len, &flags, &rc));
+          if (MEMCACHED_SUCCESS != rc or value != string{*got, len} or flags != uint32_t(t)) {
+            ++failed;
+          }
+
+          if (MEMCACHED_SUCCESS != memcached_mux_delete(mux, key.c_str(), key.length())
+              or MEMCACHED_NOTFOUND != memcached_mux_delete(mux, key.c_str(), key.length())) {
+            ++failed;
+          }
+        }
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    REQUIRE(failed == 0);
+  }
+
+  SECTION("not found") {
+    memcached_return_t rc;
+    REQUIRE(nullptr == memcached_mux_get(mux, S(__func__), nullptr, nullptr, &rc));
+    REQUIRE(MEMCACHED_NOTFOUND == rc);
+  }
+
+  memcached_mux_destroy(mux);
+}
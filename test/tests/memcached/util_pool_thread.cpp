@@ -1,7 +1,11 @@
 #include "test/lib/common.hpp"
 
 #include "libmemcachedutil-1.0/pool.h"
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <mutex>
+#include <set>
 
 struct test_pool_context_st {
   volatile memcached_return_t rc;
@@ -72,3 +76,100 @@ TEST_CASE("memcached_util_pool_thread") {
   REQUIRE(memcached_pool_destroy(pool) == *memc);
 
 }
+
+TEST_CASE("memcached_util_pool_thread_cache") {
+  constexpr auto POOL_MAX = 4;
+  auto pool = memcached_pool(S("--SERVER=localhost --POOL-MIN=1 --POOL-MAX=4 --POOL-THREAD-CACHE"));
+  REQUIRE(pool);
+
+  SECTION("reuses the handle of the thread") {
+    memcached_return_t rc;
+    auto memc = memcached_pool_fetch(pool, nullptr, &rc);
+    REQUIRE(MEMCACHED_SUCCESS == rc);
+    REQUIRE(MEMCACHED_SUCCESS == memcached_pool_release(pool, memc));
+    REQUIRE(memc == memcached_pool_fetch(pool, nullptr, &rc));
+    REQUIRE(MEMCACHED_SUCCESS == memcached_pool_release(pool, memc));
+  }
+
+  SECTION("hands out each handle once") {
+    mutex lock;
+    set<memcached_st *> held;
+    atomic<bool> failed{false};
+    vector<thread> threads;
+
+    for (auto t = 0; t < 2 * POOL_MAX; ++t) {
+      threads.emplace_back([&] {
+        for (auto i = 0; i < 1000; ++i) {
+          struct timespec relative_time = {5, 0};
+          memcached_return_t rc;
+          auto memc = memcached_pool_fetch(pool, &relative_time, &rc);
+          if (memc == nullptr) {
+            failed = true;
+            continue;
+          }
+
+          {
+            lock_guard<mutex> guard(lock);
+            failed = failed or held.size() >= POOL_MAX or held.count(memc);
+            held.insert(memc);
+          }
+          this_thread::yield();
+          {
+            lock_guard<mutex> guard(lock);
+            held.erase(memc);
+          }
+
+          failed = failed or MEMCACHED_SUCCESS != memcached_pool_release(pool, memc);
+        }
+      });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    REQUIRE_FALSE(failed);
+  }
+
+  SECTION("times out when depleted") {
+    array<memcached_st *, POOL_MAX> hold{};
+    memcached_return_t rc;
+    for (auto &h : hold) {
+      h = memcached_pool_fetch(pool, nullptr, &rc);
+      REQUIRE(MEMCACHED_SUCCESS == rc);
+    }
+
+    REQUIRE(nullptr == memcached_pool_fetch(pool, nullptr, &rc));
+    REQUIRE(MEMCACHED_NOTFOUND == rc);
+
+    struct timespec relative_time = {1, 0};
+    REQUIRE(nullptr == memcached_pool_fetch(pool, &relative_time, &rc));
+    REQUIRE(MEMCACHED_TIMEOUT == rc);
+
+    test_pool_context_st item(pool, hold[0]);
+    pthread_t tid;
+    REQUIRE(0 == pthread_create(&tid, nullptr, connection_release, &item));
+
+    relative_time = {5, 0};
+    auto memc = memcached_pool_fetch(pool, &relative_time, &rc);
+    REQUIRE(0 == pthread_join(tid, nullptr));
+    REQUIRE(MEMCACHED_SUCCESS == rc);
+    REQUIRE(memc == hold[0]);
+
+    for (auto &h : hold) {
+      REQUIRE(MEMCACHED_SUCCESS == memcached_pool_release(pool, h));
+    }
+  }
+
+  SECTION("updates the behavior of cached handles") {
+    memcached_return_t rc;
+    auto memc = memcached_pool_fetch(pool, nullptr, &rc);
+    REQUIRE(MEMCACHED_SUCCESS == memcached_pool_release(pool, memc));
+
+    REQUIRE(MEMCACHED_SUCCESS == memcached_pool_behavior_set(pool, MEMCACHED_BEHAVIOR_TCP_NODELAY, 1));
+    memc = memcached_pool_fetch(pool, nullptr, &rc);
+    REQUIRE(memc);
+    REQUIRE(memcached_behavior_get(memc, MEMCACHED_BEHAVIOR_TCP_NODELAY));
+    REQUIRE(MEMCACHED_SUCCESS == memcached_pool_release(pool, memc));
+  }
+
+  REQUIRE(nullptr == memcached_pool_destroy(pool));
+}